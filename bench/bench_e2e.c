@@ -0,0 +1,311 @@
+/*
+ ============================================================================
+ Archivo: bench_e2e.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Benchmark de extremo a extremo con los binarios reales. Genera (o
+    reutiliza) una fuente del tamaño pedido, ejecuta el Inicializador, M
+    Receptores y N Emisores en modo continuo sobre un mismo segmento,
+    espera a que next_to_flush cubra toda la fuente, cierra con el
+    Finalizador y compara la salida byte a byte con la fuente.
+
+    Reporta MB/s, caracteres/s y el tiempo de CPU (usuario + sistema) de
+    cada proceso, obtenido con wait4().
+
+    Uso:
+        ./bench_e2e [-s bytes] [-e emisores] [-r receptores] [-b buffer]
+                    [-d directorio] [-i id] [-t segundos] [-j] [-k]
+                    [-E cpus] [-R cpus] [-B lote] [-- opciones del inicializador]
+          -s  tamaño de la fuente (sufijos K/M/G; 1M a 10G, por defecto 64M)
+          -b  tamaño del buffer circular (por defecto 4096)
+          -d  directorio de la fuente y la salida (por defecto /tmp)
+          -i  id de memoria para ftok (por defecto 201)
+          -t  tiempo máximo de la corrida (por defecto 600 s)
+          -j  salida JSON (por defecto CSV)
+          -k  conservar el archivo de salida
+          -E / -R  CPUs de emisores / receptores (-a de cada proceso:
+              "0-3,8" o "node:N")
+          -B  lote máximo de extracción de los receptores (-b del Receptor)
+    Los binarios se buscan junto a este ejecutable; ftok(".") exige que
+    todos corran en el directorio actual.
+
+    Salida CSV (stdout, una fila por corrida):
+        bytes,emisores,receptores,segundos,mb_por_seg,chars_por_seg,
+        cpu_emisores_s,cpu_receptores_s,cpu_max_proceso_s,verificado
+    Salida JSON: los mismos campos más "procesos" con la CPU de cada uno.
+ ============================================================================
+*/
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "shared.h"
+#include "segment.h"
+
+#define BLOCK    (1 << 20)
+#define KEY      "42"
+
+typedef struct {
+    pid_t pid;
+    const char *role;     // "emisor" | "receptor"
+    double cpu_user;
+    double cpu_sys;
+} Child;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long long parse_size(const char *txt) {
+    char *end;
+    long long v = strtoll(txt, &end, 10);
+    if (end == txt || v < 0) return -1;
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; end++; break;
+    case 'm': case 'M': v <<= 20; end++; break;
+    case 'g': case 'G': v <<= 30; end++; break;
+    default: break;
+    }
+    return (*end == '\0') ? v : -1;
+}
+
+/* --------------------------------------------------------------------------
+   Fuente: texto imprimible pseudoaleatorio (xorshift64), con salto de línea
+   cada 100 caracteres. Se reutiliza si ya existe con el tamaño pedido.
+   -------------------------------------------------------------------------- */
+static int make_source(const char *path, long long bytes) {
+    struct stat st;
+    if (stat(path, &st) == 0 && st.st_size == bytes) return 0;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) { perror("open fuente"); return -1; }
+    char *buf = malloc(BLOCK);
+    if (!buf) { perror("malloc"); close(fd); return -1; }
+
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    long long done = 0;
+    while (done < bytes) {
+        size_t n = (bytes - done < BLOCK) ? (size_t)(bytes - done) : BLOCK;
+        for (size_t i = 0; i < n; i++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            buf[i] = ((done + (long long)i) % 100 == 99) ? '\n' : (char)(' ' + (x >> 32) % 95);
+        }
+        if (write(fd, buf, n) != (ssize_t)n) { perror("write fuente"); free(buf); close(fd); return -1; }
+        done += (long long)n;
+    }
+    free(buf);
+    return close(fd);
+}
+
+// 1 si ambos archivos son idénticos
+static int same_file(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb"), *fb = fopen(b, "rb");
+    int same = (fa && fb);
+    char *ba = malloc(BLOCK), *bb = malloc(BLOCK);
+    while (same) {
+        size_t na = fread(ba, 1, BLOCK, fa);
+        size_t nb = fread(bb, 1, BLOCK, fb);
+        if (na != nb || memcmp(ba, bb, na) != 0) same = 0;
+        if (na == 0 || na < BLOCK) break;
+    }
+    free(ba); free(bb);
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+/* --------------------------------------------------------------------------
+   Lanza un binario del proyecto con stdout en /dev/null y stdin desde
+   in_fd (-1 = /dev/null). Devuelve el pid.
+   -------------------------------------------------------------------------- */
+static pid_t spawn(char *const argv[], int in_fd) {
+    pid_t pid = fork();
+    if (pid != 0) return pid;
+    int devnull = open("/dev/null", O_RDWR);
+    dup2(in_fd == -1 ? devnull : in_fd, STDIN_FILENO);
+    dup2(devnull, STDOUT_FILENO);
+    execv(argv[0], argv);
+    perror(argv[0]);
+    _exit(127);
+}
+
+static int run_wait(char *const argv[]) {
+    int status;
+    pid_t pid = spawn(argv, -1);
+    if (pid == -1 || waitpid(pid, &status, 0) == -1) return -1;
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
+}
+
+// Finalizador con su "botón físico" (ENTER) ya presionado
+static int run_finalizer(char *const argv[]) {
+    int p[2];
+    if (pipe(p) == -1) return -1;
+    if (write(p[1], "\n", 1) != 1) { close(p[0]); close(p[1]); return -1; }
+    close(p[1]);
+    int status;
+    pid_t pid = spawn(argv, p[0]);
+    close(p[0]);
+    if (pid == -1 || waitpid(pid, &status, 0) == -1) return -1;
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
+}
+
+/* --------------------------------------------------------------------------
+   Espera a que la salida cubra toda la fuente (next_to_flush). El segmento
+   se anexa en solo lectura, así que se consulta cada 200 us en lugar de
+   anotarse en SYNC_EV_WINDOW. 0 si se completó, -1 si venció el plazo.
+   -------------------------------------------------------------------------- */
+static int wait_complete(SharedMemory *mem, long long bytes, double deadline) {
+    while (atomic_load(&mem->next_to_flush) < bytes) {
+        if (now_sec() > deadline) return -1;
+        struct timespec d = {0, 200000L};
+        nanosleep(&d, NULL);
+    }
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Uso: %s [-s bytes] [-e emisores] [-r receptores] [-b buffer] [-d dir] "
+                    "[-i id] [-t segundos] [-j] [-k] [-E cpus] [-R cpus] [-B lote] [-- opciones del inicializador]\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    long long bytes = 64LL << 20;
+    int emitters = 1, receivers = 1;
+    const char *buffer = "4096";
+    const char *dir = "/tmp";
+    const char *id = "201";
+    double timeout = 600;
+    int json = 0, keep = 0;
+    char *emi_cpus = NULL, *rec_cpus = NULL, *rec_batch = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:e:r:b:d:i:t:jkE:R:B:")) != -1) {
+        switch (opt) {
+        case 's': bytes = parse_size(optarg); break;
+        case 'e': emitters = atoi(optarg); break;
+        case 'r': receivers = atoi(optarg); break;
+        case 'b': buffer = optarg; break;
+        case 'd': dir = optarg; break;
+        case 'i': id = optarg; break;
+        case 't': timeout = atof(optarg); break;
+        case 'j': json = 1; break;
+        case 'k': keep = 1; break;
+        case 'E': emi_cpus = optarg; break;
+        case 'R': rec_cpus = optarg; break;
+        case 'B': rec_batch = optarg; break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (bytes < (1LL << 20) || bytes > (10LL << 30) || emitters < 1 || receivers < 1) {
+        fprintf(stderr, "Fuente de 1M a 10G y al menos un emisor y un receptor\n");
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Binarios junto a este ejecutable
+    char bindir[PATH_MAX];
+    snprintf(bindir, sizeof(bindir), "%s", argv[0]);
+    char *slash = strrchr(bindir, '/');
+    if (slash) *slash = '\0'; else strcpy(bindir, ".");
+    char init_bin[PATH_MAX + 32], emi_bin[PATH_MAX + 32], rec_bin[PATH_MAX + 32], fin_bin[PATH_MAX + 32];
+    snprintf(init_bin, sizeof(init_bin), "%s/inicializador", bindir);
+    snprintf(emi_bin, sizeof(emi_bin), "%s/emisor", bindir);
+    snprintf(rec_bin, sizeof(rec_bin), "%s/receptor", bindir);
+    snprintf(fin_bin, sizeof(fin_bin), "%s/finalizador", bindir);
+
+    char src_path[PATH_MAX], out_path[PATH_MAX];
+    snprintf(src_path, sizeof(src_path), "%s/bench_fuente_%lld.txt", dir, bytes);
+    snprintf(out_path, sizeof(out_path), "%s/bench_salida_%d.txt", dir, (int)getpid());
+    if (make_source(src_path, bytes) == -1) return 1;
+    unlink(out_path);
+
+    /* ---- Inicializador: opciones extra tras "--" + posicionales ---- */
+    int extra = argc - optind;
+    char **init_argv = calloc((size_t)extra + 6, sizeof(char *));
+    init_argv[0] = init_bin;
+    for (int i = 0; i < extra; i++) init_argv[1 + i] = argv[optind + i];
+    init_argv[1 + extra] = (char *)id;
+    init_argv[2 + extra] = (char *)buffer;
+    init_argv[3 + extra] = KEY;
+    init_argv[4 + extra] = src_path;
+    if (run_wait(init_argv) == -1) { fprintf(stderr, "Falló el inicializador\n"); return 1; }
+
+    key_t key = ftok(".", atoi(id));
+    int shm_id = shmget(key, 0, 0666);
+    SharedMemory *mem = (shm_id == -1) ? (void *)-1 : shmat(shm_id, NULL, SHM_RDONLY);
+    if (mem == (void *)-1) { perror("shmat"); return 1; }
+    if (segment_check(mem) == -1) return 1;
+
+    /* ---- Receptores y emisores en modo continuo ---- */
+    int total = emitters + receivers;
+    Child *kids = calloc((size_t)total, sizeof(Child));
+    char *rec_args[10], *emi_argv[] = { emi_bin, "-a", emi_cpus, (char *)id, "2", KEY, NULL };
+    char **emi_args = emi_cpus ? emi_argv : emi_argv + 2; // sin -a: se omiten "-a cpus"
+    emi_args[0] = emi_bin;
+    int ra = 0;
+    rec_args[ra++] = rec_bin;
+    if (rec_cpus)  { rec_args[ra++] = "-a"; rec_args[ra++] = rec_cpus; }
+    if (rec_batch) { rec_args[ra++] = "-b"; rec_args[ra++] = rec_batch; }
+    rec_args[ra++] = (char *)id; rec_args[ra++] = "2"; rec_args[ra++] = KEY;
+    rec_args[ra++] = out_path; rec_args[ra] = NULL;
+    char *fin_argv[] = { fin_bin, (char *)id, NULL };
+
+    for (int i = 0; i < receivers; i++) kids[i] = (Child){ spawn(rec_args, -1), "receptor", 0, 0 };
+    double t0 = now_sec();
+    for (int i = 0; i < emitters; i++) kids[receivers + i] = (Child){ spawn(emi_args, -1), "emisor", 0, 0 };
+
+    int complete = (wait_complete(mem, bytes, t0 + timeout) == 0);
+    double secs = now_sec() - t0;
+    if (!complete) fprintf(stderr, "Plazo vencido: la salida quedó en %lld de %lld bytes\n",
+                           (long long)atomic_load(&mem->next_to_flush), bytes);
+    shmdt(mem);
+
+    /* ---- Cierre ordenado y CPU de cada proceso ---- */
+    if (run_finalizer(fin_argv) == -1) fprintf(stderr, "Falló el finalizador\n");
+    double cpu_e = 0, cpu_r = 0, cpu_max = 0;
+    for (int i = 0; i < total; i++) {
+        struct rusage ru;
+        int status;
+        if (wait4(kids[i].pid, &status, 0, &ru) == -1) continue;
+        kids[i].cpu_user = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6;
+        kids[i].cpu_sys  = ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+        double cpu = kids[i].cpu_user + kids[i].cpu_sys;
+        if (kids[i].role[0] == 'e') cpu_e += cpu; else cpu_r += cpu;
+        if (cpu > cpu_max) cpu_max = cpu;
+    }
+
+    int ok = complete && same_file(src_path, out_path);
+    if (!keep) unlink(out_path);
+
+    double mbs = bytes / secs / (1 << 20);
+    double cps = bytes / secs;
+    if (json) {
+        printf("{\"bytes\":%lld,\"emisores\":%d,\"receptores\":%d,\"segundos\":%.4f,"
+               "\"mb_por_seg\":%.2f,\"chars_por_seg\":%.0f,\"cpu_emisores_s\":%.4f,"
+               "\"cpu_receptores_s\":%.4f,\"cpu_max_proceso_s\":%.4f,\"verificado\":%s,\"procesos\":[",
+               bytes, emitters, receivers, secs, mbs, cps, cpu_e, cpu_r, cpu_max, ok ? "true" : "false");
+        for (int i = 0; i < total; i++)
+            printf("%s{\"rol\":\"%s\",\"pid\":%d,\"cpu_usuario_s\":%.4f,\"cpu_sistema_s\":%.4f}",
+                   i ? "," : "", kids[i].role, (int)kids[i].pid, kids[i].cpu_user, kids[i].cpu_sys);
+        printf("]}\n");
+    } else {
+        printf("bytes,emisores,receptores,segundos,mb_por_seg,chars_por_seg,"
+               "cpu_emisores_s,cpu_receptores_s,cpu_max_proceso_s,verificado\n");
+        printf("%lld,%d,%d,%.4f,%.2f,%.0f,%.4f,%.4f,%.4f,%d\n",
+               bytes, emitters, receivers, secs, mbs, cps, cpu_e, cpu_r, cpu_max, ok);
+    }
+    free(kids);
+    free(init_argv);
+    return ok ? 0 : 2;
+}
@@ -0,0 +1,121 @@
+/*
+ ============================================================================
+ Archivo: bench_sync.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Microbenchmark del buffer circular: compara el camino clásico con
+    semop(), el mismo camino con palabras futex y el anillo lock-free.
+    Para cada configuración lanza P productores y P consumidores (procesos
+    pesados, fork) sobre un segmento privado y mide caracteres/segundo.
+
+    Uso:
+        ./bench_sync [items] [tamano_buffer]
+    Salida (CSV en stdout):
+        modo,procesos,items,segundos,ops_por_seg
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/sem.h>
+#include <sys/wait.h>
+#include "shared.h"
+#include "ring.h"
+
+union semun {
+    int val;
+    struct semid_ds *buf;
+    unsigned short *array;
+};
+
+typedef struct {
+    const char *name;
+    int ring_mode;
+    int sync_mode;
+} BenchMode;
+
+static const BenchMode MODES[] = {
+    { "semop",    RING_MODE_SEM,      SYNC_SEMOP },
+    { "futex",    RING_MODE_SEM,      SYNC_FUTEX },
+    { "lockfree", RING_MODE_LOCKFREE, SYNC_FUTEX },
+};
+static const int PROCS[] = { 1, 4, 16 };
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* --------------------------------------------------------------------------
+   Ejecuta una configuración y devuelve los segundos transcurridos
+   (o -1 si no se pudo crear el entorno IPC)
+   -------------------------------------------------------------------------- */
+static double run_one(const BenchMode *m, int procs, long items, int size) {
+    int shm_id = shmget(IPC_PRIVATE, ring_bytes(size, LAYOUT_TRACE, 1, 1), IPC_CREAT | 0600);
+    if (shm_id == -1) { perror("shmget"); return -1; }
+    SharedMemory *mem = (SharedMemory *)shmat(shm_id, NULL, 0);
+    if (mem == (void *)-1) { perror("shmat"); shmctl(shm_id, IPC_RMID, NULL); return -1; }
+    int sem_id = semget(IPC_PRIVATE, 3, IPC_CREAT | 0600);
+    if (sem_id == -1) { perror("semget"); shmdt(mem); shmctl(shm_id, IPC_RMID, NULL); return -1; }
+
+    memset(mem, 0, sizeof(SharedMemory));
+    ring_init(mem, size, m->ring_mode, LAYOUT_TRACE, 1, 1);
+    int slots = (int)ring_shard_slots(size, LAYOUT_TRACE, 1, 1); // ranuras que dejó ring_init
+    sync_init(&mem->sync, m->sync_mode, slots);
+    unsigned short values[3] = {1, (unsigned short)slots, 0};
+    union semun arg;
+    arg.array = values;
+    semctl(sem_id, 0, SETALL, arg);
+
+    long quota = items / procs;
+    double t0 = now_sec();
+    for (int role = 0; role < 2; role++) {
+        for (int p = 0; p < procs; p++) {
+            pid_t pid = fork();
+            if (pid == -1) { perror("fork"); exit(EXIT_FAILURE); }
+            if (pid != 0) continue;
+            SharedChar sc;
+            memset(&sc, 0, sizeof(sc));
+            for (long i = 0; i < quota; i++) {
+                int r = (role == 0) ? ring_push(mem, sem_id, &sc) : ring_pop(mem, sem_id, &sc);
+                if (r == -1) { perror("ring"); _exit(EXIT_FAILURE); }
+            }
+            _exit(EXIT_SUCCESS);
+        }
+    }
+    while (wait(NULL) > 0) { }
+    double elapsed = now_sec() - t0;
+
+    shmdt(mem);
+    shmctl(shm_id, IPC_RMID, NULL);
+    semctl(sem_id, 0, IPC_RMID);
+    return elapsed;
+}
+
+int main(int argc, char *argv[]) {
+    long items = (argc > 1) ? atol(argv[1]) : 200000;
+    int size   = (argc > 2) ? atoi(argv[2]) : 64;
+    if (items <= 0 || size <= 0 || size > 32767) {
+        fprintf(stderr, "Uso: %s [items] [tamano_buffer<=32767]\n", argv[0]);
+        return 1;
+    }
+
+    printf("modo,procesos,items,segundos,ops_por_seg\n");
+    for (size_t m = 0; m < sizeof(MODES) / sizeof(MODES[0]); m++) {
+        for (size_t p = 0; p < sizeof(PROCS) / sizeof(PROCS[0]); p++) {
+            long total = (items / PROCS[p]) * PROCS[p];
+            double secs = run_one(&MODES[m], PROCS[p], total, size);
+            if (secs < 0) return 1;
+            printf("%s,%d,%ld,%.4f,%.0f\n", MODES[m].name, PROCS[p], total, secs, total / secs);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
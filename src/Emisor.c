@@ -9,16 +9,39 @@
     Este proceso (Emisor) es responsable de leer los caracteres del archivo
     fuente establecido por el Inicializador, codificarlos mediante una operación
     XOR, y escribirlos en la memoria compartida de forma circular y sincronizada.
+    Reclama tramos de chunk_size bytes de next_pos y los publica juntos en el
+    buffer. La fuente se lee con un pread por tramo (SOURCE_PREAD) o se mapea
+    una sola vez con mmap (SOURCE_MMAP); en ese caso cada tramo se codifica
+    directamente desde el mapeo hacia las celdas, sin búfer intermedio.
+    Con la distribución de registros (LAYOUT_RECORD) reserva espacio en el
+    anillo, codifica ahí mismo y confirma; con frame_lines cada línea de
+    la fuente viaja como un registro propio.
+    Con la cola de flujos (jobs_max > 0, ver stream.h) la fuente es la
+    concatenación de los trabajos encolados: reclama hasta jobs_end, lee
+    cada tramo del archivo de su trabajo y, sin nada encolado, duerme
+    hasta que llegue otro trabajo o empiece el drenaje.
+    Con la ingesta (ingest_bytes > 0, ver ingest.h) la fuente es un flujo
+    que el ingestor deja en el segmento: reclama hasta ingest_end, copia
+    el tramo del área de ingesta y sale cuando el flujo terminó y ya se
+    reclamó entero.
 
     Cumple con las siguientes funciones descritas en el proyecto:
       - Llenar el buffer circular en memoria compartida sin utilizar busy waiting.
-      - Bloquearse cuando no haya espacio (controlado con semáforos).
+      - Bloquearse cuando no haya espacio (semáforos, o timbre del anillo
+        lock-free según el modo fijado por el Inicializador).
       - Insertar cada carácter con su valor ASCII, índice, timestamp y secuencia.
       - Permitir múltiples instancias de emisores trabajando simultáneamente.
+
+    La tabla en consola la imprime un hilo registrador (logger.h): el bucle
+    de envío solo deja cada carácter en un anillo local y nunca espera a
+    la terminal.
  ============================================================================
 */
 #define _XOPEN_SOURCE 700
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/ipc.h>
@@ -28,56 +51,306 @@
 #include <time.h>
 #include <errno.h>
 #include "shared.h"
+#include "ring.h"
+#include "codec.h"
+#include "proc.h"
+#include "segment.h"
+#include "affinity.h"
+#include "logger.h"
+#include "pacing.h"
+#include "recover.h"
+#include "stream.h"
+#include "ingest.h"
 
-/* --------------------------------------------------------------------------
-   Funciones auxiliares: control de semáforos
-   -------------------------------------------------------------------------- */
 
-// Disminuye el valor del semáforo (wait)
-static int sem_wait_raw(int sem_id, int sem_num) {
-    struct sembuf op = {sem_num, -1, 0};
-    return semop(sem_id, &op, 1);
-}
-// Incrementa el valor del semáforo (signal)
-static int sem_signal_raw(int sem_id, int sem_num) {
-    struct sembuf op = {sem_num, 1, 0};
-    return semop(sem_id, &op, 1);
-}
 /* --------------------------------------------------------------------------
    Función: print_table
    Muestra de manera visual los datos insertados en la memoria compartida.
-   Incluye color ANSI, encabezado y fecha de inserción.
+   Incluye color ANSI, encabezado y fecha de inserción. Corre en el hilo
+   registrador (logger.h), fuera del camino de datos.
    -------------------------------------------------------------------------- */
-static void print_table(int index, unsigned char c, time_t t) {
+static void print_table(const LogRec *r) {
+    char when[32];
     printf("\033[1;34m---------------------------------------------\033[0m\n");
     printf("\033[1;32m| Índice | Valor ASCII | Hora de Inserción   |\033[0m\n");
-    printf("\033[1;33m| %6d | %12u | %s\033[0m", index, c, ctime(&t));
+    printf("\033[1;33m| %6lld | %12u | %s\033[0m", r->index, r->c, ctime_r(&r->ts, when));
     printf("\033[1;34m---------------------------------------------\033[0m\n");
 }
+/* --------------------------------------------------------------------------
+   Función: pread_full
+   Lee hasta n bytes desde la posición pos, reintentando lecturas parciales.
+   Devuelve los bytes leídos (0 = fin de archivo) o -1 en error.
+   -------------------------------------------------------------------------- */
+static ssize_t pread_full(int fd, char *buf, size_t n, off_t pos) {
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = pread(fd, buf + got, n - got, pos + (off_t)got);
+        if (r == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (r == 0) break;
+        got += (size_t)r;
+    }
+    return (ssize_t)got;
+}
+
+/* --------------------------------------------------------------------------
+   Lector del archivo fuente
+   --------------------------------------------------------------------------
+   source_range() entrega un puntero a los bytes [pos, pos+n) sin codificar:
+     - SOURCE_PREAD: los lee con pread en un búfer propio del emisor.
+     - SOURCE_MMAP : apunta directo al mapeo (MADV_SEQUENTIAL) y pide
+                     lectura anticipada del tramo siguiente.
+   Con trabajos (jobs != NULL) los lee siempre con pread, del archivo del
+   trabajo de cada seq (stream_read); con ingesta (ingest != NULL), del
+   área de ingesta del segmento (ingest_read).
+   -------------------------------------------------------------------------- */
+typedef struct {
+    int fd;
+    int mode;            // SOURCE_PREAD | SOURCE_MMAP
+    size_t chunk;        // bytes por tramo
+    char *buf;           // búfer de lectura (solo pread)
+    size_t cap;          // capacidad de buf
+    const char *map;     // mapeo del archivo (solo mmap)
+    off_t size;          // tamaño del archivo al mapear
+    SharedMemory *jobs;  // segmento con cola de flujos (NULL = fuente única)
+    StreamFile file;     // archivo abierto del trabajo actual
+    SharedMemory *ingest;// segmento con área de ingesta (NULL = archivo)
+} Source;
+
+// pread de la fuente única, de los trabajos o copia del área de ingesta
+static ssize_t source_pread(Source *src, char *buf, size_t n, long long off) {
+    if (src->jobs) return stream_read(&src->file, src->jobs, off, buf, n);
+    if (src->ingest) return ingest_read(src->ingest, off, buf, n);
+    return pread_full(src->fd, buf, n, (off_t)off);
+}
+
+static int source_open(Source *src, SharedMemory *mem, size_t chunk) {
+    const char *path = mem->fuente_path;
+    int mode = mem->source_mode;
+    memset(src, 0, sizeof(*src));
+    src->chunk = chunk;
+    if (mem->jobs_max > 0 || mem->ingest_bytes > 0) {
+        if (mem->jobs_max > 0) src->jobs = mem; else src->ingest = mem;
+        src->fd = -1;
+        stream_file_init(&src->file, 0);
+        src->mode = SOURCE_PREAD;
+        src->buf = malloc(chunk);
+        if (!src->buf) { perror("malloc"); return -1; }
+        src->cap = chunk;
+        return 0;
+    }
+    src->fd = open(path, O_RDONLY);
+    if (src->fd == -1) { perror("open fuente"); return -1; }
+
+    if (mode == SOURCE_MMAP) {
+        struct stat st;
+        if (fstat(src->fd, &st) == -1) { perror("fstat fuente"); close(src->fd); return -1; }
+        src->size = st.st_size;
+        if (S_ISREG(st.st_mode) && st.st_size > 0) {
+            void *m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, src->fd, 0);
+            if (m != MAP_FAILED) {
+                posix_madvise(m, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+                src->map = (const char *)m;
+                src->mode = SOURCE_MMAP;
+                return 0;
+            }
+            perror("mmap fuente (se usará pread)");
+        } else if (S_ISREG(st.st_mode)) {
+            src->mode = SOURCE_MMAP; // archivo vacío: nada que mapear
+            return 0;
+        }
+    }
+
+    src->mode = SOURCE_PREAD;
+    src->buf = malloc(chunk);
+    if (!src->buf) { perror("malloc"); close(src->fd); return -1; }
+    src->cap = chunk;
+    return 0;
+}
+
+// Como source_range pero con posición y largo libres (hasta fin de
+// archivo); el búfer de pread crece si hace falta. Lo usan los registros
+// por línea, que leen antes y después de su tramo.
+static ssize_t source_at(Source *src, long long off, size_t n, const char **data) {
+    if (src->mode == SOURCE_PREAD) {
+        if (n > src->cap) {
+            char *nb = realloc(src->buf, n);
+            if (!nb) return -1;
+            src->buf = nb;
+            src->cap = n;
+        }
+        *data = src->buf;
+        return source_pread(src, src->buf, n, off);
+    }
+    if (off >= src->size) return 0;
+    off_t avail = src->size - (off_t)off;
+    *data = src->map + off;
+    return (avail < (off_t)n) ? (ssize_t)avail : (ssize_t)n;
+}
+
+// Devuelve los bytes disponibles en [pos, pos+want) (0 = fin) o -1 en
+// error; want es a lo sumo un tramo
+static ssize_t source_range(Source *src, long long pos, size_t want, const char **data) {
+    if (src->mode == SOURCE_PREAD) {
+        *data = src->buf;
+        return source_pread(src, src->buf, want, pos);
+    }
+    if (pos >= src->size) return 0;
+    off_t avail = src->size - (off_t)pos;
+    size_t n = (avail < (off_t)want) ? (size_t)avail : want;
+    *data = src->map + pos;
+
+    // Lectura anticipada del tramo siguiente (alineado a página)
+    long page = sysconf(_SC_PAGESIZE);
+    off_t ahead = ((off_t)pos + (off_t)n) & ~((off_t)page - 1);
+    if (ahead < src->size) {
+        off_t len = src->size - ahead;
+        if (len > (off_t)src->chunk) len = (off_t)src->chunk;
+        posix_madvise((void *)(src->map + ahead), (size_t)len, POSIX_MADV_WILLNEED);
+    }
+    return (ssize_t)n;
+}
+
+/* --------------------------------------------------------------------------
+   Publicación en registros (LAYOUT_RECORD)
+   --------------------------------------------------------------------------
+   publish_records() reserva cada registro en el anillo, codifica la fuente
+   directo en él y lo confirma; lo que supere el registro máximo viaja en
+   varios registros consecutivos.
+   publish_lines() publica las líneas que empiezan dentro del tramo
+   [pos, pos + chunk), completas aunque terminen más allá: los tramos de
+   emisores distintos cubren la fuente sin huecos ni solapes y cada línea
+   conserva su desplazamiento en la fuente como seq.
+   Ambas devuelven 0 o -1 con errno.
+   -------------------------------------------------------------------------- */
+static int publish_records(SharedMemory *mem, const Codec *codec, Logger *lg,
+                           const char *data, long long n, long long seq) {
+    int max = ring_record_max(mem);
+    while (n > 0) {
+        int len = (n < max) ? (int)n : max;
+        RingRecord r;
+        if (ring_reserve(mem, len, seq, &r) == -1) return -1;
+        codec_apply(codec, r.data, data, (size_t)len, seq);
+        time_t ts = time(NULL);
+        ring_commit(mem, &r, ts, lat_now());
+        if (lg->level < LOG_SUMMARY)
+            for (int i = 0; i < len; i++) logger_char(lg, r.index + i, (unsigned char)r.data[i], ts);
+        data += len; seq += len; n -= len;
+    }
+    return 0;
+}
+
+static int publish_lines(SharedMemory *mem, Source *src, const Codec *codec, Logger *lg,
+                         long long pos, int chunk, long long *sent) {
+    // Ventana de lectura [at, at + got): el tramo más un registro máximo
+    // alcanza casi siempre para terminar su última línea con una lectura
+    int max = ring_record_max(mem);
+    size_t span = (size_t)chunk + (size_t)max;
+    const char *d = NULL;
+    ssize_t got = 0;
+    long long at = 0, s = pos;
+    *sent = 0;
+    if (pos > 0) {
+        // Primera línea que empieza en el tramo: tras el primer '\n' desde pos - 1
+        at = pos - 1;
+        got = source_at(src, at, span, &d);
+        if (got <= 0) return (int)got;
+        const char *nl = memchr(d, '\n', (got < chunk) ? (size_t)got : (size_t)chunk);
+        if (!nl) return 0;
+        s = at + (nl - d) + 1;
+    }
+
+    int mid = 0; // s está dentro de una línea más larga que el registro máximo
+    while (mid || s < pos + chunk) {
+        // Releer desde s si la ventana no cubre s..s+max y no terminó en EOF
+        if (!d || (s + max > at + got && got == (ssize_t)span)) {
+            at = s;
+            got = source_at(src, at, span, &d);
+            if (got == -1) return -1;
+        }
+        long long left = at + got - s;
+        if (left <= 0) break;
+        const char *p = d + (s - at);
+        size_t look = (left < max) ? (size_t)left : (size_t)max;
+        const char *nl = memchr(p, '\n', look);
+        int len = nl ? (int)(nl - p) + 1 : (int)look;
+        mid = (nl == NULL);
+        if (publish_records(mem, codec, lg, p, len, s) == -1) return -1;
+        s += len;
+        *sent += len;
+    }
+    return 0;
+}
+
+static void source_close(Source *src) {
+    if (src->map) munmap((void *)src->map, (size_t)src->size);
+    free(src->buf);
+    if (src->fd != -1) close(src->fd);
+    if (src->jobs) stream_file_close(&src->file);
+}
+
 /* --------------------------------------------------------------------------
    PROCESO PRINCIPAL DEL EMISOR
    Uso:
-       ./emisor <id_memoria> <modo> <clave_xor>
+       ./emisor [-v nivel] [-n N] [-p ritmo] [-a cpus] <id_memoria> <modo> <clave_xor>
        - id_memoria : identificador usado por ftok() (entero)
-       - modo       : 0 = manual | 1 = automático
+       - modo       : 0 = manual | 1 = automático | 2 = continuo (sin
+                      pausas, para benchmarks)
        - clave_xor  : valor entero de 8 bits para codificación XOR
+       - -v nivel   : salida en consola: full (tabla por carácter), sample
+                      (1 de cada N), summary (resumen cada segundo) o
+                      silent. Por defecto full, o silent en modo continuo.
+       - -n N       : razón de muestreo de -v sample (por defecto 100)
+       - -p ritmo   : unlimited, fixed (0.4 s por tramo), rate:B (B bytes/s
+                      propios), global (cubeta del segmento, -t) o
+                      replay:ARCHIVO (traza de llegadas; ver pacing.h). Por
+                      defecto fixed en modo automático y unlimited en los
+                      demás.
+       - -a cpus    : fija el proceso a esas CPUs ("0-3,8" o "node:N",
+                      ver affinity.h)
    -------------------------------------------------------------------------- */
 int main(int argc, char *argv[]) {
     // ============================================================
     // VALIDACIÓN DE PARÁMETROS
     // ============================================================
-    if (argc != 4) {
-        fprintf(stderr, "Uso: %s <id_memoria> <modo> <clave_xor>\n", argv[0]);
-        fprintf(stderr, "Modo: 0 = Manual | 1 = Automático\n");
+    int log_level = -1;
+    long long log_every = 100;
+    const char *pace_spec = NULL;
+    const char *cpus = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "v:n:p:a:")) != -1) {
+        switch (opt) {
+        case 'v':
+            log_level = logger_level(optarg);
+            if (log_level < 0) { fprintf(stderr, "Nivel de salida desconocido: %s (use full|sample|summary|silent)\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'n':
+            log_every = atoll(optarg);
+            if (log_every < 1) { fprintf(stderr, "Razón de muestreo inválida: %s\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'p': pace_spec = optarg; break;
+        case 'a': cpus = optarg; break;
+        default:
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (argc - optind != 3) {
+        fprintf(stderr, "Uso: %s [-v full|sample|summary|silent] [-n N] [-p ritmo] [-a cpus] <id_memoria> <modo> <clave_xor>\n", argv[0]);
+        fprintf(stderr, "Modo: 0 = Manual | 1 = Automático | 2 = Continuo\n");
         exit(EXIT_FAILURE);
     }
+    if (cpus && affinity_apply(cpus) == -1) exit(EXIT_FAILURE);
+    argv += optind - 1; // argv[1..3] quedan como los parámetros posicionales
     
     // Generar la clave de memoria compartida (ftok)
     key_t shm_key = ftok(".", atoi(argv[1]));
     if (shm_key == (key_t)-1) { perror("ftok"); exit(EXIT_FAILURE); }
 
-    int mode = atoi(argv[2]); // 0 = manual, 1 = automático
+    int mode = atoi(argv[2]); // RUN_MANUAL | RUN_AUTO | RUN_CONTINUOUS
     int xor_key = atoi(argv[3]);
+    if (log_level < 0) log_level = (mode == RUN_CONTINUOUS) ? LOG_SILENT : LOG_FULL;
 
     // ============================================================
     // CONEXIÓN A LA MEMORIA Y SEMÁFOROS EXISTENTES
@@ -87,125 +360,164 @@ int main(int argc, char *argv[]) {
 
     SharedMemory *mem = (SharedMemory *)shmat(shm_id, NULL, 0);
     if (mem == (void *)-1) { perror("shmat"); exit(EXIT_FAILURE); }
+    if (segment_check(mem) == -1) { shmdt(mem); exit(EXIT_FAILURE); }
+    segment_warm(mem); // fallos de página ahora, no en el camino de datos
 
     int sem_id = semget(shm_key, 3, 0666);
     if (sem_id == -1) { perror("semget"); shmdt(mem); exit(EXIT_FAILURE); }
 
     // ============================================================
-    // ABRIR ARCHIVO FUENTE DEFINIDO EN LA MEMORIA
+    // CÓDEC REGISTRADO EN EL SEGMENTO (misma elección en todo proceso)
     // ============================================================
-    FILE *fp = fopen(mem->fuente_path, "rb");
-    if (!fp) { perror("fopen fuente"); shmdt(mem); exit(EXIT_FAILURE); }
+    Codec codec;
+    if (codec_init(&codec, mem->codec, xor_key, mem->codec_key_len, CODEC_IMPL_AUTO) == -1) {
+        fprintf(stderr, "Códec no disponible en esta CPU\n"); shmdt(mem); exit(EXIT_FAILURE);
+    }
 
-   // ============================================================
-    // REGISTRAR EMISOR ACTIVO Y TOTAL
-    // (Protegido por el mutex)
-    // ============================================================)
-    if (sem_wait_raw(sem_id, 0) == -1) {
-        if (errno==EIDRM || errno==EINVAL) goto graceful_exit;
-        perror("semop wait mutex");
-        goto graceful_exit;
+    // ============================================================
+    // RITMO DE ENVÍO (pacing.h)
+    // ============================================================
+    Pacer pacer;
+    if (pace_spec) {
+        if (pacer_parse(&pacer, pace_spec, mem, ROLE_EMITTER) == -1) { shmdt(mem); exit(EXIT_FAILURE); }
+    } else {
+        pacer_default(&pacer, mode);
     }
-    mem->emitters_active++;
-    mem->emitters_total++;
-    if (sem_signal_raw(sem_id, 0) == -1) {
-        if (errno==EIDRM || errno==EINVAL) goto graceful_exit;
-        perror("semop signal mutex");
-        goto graceful_exit;
+
+    // ============================================================
+    // ABRIR ARCHIVO FUENTE DEFINIDO EN LA MEMORIA
+    // ============================================================
+    int chunk = (mem->chunk_size > 0) ? mem->chunk_size : 1;
+    Source src;
+    if (source_open(&src, mem, (size_t)chunk) == -1) {
+        shmdt(mem); exit(EXIT_FAILURE);
     }
 
-    printf("\nEmisor iniciado (modo %s)\n", mode == 1 ? "automático" : "manual");
+    // ============================================================
+    // REGISTRAR EMISOR EN LA TABLA DE PROCESOS
+    // ============================================================
+    ProcEntry *self = proc_register(mem, ROLE_EMITTER);
+    if (!self) { perror("proc_register"); source_close(&src); shmdt(mem); exit(EXIT_FAILURE); }
+
+    static Logger lg; // anillo de consola (grande: fuera de la pila)
+    if (logger_start(&lg, log_level, log_every, print_table, "emisor") == -1) {
+        perror("logger_start"); proc_unregister(mem, self); source_close(&src); shmdt(mem); exit(EXIT_FAILURE);
+    }
+    // Bloqueado más de SYNC_STALL_NS: revisar si otro proceso murió con el
+    // turno de reclamo o ranuras en la mano (recover.h)
+    Recovery rcv = { .mem = mem, .sem_id = sem_id, .codec = &codec };
+    sync_on_stall(recover_hook, &rcv);
+    if (log_level != LOG_SILENT)
+        printf("\nEmisor iniciado (modo %s)\n", mode == RUN_AUTO ? "automático" : mode == RUN_MANUAL ? "manual" : "continuo");
 
     // ============================================================
     // BUCLE PRINCIPAL DE ENVÍO DE DATOS
     // ------------------------------------------------------------
     // Cada iteración:
-    //  1) Reserva posición atómica (next_pos)
-    //  2) Lee un byte del archivo fuente
-    //  3) Escribe en el buffer circular (con XOR)
-    //  4) Imprime información y respeta modo de ejecución
+    //  1) Reserva atómicamente un tramo de chunk bytes (next_pos)
+    //  2) Obtiene el tramo del archivo fuente (un pread, o el mapeo)
+    //  3) Lo publica completo en el buffer circular, codificando con el
+    //     códec del segmento (ranuras, registros, o un registro por
+    //     línea que empiece en el tramo)
+    //  4) Deja el tramo para la consola y respeta modo de ejecución
     // ============================================================
+    int status = EXIT_SUCCESS;
     for (;;) {
-        // 1) Reservar posición global atómica
-        long long pos;
-        if (sem_wait_raw(sem_id, 0) == -1) {
-            if (errno==EIDRM || errno==EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (mutex next_pos). Saliendo emisor...\n"); break; }
-            perror("semop wait mutex next_pos"); break;
-        }
-        pos = mem->next_pos++;
-        if (sem_signal_raw(sem_id, 0) == -1) {
-            if (errno==EIDRM || errno==EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (unlock next_pos). Saliendo emisor...\n"); break; }
-            perror("semop signal mutex next_pos"); break;
+        // Con el drenaje pedido no se reclaman tramos nuevos: todo tramo
+        // ya reclamado se publica completo para no dejar huecos de seq
+        if (sync_is_draining(&mem->sync)) {
+            fprintf(stderr, "\n[INFO] Cierre solicitado (drenaje). Saliendo emisor...\n"); break;
         }
 
-        // 2) Leer byte del archivo
-        if (fseeko(fp, (off_t)pos, SEEK_SET) != 0) break;
-        int ch = fgetc(fp);
-        if (ch == EOF) break;
-        unsigned char c = (unsigned char)ch;
-
-        // 3) Escribir en buffer circular
-        if (sem_wait_raw(sem_id, 1) == -1) { // empty--
-            if (errno==EIDRM || errno==EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (empty). Saliendo emisor...\n"); break; }
-            perror("semop wait empty"); break;
-        }
-        if (sem_wait_raw(sem_id, 0) == -1) { // mutex--
-            if (errno==EIDRM || errno==EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (mutex write). Saliendo emisor...\n"); break; }
-            perror("semop wait mutex write"); break;
+        // 1) Reservar tramo global atómico (con trabajos, sin pasar del
+        //    último encolado; con ingesta, de lo ya ingerido; sin nada
+        //    que reclamar se espera)
+        long long pos;
+        long long want = chunk;
+        if (src.jobs) {
+            want = stream_claim(mem, chunk, &pos);
+            if (want == 0) {
+                if (stream_wait(mem) == -1) { fprintf(stderr, "\n[INFO] IPC retirados (trabajos). Saliendo emisor...\n"); break; }
+                continue;
+            }
+        } else if (src.ingest) {
+            want = ingest_claim(mem, chunk, &pos);
+            if (want == 0) {
+                if (ingest_ended(mem)) break; // flujo terminado y reclamado
+                if (ingest_wait(mem) == -1) { fprintf(stderr, "\n[INFO] IPC retirados (ingesta). Saliendo emisor...\n"); break; }
+                continue;
+            }
+        } else {
+            pos = atomic_fetch_add(&mem->next_pos, chunk);
         }
+        proc_lease_set(self, pos, (int)want); // si muere, otro completa el tramo
+        long long got;   // bytes publicados en esta vuelta
+        int eof, rc;
 
-        // Inserción segura en la posición actual del buffer
-        int idx = mem->write_index;
-        mem->buffer[idx].ascii     = (char)(c ^ xor_key);
-        mem->buffer[idx].index     = idx;
-        mem->buffer[idx].timestamp = time(NULL);
-        mem->buffer[idx].is_full   = 1;
-        mem->buffer[idx].seq       = pos;
-
-        mem->total_written++;  // Contador global de caracteres emitidos
-
-        print_table(idx, (unsigned char)mem->buffer[idx].ascii, mem->buffer[idx].timestamp);
-
-        // Actualización circular del índice de escritura
-        mem->write_index = (idx + 1) % mem->size;
-        mem->count++;
+        if (mem->frame_lines) {
+            // 2-3) Las líneas se leen alrededor del tramo
+            rc = publish_lines(mem, &src, &codec, &lg, pos, chunk, &got);
+            const char *probe;
+            eof = (rc == 0 && source_at(&src, pos + chunk, 1, &probe) <= 0);
+        } else {
+            // 2) Obtener el tramo del archivo
+            const char *data;
+            ssize_t n = source_range(&src, pos, (size_t)want, &data);
+            if (n == -1) {
+                // El tramo queda en arriendo: al salir, proc_unregister lo
+                // deja para recover.c, que lo publica cuando se pueda leer
+                perror("lectura fuente"); status = EXIT_FAILURE; break;
+            }
+            if (n == 0) { proc_lease_clear(self); break; }
+            got = n;
+            eof = !src.jobs && !src.ingest && n < chunk; // con trabajos o ingesta se espera más
 
-        // Liberar semáforos (salida de sección crítica)
-        if (sem_signal_raw(sem_id, 0) == -1) { // mutex++
-            if (errno==EIDRM || errno==EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (unlock write). Saliendo emisor...\n"); break; }
-            perror("semop signal mutex write"); break;
+            // 3) Codificar y escribir en buffer circular
+            if (mem->layout == LAYOUT_RECORD) {
+                rc = publish_records(mem, &codec, &lg, data, n, pos);
+            } else {
+                time_t ts = time(NULL);
+                long long first;
+                rc = ring_push_range(mem, sem_id, self->shard, data, (int)n, pos, ts, lat_now(), &codec, &first);
+                if (rc == 0 && log_level < LOG_SUMMARY) {
+                    long long capacity = mem->slots * mem->slot_bytes;
+                    for (ssize_t i = 0; i < n; i++)
+                        logger_char(&lg, (first + i) % capacity, (unsigned char)data[i] ^ codec_key_at(&codec, pos + i), ts);
+                }
+            }
         }
-        if (sem_signal_raw(sem_id, 2) == -1) { // full++
-            if (errno==EIDRM || errno==EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (full++). Saliendo emisor...\n"); break; }
-            perror("semop signal full"); break;
+        if (rc == -1) {
+            if (errno==EIDRM || errno==EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (buffer). Saliendo emisor...\n"); break; }
+            perror("publicación en el buffer"); status = EXIT_FAILURE; break;
         }
-        // 4) Control del modo de ejecucion
-        if (mode == 0) {
-            printf("\nPresione ENTER para enviar el siguiente carácter...\n");
+        proc_lease_clear(self);
+        proc_add(self, got);
+        logger_count(&lg, got);
+
+        // 4) Respetar el modo de ejecución (la consola ya recibió el tramo)
+        if (mode == RUN_MANUAL) {
+            logger_flush(&lg);
+            printf("\nPresione ENTER para enviar el siguiente tramo...\n");
             getchar();
-        } else {
-            struct timespec d = {0, 400000000L}; // 0.4 s
-            nanosleep(&d, NULL);
         }
+        if (pacer_wait(&pacer, mem, got) == -1) {
+            fprintf(stderr, "\n[INFO] IPC retirados (ritmo). Saliendo emisor...\n"); break;
+        }
+        if (eof) break; // fin de archivo dentro del tramo
     }
 /* ============================================================
        FINALIZACIÓN ELEGANTE
        ------------------------------------------------------------
-       - Disminuye el contador de emisores activos.
+       - Libera su entrada de la tabla de procesos.
        - Cierra archivos y libera recursos.
        ============================================================ */
-graceful_exit:
-    if (sem_wait_raw(sem_id, 0) == -1) {
-        if (!(errno==EIDRM || errno==EINVAL)) perror("semop wait mutex exit");
-    } else {
-        if (mem->emitters_active > 0) mem->emitters_active--;
-        if (sem_signal_raw(sem_id, 0) == -1) {
-            if (!(errno==EIDRM || errno==EINVAL)) perror("semop signal mutex exit");
-        }
-    }
+    sync_on_stall(NULL, NULL);
+    proc_unregister(mem, self);
+    logger_stop(&lg);
 
-    fclose(fp);
+    source_close(&src);
+    pacer_free(&pacer);
     shmdt(mem);
-    printf("\nEmisión finalizada correctamente.\n");
-    return 0;
+    if (log_level != LOG_SILENT && status == EXIT_SUCCESS) printf("\nEmisión finalizada correctamente.\n");
+    return status;
 }
@@ -16,15 +16,39 @@
       - Finalizar una vez creada la memoria, sin mantener procesos activos.
  ============================================================================
 */
+#define _GNU_SOURCE // SHM_HUGETLB, SHM_LOCK
+#include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <sys/sem.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <string.h>
 #include <time.h>
 #include <errno.h>
+#include <limits.h>
 #include "shared.h"
+#include "ring.h"
+#include "reorder.h"
+#include "segment.h"
+#include "codec.h"
+#include "affinity.h"
+#include "checkpoint.h"
+#include "stream.h"
+#include "ingest.h"
+
+#ifndef SEMVMX
+#define SEMVMX 32767 // valor máximo de un semáforo System V
+#endif
+
+// Con un anillo de un fragmento la posición más baja sin persistir la tiene
+// siempre un Receptor que puede depositarla: la ventana por defecto no
+// necesita cubrir más que esto del buffer (ver reorder.h)
+#define WINDOW_RING_CAP (64LL << 20)
+
+#define CKPT_EVERY_DEFAULT (64LL << 20) // bytes entre puntos de control
 
 /* --------------------------------------------------------------------------
    Estructura requerida por semctl() para inicializar semáforos
@@ -34,39 +58,415 @@ union semun {
     struct semid_ds *buf;       //Buffer para IPC_STAT e IPC_SET
     unsigned short *array;      //Arreglo para SETALL
 };
+/* --------------------------------------------------------------------------
+   Convierte "4096", "64K" o "1M" a bytes. Devuelve -1 si no es válido.
+   -------------------------------------------------------------------------- */
+static long long parse_size(const char *txt) {
+    char *end;
+    long long v = strtoll(txt, &end, 10);
+    if (end == txt || v < 0) return -1;
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; end++; break;
+    case 'm': case 'M': v <<= 20; end++; break;
+    case 'g': case 'G': v <<= 30; end++; break;
+    default: break;
+    }
+    return (*end == '\0') ? v : -1;
+}
+
+/* --------------------------------------------------------------------------
+   Reanudación (-R)
+   Valida el punto de control de out_path contra la fuente y deja la salida
+   truncada a su largo durable. Devuelve el seq desde el que se reanuda y
+   en *base lo que la salida tenía antes del seq 0; -1 con un mensaje en
+   stderr si no se puede reanudar.
+   -------------------------------------------------------------------------- */
+
+// Inicio de la línea que contiene a x (o x si ya lo es); -1 si falla la lectura
+static long long line_floor(int fd, long long x) {
+    char buf[65536];
+    while (x > 0) {
+        long long from = (x > (long long)sizeof(buf)) ? x - (long long)sizeof(buf) : 0;
+        ssize_t got = pread(fd, buf, (size_t)(x - from), (off_t)from);
+        if (got <= 0) return -1;
+        const char *nl = memrchr(buf, '\n', (size_t)got);
+        if (nl) return from + (nl - buf) + 1;
+        x = from;
+    }
+    return 0;
+}
+
+static long long resume_point(const char *out_path, const char *src_path, long long src_bytes,
+                              unsigned long long src_fp, int output_mode, int frame_lines,
+                              long long *base) {
+    Checkpoint ck;
+    if (ckpt_load(out_path, &ck) == -1) return -1;
+    if (ck.source_bytes != src_bytes || ck.source_fp != src_fp) {
+        fprintf(stderr, "La fuente %s no es la del punto de control (otro archivo o modificado)\n", src_path);
+        return -1;
+    }
+    long long from = ck.flushed;
+    *base = ck.length - ck.flushed;
+    if (output_mode != OUTPUT_APPEND && *base != 0) {
+        fprintf(stderr, "La salida tenía %lld bytes previos al seq 0; reanude con -o append\n", *base);
+        return -1;
+    }
+
+    // Con un registro por línea los Emisores arrancan en inicios de línea:
+    // una línea partida (más larga que el registro máximo) se rehace entera
+    if (frame_lines && from > 0) {
+        int fd = open(src_path, O_RDONLY);
+        from = (fd == -1) ? -1 : line_floor(fd, from);
+        if (fd != -1) close(fd);
+        if (from == -1) { perror("lectura fuente"); return -1; }
+    }
+
+    int fd = open(out_path, O_WRONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1) { perror(out_path); if (fd != -1) close(fd); return -1; }
+    if ((long long)st.st_size < *base + ck.flushed) {
+        fprintf(stderr, "La salida tiene %lld bytes, menos que los %lld del punto de control\n",
+                (long long)st.st_size, *base + ck.flushed);
+        close(fd); return -1;
+    }
+    if (ftruncate(fd, (off_t)(*base + from)) == -1 || fsync(fd) == -1) {
+        perror("truncar salida"); close(fd); return -1;
+    }
+    close(fd);
+    return from;
+}
+
 /* --------------------------------------------------------------------------
    Función principal del Inicializador
    Parámetros esperados:
      argv[1] -> ID de memoria compartida (entero)
-     argv[2] -> Tamaño del buffer circular (entero)
+     argv[2] -> Tamaño del buffer circular en bytes de datos (admite
+                sufijos K/M/G); cada fragmento usa la mayor potencia de
+                dos de ranuras que entra en él
      argv[3] -> Clave XOR para codificación (entero)
-     argv[4] -> Ruta del archivo fuente (texto)
+     argv[4] -> Ruta del archivo fuente (texto); con -J, lista de trabajos
+                "<fuente> <destino>" por línea a encolar de entrada
+                (/dev/null para empezar sin ninguno); con -I, la fuente
+                que lee el ingestor ("-" = su entrada estándar)
+   Opciones:
+     -m lf|sem -> modo del buffer: anillo lock-free (por defecto) o
+                  compatibilidad con semáforos mutex/empty/full
+     -s futex|semop -> implementación de mutex/empty/full: palabras futex en
+                  el segmento (por defecto) o semáforos System V
+     -c bytes  -> tramo de next_pos que reclama cada Emisor por vuelta
+                  (admite sufijos K/M; por defecto 1 = carácter a carácter)
+     -f pread|mmap -> lectura de la fuente en los Emisores: un pread por
+                  tramo (por defecto) o mapeo con mmap sin copias intermedias
+     -o append|pwrite|mmap -> escritura de la salida en los Receptores: en
+                  orden vía ventana (por defecto) o posicional en el offset
+                  seq sobre un archivo preasignado al tamaño de la fuente
+     -l compact|trace|record|lines -> distribución de las ranuras: tramos
+                  de hasta un tramo de bytes con un seq/timestamp cada uno
+                  (por defecto), una celda con metadatos por carácter
+                  (traza), o un anillo de bytes con registros de largo
+                  variable: uno por tramo (record) o uno por línea de la
+                  fuente (lines). Los registros requieren -m lf sin -k
+     -x xor|roll -> códec de los datos: XOR de 8 bits (por defecto) o XOR
+                  con clave rodante derivada de clave_xor
+     -r bytes  -> largo de la clave rodante (1..64, por defecto 16)
+     -k fragmentos -> divide el anillo en K fragmentos independientes
+                  (1..SHARD_MAX, solo con -m lf); cada Emisor publica en
+                  su fragmento hogar y los Receptores roban del más lleno
+                  cuando el suyo se vacía
+     -t bytes/s -> ritmo de la cubeta global compartida por rol (sufijos
+                  K/M/G); la usan Emisores/Receptores lanzados con -p global
+     -w bytes  -> posiciones de la ventana de reordenamiento de la salida
+                  (por defecto max(64K, 16 tramos + 2 buffers), con el
+                  buffer acotado a 64M si hay un solo fragmento; debe
+                  cubrir los tramos de todos los emisores simultáneos y,
+                  como mínimo, un lote del Receptor: RECV_BATCH_MAX
+                  ranuras, o un tramo con registros)
+     -H        -> crea el segmento con páginas enormes (SHM_HUGETLB); el
+                  tamaño se redondea a la página enorme y requiere páginas
+                  reservadas (vm.nr_hugepages)
+     -P        -> prefault: toca todo el segmento al crearlo, y cada proceso
+                  lo vuelve a tocar al anexarse, fuera del camino de datos
+     -L        -> como -P y además fija el segmento en RAM (SHM_LOCK)
+     -a cpus   -> fija el Inicializador a esas CPUs ("0-3,8" o "node:N");
+                  con -P/-L el segmento queda en la memoria de ese nodo
+     -C bytes  -> los Receptores escriben un punto de control
+                  "<salida>.ckpt" cada tantos bytes persistidos (sufijos
+                  K/M/G; por defecto 64M, 0 = ninguno)
+     -R salida -> reanuda desde el punto de control de esa salida: verifica
+                  la huella de la fuente, trunca la salida a lo durable y
+                  arranca la transferencia ahí (ver checkpoint.h)
+     -J trabajos -> cola de flujos: tabla de hasta tantos trabajos
+                  (fuente, destino) sin persistir a la vez, que se agregan
+                  con el encolador mientras el segmento vive (stream.h).
+                  Salida pwrite por trabajo; sin -f mmap, -l lines, -R
+                  ni puntos de control
+     -I bytes  -> fuente en flujo: área de ingesta de tantos bytes (sufijos
+                  K/M/G, se redondea a potencia de dos) que llena el
+                  ingestor desde una tubería, una FIFO o un archivo que
+                  crece (ingest.h). Salida append; sin -f mmap, -l lines,
+                  -J, -R ni puntos de control
    -------------------------------------------------------------------------- */
 int main(int argc, char *argv[]) {
     /* ==============================================================
        VALIDACIÓN DE PARÁMETROS
        ============================================================== */
-    if (argc != 5) {
-        fprintf(stderr, "Uso: %s <id_memoria> <tamano_buffer> <clave_xor> <archivo_fuente>\n", argv[0]);
+    int ring_mode = RING_MODE_LOCKFREE;
+    int sync_mode = SYNC_FUTEX;
+    long long chunk_size = 1;
+    int source_mode = SOURCE_PREAD;
+    long long window = 0;
+    int output_mode = OUTPUT_APPEND;
+    int layout = LAYOUT_COMPACT;
+    int frame_lines = 0;
+    int codec = CODEC_XOR;
+    int codec_key_len = 16;
+    long long pace_rate = 0;
+    int shards = 1;
+    int seg_flags = 0;
+    const char *cpus = NULL;
+    long long ckpt_every = CKPT_EVERY_DEFAULT;
+    const char *resume = NULL;
+    int jobs_max = 0;
+    long long ingest = 0;
+    int output_set = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "m:s:c:f:w:o:l:x:r:t:k:HPLa:C:R:J:I:")) != -1) {
+        switch (opt) {
+        case 'm':
+            if (strcmp(optarg, "lf") == 0)       ring_mode = RING_MODE_LOCKFREE;
+            else if (strcmp(optarg, "sem") == 0) ring_mode = RING_MODE_SEM;
+            else { fprintf(stderr, "Modo de buffer desconocido: %s (use lf|sem)\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 's':
+            if (strcmp(optarg, "futex") == 0)      sync_mode = SYNC_FUTEX;
+            else if (strcmp(optarg, "semop") == 0) sync_mode = SYNC_SEMOP;
+            else { fprintf(stderr, "Modo de sincronización desconocido: %s (use futex|semop)\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'c':
+            chunk_size = parse_size(optarg);
+            if (chunk_size < 1 || chunk_size > (64LL << 20)) {
+                fprintf(stderr, "Tramo inválido: %s (1 byte a 64M)\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'f':
+            if (strcmp(optarg, "pread") == 0)     source_mode = SOURCE_PREAD;
+            else if (strcmp(optarg, "mmap") == 0) source_mode = SOURCE_MMAP;
+            else { fprintf(stderr, "Lectura de fuente desconocida: %s (use pread|mmap)\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'o':
+            if (strcmp(optarg, "append") == 0)      output_mode = OUTPUT_APPEND;
+            else if (strcmp(optarg, "pwrite") == 0) output_mode = OUTPUT_PWRITE;
+            else if (strcmp(optarg, "mmap") == 0)   output_mode = OUTPUT_MMAP;
+            else { fprintf(stderr, "Escritura de salida desconocida: %s (use append|pwrite|mmap)\n", optarg); exit(EXIT_FAILURE); }
+            output_set = 1;
+            break;
+        case 'l':
+            if (strcmp(optarg, "compact") == 0)    layout = LAYOUT_COMPACT;
+            else if (strcmp(optarg, "trace") == 0) layout = LAYOUT_TRACE;
+            else if (strcmp(optarg, "record") == 0) layout = LAYOUT_RECORD;
+            else if (strcmp(optarg, "lines") == 0) { layout = LAYOUT_RECORD; frame_lines = 1; }
+            else { fprintf(stderr, "Distribución desconocida: %s (use compact|trace|record|lines)\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'x':
+            codec = codec_lookup(optarg);
+            if (codec < 0) { fprintf(stderr, "Códec desconocido: %s (use xor|roll)\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'r':
+            codec_key_len = atoi(optarg);
+            if (codec_key_len < 1 || codec_key_len > CODEC_KEY_MAX) {
+                fprintf(stderr, "Largo de clave inválido: %s (1 a %d)\n", optarg, CODEC_KEY_MAX);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'k':
+            shards = atoi(optarg);
+            if (shards < 1 || shards > SHARD_MAX) {
+                fprintf(stderr, "Fragmentos inválidos: %s (1 a %d)\n", optarg, SHARD_MAX);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 't':
+            pace_rate = parse_size(optarg);
+            if (pace_rate < 1) { fprintf(stderr, "Ritmo inválido: %s\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'w':
+            window = parse_size(optarg);
+            if (window < 1 || window > UINT_MAX) {
+                fprintf(stderr, "Ventana inválida: %s\n", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'H': seg_flags |= SEG_HUGETLB; break;
+        case 'P': seg_flags |= SEG_PREFAULT; break;
+        case 'L': seg_flags |= SEG_PREFAULT | SEG_LOCKED; break;
+        case 'a': cpus = optarg; break;
+        case 'C':
+            ckpt_every = parse_size(optarg);
+            if (ckpt_every < 0) { fprintf(stderr, "Intervalo de puntos de control inválido: %s\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'R': resume = optarg; break;
+        case 'J':
+            jobs_max = atoi(optarg);
+            if (jobs_max < 2 || jobs_max > (1 << 20)) {
+                fprintf(stderr, "Trabajos inválidos: %s (2 a %d)\n", optarg, 1 << 20);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'I':
+            ingest = ingest_capacity(parse_size(optarg));
+            if (ingest < 0 || ingest > (1LL << 30)) {
+                fprintf(stderr, "Área de ingesta inválida: %s (%d bytes a 1G)\n", optarg, INGEST_MIN);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        default:
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (argc - optind != 4) {
+        fprintf(stderr, "Uso: %s [-m lf|sem] [-s futex|semop] [-c bytes] [-f pread|mmap] [-o append|pwrite|mmap] [-l compact|trace|record|lines] [-x xor|roll] [-r bytes] [-k fragmentos] [-t bytes/s] [-w bytes] [-H] [-P] [-L] [-a cpus] [-C bytes] [-R salida] [-J trabajos] [-I bytes] <id_memoria> <tamano_buffer> <clave_xor> <archivo_fuente>\n", argv[0]);
         exit(EXIT_FAILURE);
     }
+    argv += optind - 1; // argv[1..4] quedan como los parámetros posicionales
+    if (cpus && affinity_apply(cpus) == -1) exit(EXIT_FAILURE);
 
     /* ==============================================================
        CONVERSIÓN Y LECTURA DE PARÁMETROS
        ============================================================== */
     key_t shm_key = ftok(".", atoi(argv[1]));  // Genera la clave IPC a partir del ID
-    int size = atoi(argv[2]);                  // Define el número de posiciones del buffer
+    long long size = parse_size(argv[2]);      // Bytes de datos del buffer
     int xor_key = atoi(argv[3]);               // Clave XOR 
     char *filename = argv[4];                  // Archivo de texto fuente
 
+    if (size <= 0) {
+        fprintf(stderr, "Tamaño de buffer inválido: %s\n", argv[2]);
+        exit(EXIT_FAILURE);
+    }
+    // Con trabajos cada uno trae su fuente y su destino (stream.h)
+    FILE *job_list = NULL;
+    if (jobs_max > 0) {
+        if ((output_set && output_mode != OUTPUT_PWRITE) || source_mode != SOURCE_PREAD || frame_lines || resume) {
+            fprintf(stderr, "La cola de flujos (-J) escribe con pwrite y lee con pread; "
+                            "no admite -o append|mmap, -f mmap, -l lines ni -R\n");
+            exit(EXIT_FAILURE);
+        }
+        output_mode = OUTPUT_PWRITE;
+        ckpt_every = 0;
+        job_list = fopen(filename, "r");
+        if (!job_list) { perror(filename); exit(EXIT_FAILURE); }
+    }
+    // Con ingesta la fuente no tiene tamaño: la lee el ingestor (ingest.h)
+    if (ingest > 0) {
+        if (output_mode != OUTPUT_APPEND || source_mode != SOURCE_PREAD || frame_lines || resume || jobs_max > 0) {
+            fprintf(stderr, "La ingesta (-I) escribe la salida en modo append y lee del segmento; "
+                            "no admite -o pwrite|mmap, -f mmap, -l lines, -J ni -R\n");
+            exit(EXIT_FAILURE);
+        }
+        ckpt_every = 0;
+    }
+
+    // El tamaño de la fuente define la preasignación de la salida posicional
+    struct stat st;
+    long long source_bytes = (!job_list && ingest == 0 && stat(filename, &st) == 0) ? (long long)st.st_size : -1;
+    if (output_mode != OUTPUT_APPEND && source_bytes < 0 && !job_list) {
+        perror("stat fuente (requerido para salida posicional)");
+        exit(EXIT_FAILURE);
+    }
+    if (layout == LAYOUT_RECORD && (ring_mode != RING_MODE_LOCKFREE || shards > 1)) {
+        fprintf(stderr, "Los registros (-l record|lines) requieren el anillo lock-free (-m lf) sin fragmentos\n");
+        exit(EXIT_FAILURE);
+    }
+    if (layout == LAYOUT_RECORD && size < 128) {
+        fprintf(stderr, "Los registros requieren un buffer de al menos 128 bytes\n");
+        exit(EXIT_FAILURE);
+    }
+    if (shards > 1 && ring_mode != RING_MODE_LOCKFREE) {
+        fprintf(stderr, "Los fragmentos (-k) requieren el anillo lock-free (-m lf)\n");
+        exit(EXIT_FAILURE);
+    }
+    // Cada ranura compacta lleva un tramo completo, pero cada fragmento
+    // conserva al menos 2 ranuras: con una sola, el turno "publicada" (p + 1)
+    // coincide con el turno "libre" de la vuelta siguiente y el protocolo
+    // lock-free no distingue ambos estados.
+    int slot_bytes = 1;
+    if (layout == LAYOUT_COMPACT) {
+        long long half = (size >= 2 * shards) ? size / (2 * shards) : 1;
+        slot_bytes = (int)((chunk_size < half) ? chunk_size : half);
+    }
+    long long slots = ring_shard_slots(size, layout, slot_bytes, shards) * shards;
+    if (ring_mode == RING_MODE_LOCKFREE && slots < 2 * shards) {
+        fprintf(stderr, "El modo lock-free requiere un buffer de al menos 2 caracteres por fragmento\n");
+        exit(EXIT_FAILURE);
+    }
+    // empty cuenta ranuras: un semáforo System V no pasa de SEMVMX y la
+    // palabra futex es un int
+    if (ring_mode == RING_MODE_SEM && sync_mode == SYNC_SEMOP && slots > SEMVMX) {
+        fprintf(stderr, "El modo semáforos con semop admite hasta %d ranuras (pedidas %lld); "
+                        "use -s futex, -m lf o un tramo mayor (-c)\n", SEMVMX, slots);
+        exit(EXIT_FAILURE);
+    }
+    if (ring_mode == RING_MODE_SEM && slots > INT_MAX) {
+        fprintf(stderr, "El modo semáforos admite hasta %d ranuras; use -m lf o un tramo mayor (-c)\n", INT_MAX);
+        exit(EXIT_FAILURE);
+    }
+    // Un depósito del Receptor es a lo sumo un lote de ranuras contiguas
+    // (un registro con LAYOUT_RECORD): la ventana debe poder contenerlo
+    long long batch_run = (layout == LAYOUT_RECORD) ? chunk_size : (long long)slot_bytes * RECV_BATCH_MAX;
+    if (window == 0) {
+        long long ring = (shards == 1 && size > WINDOW_RING_CAP) ? WINDOW_RING_CAP : size;
+        window = 16 * chunk_size + 2 * ring;
+        if (window < batch_run) window = batch_run;
+        if (window < 65536) window = 65536;
+    } else if (window < batch_run) {
+        fprintf(stderr, "La ventana (-w %lld) debe cubrir un lote del Receptor (%lld bytes); "
+                        "use -w mayor o un tramo menor (-c)\n", window, batch_run);
+        exit(EXIT_FAILURE);
+    }
+
+    // Huella para los puntos de control y la reanudación
+    unsigned long long source_fp = 0;
+    if ((ckpt_every > 0 || resume) && source_bytes >= 0 && ckpt_fingerprint(filename, &source_fp) == -1) {
+        perror("huella de la fuente");
+        exit(EXIT_FAILURE);
+    }
+    if (resume && source_bytes < 0) {
+        perror("stat fuente (requerido para reanudar)");
+        exit(EXIT_FAILURE);
+    }
+    long long resume_from = 0;
+    long long out_base = (output_mode == OUTPUT_APPEND) ? -1 : 0;
+    if (resume) {
+        // Último paso antes de crear el segmento: trunca la salida
+        resume_from = resume_point(resume, filename, source_bytes, source_fp, output_mode, frame_lines, &out_base);
+        if (resume_from == -1) exit(EXIT_FAILURE);
+    }
+
     /* ==============================================================
        CREACIÓN DE LA MEMORIA COMPARTIDA
+       --------------------------------------------------------------
+       [SharedMemory][ranuras del anillo][ventana de reordenamiento]
+       [tabla de trabajos (solo -J)][área de ingesta (solo -I)]
        ============================================================== */
+    size_t window_offset = (ring_bytes(size, layout, slot_bytes, shards) + 63) & ~(size_t)63;
+    size_t jobs_offset = window_offset + reorder_bytes(window);
+    size_t ingest_offset = jobs_offset + stream_bytes(jobs_max);
+    size_t segment_bytes = ingest_offset + ingest_region(ingest);
+    size_t huge_page = 0;
+    if (seg_flags & SEG_HUGETLB) {
+        huge_page = segment_huge_page();
+        if (huge_page == 0) { fprintf(stderr, "El sistema no informa páginas enormes (Hugepagesize)\n"); exit(EXIT_FAILURE); }
+        segment_bytes = (segment_bytes + huge_page - 1) / huge_page * huge_page;
+    }
+    if (segment_fits(segment_bytes, seg_flags) == -1) exit(EXIT_FAILURE);
     int shm_id = shmget(shm_key, 
-                        sizeof(SharedMemory) + size * sizeof(SharedChar), 
-                        IPC_CREAT | 0666);
+                        segment_bytes, 
+                        IPC_CREAT | 0666 | ((seg_flags & SEG_HUGETLB) ? SHM_HUGETLB : 0));
     if (shm_id == -1) {
         perror("Error al crear memoria compartida");
+        if (seg_flags & SEG_HUGETLB)
+            fprintf(stderr, "Con -H hacen falta %zu páginas enormes libres (vm.nr_hugepages) y permiso "
+                            "(CAP_IPC_LOCK o vm.hugetlb_shm_group)\n", segment_bytes / huge_page);
         exit(EXIT_FAILURE);
     }
 
@@ -79,34 +479,78 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
+    /* ==============================================================
+       PÁGINAS DEL SEGMENTO
+       --------------------------------------------------------------
+       Con -P/-L se asignan todas las páginas físicas ahora (desde la
+       CPU/nodo de -a) y con -L se fijan en RAM: el kernel ya no puede
+       llevarlas a swap ni reclamarlas mientras exista el segmento. Si
+       no hay permiso para fijar se sigue sin fijar.
+       ============================================================== */
+    if (seg_flags & SEG_PREFAULT) segment_prefault(mem, segment_bytes, 1);
+    if ((seg_flags & SEG_LOCKED) && shmctl(shm_id, SHM_LOCK, NULL) == -1) {
+        perror("Advertencia: no se pudo fijar el segmento (SHM_LOCK)");
+        seg_flags &= ~SEG_LOCKED;
+    }
+
     /* ==============================================================
        INICIALIZACIÓN DE LA ESTRUCTURA DE CONTROL
        --------------------------------------------------------------
-       - Se define tamaño, punteros de lectura y escritura.
+       - Se define tamaño, modo, punteros de lectura y escritura.
        - Se limpia el buffer marcando cada espacio como vacío.
+       - Se ponen en cero contadores globales, la tabla de procesos y
+         los histogramas de latencia.
+       - El sello de versión se borra primero y se escribe al final,
+         así nadie se anexa a un segmento a medio inicializar.
        ============================================================== */
-    mem->size = size;
-    mem->write_index = 0;
-    mem->read_index = 0;
-    mem->count = 0;
-    mem->next_pos = 0;
-    mem->next_to_flush = 0;
+    mem->magic = 0;
+    ring_init(mem, size, ring_mode, layout, slot_bytes, shards);
+    sync_init(&mem->sync, sync_mode, (slots < INT_MAX) ? (int)slots : INT_MAX);
+    reorder_init(mem, window_offset, window);
+    stream_init(mem, jobs_offset, jobs_max);
+    ingest_init(mem, ingest_offset, ingest);
+    mem->segment_bytes = segment_bytes;
+    mem->seg_flags = seg_flags;
+    mem->frame_lines = frame_lines;
+    mem->pace_rate = pace_rate;
+    for (int r = 0; r < 2; r++) atomic_store(&mem->pace[r].tat, 0);
+    mem->chunk_size = (int)chunk_size;
+    mem->source_mode = source_mode;
+    mem->source_bytes = source_bytes;
+    mem->source_fp = source_fp;
+    mem->ckpt_every = ckpt_every;
+    mem->output_mode = output_mode;
+    mem->codec = codec;
+    mem->codec_key_len = (codec == CODEC_ROLL) ? codec_key_len : 1;
+    mem->next_pos = resume_from;
+    mem->next_claim = resume_from;
+    mem->next_to_flush = resume_from;
+    mem->ckpt_next = resume_from + ckpt_every;
+    mem->out_base = out_base;
+    for (int r = 0; r < 2; r++) {
+        mem->registered[r] = 0;
+        mem->retired_chars[r] = 0;
+    }
+    for (int i = 0; i < PROC_MAX; i++) {
+        mem->procs[i].state = PROC_FREE;
+        mem->procs[i].chars = 0;
+    }
+    for (int k = 0; k < LAT_COUNT; k++) lat_init(&mem->lat[k]);
 
     // Guardar la ruta del archivo fuente de manera segura
     strncpy(mem->fuente_path, filename, sizeof(mem->fuente_path)-1);
     mem->fuente_path[sizeof(mem->fuente_path)-1] = '\0';
 
-    // Inicializar los espacios del buffer como vacíos
-    for (int i = 0; i < size; i++) {
-        mem->buffer[i].is_full = 0;
-    }
-
     /* ==============================================================
        CREACIÓN E INICIALIZACIÓN DE LOS SEMÁFOROS
        --------------------------------------------------------------
        - mutex: controla acceso exclusivo a la sección crítica
        - empty: controla espacios vacíos disponibles
        - full: controla espacios llenos listos para lectura
+       Solo el modo semáforos con sincronización semop los usa para
+       datos; en los demás modos el estado vive en el segmento (turnos
+       o palabras futex) y empty/full quedan en 0. El conjunto se crea
+       igual porque su clave identifica al sistema IPC.
        ============================================================== */
     int sem_id = semget(shm_key, 3, IPC_CREAT | 0666);
     if (sem_id == -1) {
@@ -116,7 +560,8 @@ int main(int argc, char *argv[]) {
 
     // Inicialización de los semáforos
     union semun arg;
-    unsigned short values[3] = {1, size, 0}; // mutex=1, empty=size, full=0
+    unsigned short values[3] = {1, (unsigned short)slots, 0}; // mutex=1, empty=slots, full=0
+    if (ring_mode == RING_MODE_LOCKFREE || sync_mode == SYNC_FUTEX) values[SEM_EMPTY] = 0;
     arg.array = values;
     
     if (semctl(sem_id, 0, SETALL, arg) == -1) {
@@ -124,6 +569,20 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
+    // Trabajos iniciales; si no entran o alguno falla no queda nada creado
+    long long queued = 0;
+    if (job_list) {
+        queued = stream_enqueue_list(mem, job_list, filename, 0);
+        fclose(job_list);
+        if (queued == -1) {
+            shmdt(mem);
+            shmctl(shm_id, IPC_RMID, NULL);
+            semctl(sem_id, 0, IPC_RMID);
+            exit(EXIT_FAILURE);
+        }
+    }
+    segment_stamp(mem);
+
     /* ==============================================================
        SALIDA DE INFORMACION
        --------------------------------------------------------------
@@ -133,7 +592,34 @@ int main(int argc, char *argv[]) {
     printf("ID memoria: %d\n", shm_id);
     printf("Clave XOR: %d\n", xor_key);
     printf("Archivo fuente: %s\n", filename);
-    printf("Tamaño del buffer: %d caracteres\n", size);
+    printf("Tamaño del buffer: %lld bytes\n", size);
+    printf("Modo del buffer: %s\n", ring_mode == RING_MODE_LOCKFREE ? "lock-free" : "semáforos");
+    if (layout == LAYOUT_RECORD)
+        printf("Distribución: registros por %s (anillo de %lld bytes, registro máximo %d bytes)\n",
+               frame_lines ? "línea" : "tramo", mem->slots, ring_record_max(mem));
+    else
+        printf("Distribución: %s (%lld ranuras de %d bytes)\n",
+               layout == LAYOUT_TRACE ? "traza" : "compacta", slots, slot_bytes);
+    if (shards > 1) printf("Fragmentos del anillo: %d\n", shards);
+    if (seg_flags & SEG_HUGETLB) printf("Páginas: enormes de %zu KiB (%zu bytes)\n", huge_page / 1024, segment_bytes);
+    if (seg_flags & SEG_PREFAULT) printf("Segmento: prefault%s\n", (seg_flags & SEG_LOCKED) ? " y fijado en RAM" : "");
+    if (cpus) printf("CPUs del Inicializador: %s\n", cpus);
+    printf("Sincronización: %s\n", sync_mode == SYNC_FUTEX ? "futex" : "semop");
+    printf("Tramo por emisor: %lld bytes\n", chunk_size);
+    printf("Lectura de fuente: %s\n", source_mode == SOURCE_MMAP ? "mmap" : "pread");
+    if (codec == CODEC_ROLL) printf("Códec: roll (clave de %d bytes)\n", codec_key_len);
+    else                     printf("Códec: xor\n");
+    printf("Ventana de reordenamiento: %lld bytes\n", window);
+    if (pace_rate > 0) printf("Cubeta de ritmo global: %lld bytes/s por rol\n", pace_rate);
+    printf("Escritura de salida: %s\n", output_mode == OUTPUT_MMAP ? "mmap" :
+                                          output_mode == OUTPUT_PWRITE ? "pwrite" : "append");
+    if (ckpt_every > 0) printf("Puntos de control: cada %lld bytes\n", ckpt_every);
+    if (resume) printf("Reanudación: %s desde %lld de %lld bytes\n", resume, resume_from, source_bytes);
+    if (jobs_max > 0)
+        printf("Cola de flujos: tabla de %d trabajos, %lld encolados (%lld bytes)\n",
+               jobs_max, queued, (long long)atomic_load(&mem->jobs_end));
+    if (ingest > 0) printf("Ingesta: área de %lld bytes; la llena ./ingestor desde %s\n",
+                           ingest, strcmp(filename, "-") == 0 ? "su entrada estándar" : filename);
 
     /* ==============================================================
        DESVINCULACIÓN FINAL
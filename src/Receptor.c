@@ -13,17 +13,51 @@
 
     Según la descripción del proyecto:
       - El receptor debe leer de forma circular los valores de la estructura.
-      - No puede usar busy waiting; debe bloquearse si no hay datos (full = 0).
-      - Debe mostrar en consola cada carácter leído (en tiempo real).
+      - No puede usar busy waiting; debe bloquearse si no hay datos (full = 0,
+        o timbre del anillo lock-free según el modo del Inicializador).
+      - Debe mostrar en consola cada carácter leído (en tiempo real); lo
+        hace un hilo registrador (logger.h) para que la terminal nunca
+        frene el camino de datos.
       - Debe reconstruir colaborativamente el archivo de salida.
       - Puede haber múltiples receptores simultáneos.
+
+    Modos de salida (output_mode, fijado por el Inicializador):
+      - OUTPUT_APPEND: la ventana de reordenamiento vuelca en orden con
+        escrituras "append".
+      - OUTPUT_PWRITE / OUTPUT_MMAP: el archivo se preasigna al tamaño de la
+        fuente y cada receptor escribe en el desplazamiento seq (pwrite o
+        mapeo compartido) sin esperar a nadie; la ventana solo lleva la
+        marca de completitud next_to_flush.
+      - Cola de flujos (jobs_max > 0, ver stream.h): como OUTPUT_PWRITE,
+        pero cada seq va al destino de su trabajo, en seq - base; el
+        archivo_salida de la línea de comandos no se usa.
+    Extracción por lotes: cada vuelta toma hasta B ranuras de una vez
+    (ring_pop_batch) y actualiza contadores, ritmo y salida una vez por
+    lote; los tramos con seq consecutivos se decodifican y persisten
+    juntos. B sigue a la ocupación del fragmento: 1 con el anillo casi
+    vacío (latencia) y hasta -b bajo atraso (caudal).
+    Con la distribución de registros (LAYOUT_RECORD) cada registro se
+    decodifica y persiste en el lugar, dentro del anillo, y recién entonces
+    se libera (ring_peek/ring_release); su seq propio ordena la salida.
+    Puntos de control: tras cada lote, el receptor que ve next_to_flush
+    pasar ckpt_next deja la salida en disco y escribe "<salida>.ckpt"
+    (checkpoint.h); al salir escribe uno final.
+    Escritor de salida (OUTPUT_PWRITE, writer.h): los tramos del lote se
+    unen y se escriben con pwritev o se envían a io_uring al cerrar el
+    lote, y se marcan en la ventana al terminar la escritura; el anillo se
+    sigue vaciando mientras el disco escribe. Antes de una extracción que
+    va a bloquear, lo pendiente se completa.
  ============================================================================
 */
 #define _XOPEN_SOURCE 700
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <sys/sem.h>
@@ -31,70 +65,313 @@
 #include <time.h>
 #include <errno.h>
 #include "shared.h"
+#include "ring.h"
+#include "codec.h"
+#include "reorder.h"
+#include "proc.h"
+#include "segment.h"
+#include "affinity.h"
+#include "logger.h"
+#include "pacing.h"
+#include "recover.h"
+#include "checkpoint.h"
+#include "stream.h"
+#include "writer.h"
+
+
+/* --------------------------------------------------------------------------
+   Función: print_table
+   Muestra de manera elegante la información de cada carácter leído.
+   Incluye color, índice, carácter decodificado y hora de inserción, seguido
+   del carácter tal cual. Corre en el hilo registrador (logger.h).
+   -------------------------------------------------------------------------- */
+static void print_table(const LogRec *r) {
+    char when[32];
+    printf("\033[1;35m---------------------------------------------\033[0m\n");
+    printf("\033[1;36m| Índice | Carácter | Hora de Inserción     |\033[0m\n");
+    printf("\033[1;33m| %6lld | %8c | %s\033[0m",
+           r->index, (r->c >= 32 && r->c <= 126) ? r->c : '?', ctime_r(&r->ts, when));
+    printf("\033[1;35m---------------------------------------------\033[0m\n");
+    putchar(r->c);
+}
 
 /* --------------------------------------------------------------------------
-   Funciones auxiliares para manejo de semáforos
+   Salida reconstruida
+   --------------------------------------------------------------------------
+   sink_write() persiste n bytes decodificados que corresponden al seq dado:
+     - OUTPUT_APPEND: los deposita en la ventana (escritura en orden).
+     - OUTPUT_PWRITE: al escritor de salida (writer.h), que escribe en el
+                      desplazamiento seq y marca al terminar.
+     - OUTPUT_MMAP  : copia al mapeo compartido del archivo de salida.
+     - trabajos     : pwrite en el destino de cada trabajo (stream_write).
+   En los modos posicionales luego marca el rango como completo y registra
+   la latencia enq→disco (en append la registra quien vuelca la ventana;
+   con el escritor, él mismo al terminar cada pedido). sink_submit() cierra
+   el lote: hasta entonces el escritor puede seguir leyendo de data.
    -------------------------------------------------------------------------- */
+typedef struct {
+    int mode;          // OUTPUT_APPEND | OUTPUT_PWRITE | OUTPUT_MMAP
+    const char *path;  // archivo de salida (y base del punto de control)
+    FILE *fp;          // salida en modo append
+    int fd;            // salida posicional
+    char *map;         // mapeo compartido (OUTPUT_MMAP)
+    long long size;    // tamaño preasignado (= tamaño de la fuente)
+    SharedMemory *jobs;// segmento con cola de flujos (NULL = salida única)
+    StreamFile file;   // destino abierto del trabajo actual
+    int writing;       // salida por el escritor (OUTPUT_PWRITE)
+    Writer w;
+} Sink;
 
-// Disminuye el valor del semáforo (bloquea si es necesario)
-static int sem_wait_raw(int sem_id, int sem_num) {
-    struct sembuf op = {sem_num, -1, 0};
-    return semop(sem_id, &op, 1);
+// Opciones del escritor de salida (-w, -D, -d)
+typedef struct {
+    int backend;
+    int direct;
+    int durable;
+    long long durable_arg;
+} SinkOpts;
+
+static int sink_open(Sink *out, const char *path, SharedMemory *mem, ProcEntry *self,
+                     const SinkOpts *opts, size_t max_put) {
+    memset(out, 0, sizeof(*out));
+    out->mode = mem->output_mode;
+    out->path = path;
+    out->fd = -1;
+
+    if ((mem->jobs_max > 0 || out->mode != OUTPUT_PWRITE) &&
+        (opts->backend != WRITER_AUTO || opts->direct || opts->durable != DURABLE_NONE)) {
+        fprintf(stderr, "-w, -D y -d requieren salida pwrite de un solo archivo (-o pwrite en el Inicializador, sin -J)\n");
+        return -1;
+    }
+
+    if (mem->jobs_max > 0) {
+        // Los destinos los crea quien encola; se abren al primer tramo
+        out->mode = OUTPUT_PWRITE;
+        out->jobs = mem;
+        stream_file_init(&out->file, 1);
+        return 0;
+    }
+
+    if (out->mode == OUTPUT_APPEND) {
+        out->fp = fopen(path, "a");
+        if (!out->fp) { perror("fopen salida"); return -1; }
+
+        // El primero en abrir fija lo que la salida ya tenía: nadie
+        // escribe antes de haber intentado este CAS
+        struct stat st;
+        long long unset = -1;
+        if (fstat(fileno(out->fp), &st) == 0)
+            atomic_compare_exchange_strong(&mem->out_base, &unset, (long long)st.st_size);
+        return 0;
+    }
+
+    // Modos posicionales: el archivo queda exactamente del tamaño de la
+    // fuente. Todos los receptores repiten la operación sin dañar datos.
+    out->size = mem->source_bytes;
+    out->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (out->fd == -1) { perror("open salida"); return -1; }
+    if (ftruncate(out->fd, (off_t)out->size) == -1) { perror("ftruncate salida"); close(out->fd); return -1; }
+    int err = (out->size > 0) ? posix_fallocate(out->fd, 0, (off_t)out->size) : 0;
+    if (err != 0 && err != EOPNOTSUPP && err != EINVAL) {
+        errno = err; perror("posix_fallocate salida");
+        close(out->fd); return -1;
+    }
+
+    if (out->mode == OUTPUT_MMAP && out->size > 0) {
+        void *m = mmap(NULL, (size_t)out->size, PROT_READ | PROT_WRITE, MAP_SHARED, out->fd, 0);
+        if (m == MAP_FAILED) { perror("mmap salida"); close(out->fd); return -1; }
+        out->map = (char *)m;
+    }
+    if (out->mode == OUTPUT_PWRITE) {
+        if (writer_open(&out->w, mem, self, out->fd, path, opts->backend, opts->direct,
+                        opts->durable, opts->durable_arg, max_put) == -1) {
+            close(out->fd); return -1;
+        }
+        out->writing = 1;
+    }
+    return 0;
+}
+
+static int sink_write(Sink *out, SharedMemory *mem, const char *data, int n, long long seq,
+                      long long enq_ns) {
+    if (out->mode == OUTPUT_APPEND) return reorder_deposit(mem, data, n, seq, enq_ns, out->fp);
+
+    if (out->jobs) {
+        if (stream_write(&out->file, out->jobs, data, n, seq) == -1)
+            fprintf(stderr, "\n[WARN] seq %lld sin destino escribible (%s); se descarta\n", seq, strerror(errno));
+    } else if (seq + n > out->size) {
+        fprintf(stderr, "\n[WARN] seq %lld fuera del tamaño de la fuente; se descarta\n", seq);
+    } else if (out->writing) {
+        return writer_put(&out->w, data, n, seq, enq_ns);
+    } else {
+        memcpy(out->map + seq, data, (size_t)n);
+    }
+    lat_record(&mem->lat[LAT_DISK], lat_now() - enq_ns, n);
+    return reorder_complete(mem, n, seq);
 }
-// Incrementa el valor del semáforo (libera recurso)
-static int sem_signal_raw(int sem_id, int sem_num) {
-    struct sembuf op = {sem_num, 1, 0};
-    return semop(sem_id, &op, 1);
+
+// Cierra el lote: el escritor ya no lee de los tramos anotados
+static int sink_submit(Sink *out) {
+    return out->writing ? writer_submit(&out->w) : 0;
 }
 
+// 1 si los tramos anotados siguen sin escribir hasta sink_submit
+static int sink_deferred(Sink *out) {
+    return out->writing && writer_deferred(&out->w);
+}
+
+// Completa y marca lo pendiente del escritor (antes de bloquear)
+static int sink_idle(Sink *out) {
+    return out->writing ? writer_idle(&out->w) : 0;
+}
 
 /* --------------------------------------------------------------------------
-   Función: print_table
-   Muestra de manera elegante la información de cada carácter leído.
-   Incluye color, índice, carácter decodificado y hora de inserción.
+   Tamaño de lote
+   La parte de este receptor en la ocupación de su fragmento, entre 1 y
+   batch_max: sin atraso no se agrupa nada y bajo atraso no se deja sin
+   trabajo a los demás receptores del fragmento (peers).
    -------------------------------------------------------------------------- */
-static void print_table(int index, char c_dec, time_t t_ins) {
-    printf("\033[1;35m---------------------------------------------\033[0m\n");
-    printf("\033[1;36m| Índice | Carácter | Hora de Inserción     |\033[0m\n");
-    printf("\033[1;33m| %6d | %8c | %s\033[0m",
-           index, (c_dec >= 32 && c_dec <= 126) ? c_dec : '?', ctime(&t_ins));
-    printf("\033[1;35m---------------------------------------------\033[0m\n");
+static int batch_size(SharedMemory *mem, int shard, int batch_max, int peers) {
+    if (batch_max <= 1) return 1;
+    long long share = ring_shard_count(mem, shard % mem->shards) / peers;
+    if (share < 1) return 1;
+    return (share < batch_max) ? (int)share : batch_max;
+}
+
+// Receptores por fragmento (al menos 1)
+static int batch_peers(SharedMemory *mem) {
+    int n = proc_active(mem, ROLE_RECEIVER) / (mem->shards > 0 ? mem->shards : 1);
+    return (n > 1) ? n : 1;
 }
 
 /* --------------------------------------------------------------------------
-   Función: tiny_sleep_ns
-   Breve suspensión en nanosegundos para reintentos ordenados.
-   Utilizada cuando el receptor espera su turno de escritura.
+   Entrega directa (recover.h)
+   Lo que un proceso muerto dejó sin publicar o sin persistir llega en claro
+   desde la fuente y se persiste como cualquier tramo. Nunca espera lugar en
+   la ventana: el seq que la traba puede ser uno que este mismo receptor
+   tiene en la mano mientras recupera. Con el escritor de salida se
+   escribe y marca directo (writer_now): la entrega puede llegar mientras
+   el escritor espera lugar en la ventana a mitad de una marca.
    -------------------------------------------------------------------------- */
-static void tiny_sleep_ns(long ns) {
-    struct timespec d = {0, ns};
-    nanosleep(&d, NULL);
+typedef struct {
+    Sink *out;
+    SharedMemory *mem;
+} Redeliver;
+
+static int redeliver(void *arg, const char *data, int n, long long seq) {
+    Redeliver *r = arg;
+    if (!reorder_fits(r->mem, n, seq)) return 1;
+    if (r->out->writing) return writer_now(&r->out->w, data, n, seq, lat_now());
+    return sink_write(r->out, r->mem, data, n, seq, lat_now());
+}
+
+// Gancho de espera prolongada: completar lo propio antes de recuperar ajenos
+typedef struct {
+    Sink *out;
+    Recovery *rcv;
+} Stall;
+
+static void on_stall(void *arg) {
+    Stall *st = arg;
+    sink_idle(st->out);
+    recover_hook(st->rcv);
+}
+
+// Punto de control si toca (checkpoint.h); force al salir
+static void sink_checkpoint(Sink *out, SharedMemory *mem, int force) {
+    int fd = out->fp ? fileno(out->fp) : out->fd;
+    if (fd != -1) ckpt_maybe(mem, fd, out->path, force);
+}
+
+static void sink_close(Sink *out) {
+    if (out->writing) writer_close(&out->w);
+    if (out->map) munmap(out->map, (size_t)out->size);
+    if (out->fd != -1) close(out->fd);
+    if (out->fp) fclose(out->fp);
+    if (out->jobs) stream_file_close(&out->file);
 }
 
 /* --------------------------------------------------------------------------
    PROCESO PRINCIPAL DEL RECEPTOR
    Uso:
-       ./receptor <id_memoria> <modo> <clave_xor> <archivo_salida>
+       ./receptor [-v nivel] [-n N] [-p ritmo] [-a cpus] [-b lote] <id_memoria> <modo> <clave_xor> <archivo_salida>
        - id_memoria     : identificador usado por ftok() (entero)
-       - modo           : 0 = manual | 1 = automático
+       - modo           : 0 = manual | 1 = automático | 2 = continuo (sin
+                          pausas, para benchmarks)
        - clave_xor      : clave de decodificación XOR
-       - archivo_salida : nombre del archivo reconstruido
+       - archivo_salida : nombre del archivo reconstruido (con cola de
+                          flujos no se usa: cada trabajo lleva su destino)
+       - -v nivel       : salida en consola: full, sample (1 de cada N),
+                          summary o silent. Por defecto full, o silent en
+                          modo continuo.
+       - -n N           : razón de muestreo de -v sample (por defecto 100)
+       - -p ritmo       : unlimited, fixed, rate:B, global o replay:ARCHIVO
+                          (ver Emisor.c y pacing.h). Por defecto fixed en
+                          modo automático y unlimited en los demás.
+       - -a cpus        : fija el proceso a esas CPUs ("0-3,8" o "node:N")
+       - -b lote        : ranuras máximas por extracción (por defecto 32;
+                          1 = de a una). El modo manual siempre usa 1.
+       - -w motor       : escritor de la salida pwrite: auto (por defecto:
+                          uring con -D, si no pwritev), uring, pwritev o
+                          pwrite (síncrono por tramo)
+       - -D             : O_DIRECT para los bloques enteros de la salida
+       - -d política    : durabilidad: none (por defecto), periodic:MS
+                          (fdatasync cada MS ms) o group:BYTES (marcar
+                          solo tras un fdatasync común cada BYTES)
    -------------------------------------------------------------------------- */
 int main(int argc, char *argv[]) {
     /* ==============================================================
        VALIDACIÓN DE PARÁMETROS
        ============================================================== */
-    if (argc != 5) {
-        fprintf(stderr, "Uso: %s <id_memoria> <modo(0|1)> <clave_xor> <archivo_salida>\n", argv[0]);
+    int log_level = -1;
+    long long log_every = 100;
+    const char *pace_spec = NULL;
+    const char *cpus = NULL;
+    int batch_max = RECV_BATCH_DEFAULT;
+    SinkOpts sink_opts = { WRITER_AUTO, 0, DURABLE_NONE, 0 };
+    int opt;
+    while ((opt = getopt(argc, argv, "v:n:p:a:b:w:Dd:")) != -1) {
+        switch (opt) {
+        case 'v':
+            log_level = logger_level(optarg);
+            if (log_level < 0) { fprintf(stderr, "Nivel de salida desconocido: %s (use full|sample|summary|silent)\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'n':
+            log_every = atoll(optarg);
+            if (log_every < 1) { fprintf(stderr, "Razón de muestreo inválida: %s\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'p': pace_spec = optarg; break;
+        case 'a': cpus = optarg; break;
+        case 'b':
+            batch_max = atoi(optarg);
+            if (batch_max < 1 || batch_max > RECV_BATCH_MAX) { fprintf(stderr, "Lote inválido: %s (1 a %d)\n", optarg, RECV_BATCH_MAX); exit(EXIT_FAILURE); }
+            break;
+        case 'w':
+            sink_opts.backend = writer_backend(optarg);
+            if (sink_opts.backend < 0) { fprintf(stderr, "Escritor desconocido: %s (use auto|uring|pwritev|pwrite)\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'D': sink_opts.direct = 1; break;
+        case 'd':
+            if (writer_durability(optarg, &sink_opts.durable, &sink_opts.durable_arg) == -1) exit(EXIT_FAILURE);
+            break;
+        default:
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (argc - optind != 4) {
+        fprintf(stderr, "Uso: %s [-v full|sample|summary|silent] [-n N] [-p ritmo] [-a cpus] [-b lote] [-w motor] [-D] [-d política] <id_memoria> <modo(0|1|2)> <clave_xor> <archivo_salida>\n", argv[0]);
         exit(EXIT_FAILURE);
     }
+    if (cpus && affinity_apply(cpus) == -1) exit(EXIT_FAILURE);
+    argv += optind - 1; // argv[1..4] quedan como los parámetros posicionales
 
     key_t shm_key = ftok(".", atoi(argv[1]));
     if (shm_key == (key_t)-1) { perror("ftok"); exit(EXIT_FAILURE); }
 
-    int mode     = atoi(argv[2]);  // 0 manual, 1 automático
+    int mode     = atoi(argv[2]);  // RUN_MANUAL | RUN_AUTO | RUN_CONTINUOUS
     int xor_key  = atoi(argv[3]);
     const char *out_path = argv[4];
+    if (log_level < 0) log_level = (mode == RUN_CONTINUOUS) ? LOG_SILENT : LOG_FULL;
+    if (mode == RUN_MANUAL) batch_max = 1; // un ENTER por ranura
     
      /* ==============================================================
        CONEXIÓN A LA MEMORIA COMPARTIDA Y SEMÁFOROS EXISTENTES
@@ -104,136 +381,180 @@ int main(int argc, char *argv[]) {
 
     SharedMemory *mem = (SharedMemory*)shmat(shm_id, NULL, 0);
     if (mem == (void*)-1) { perror("shmat"); exit(EXIT_FAILURE); }
+    if (segment_check(mem) == -1) { shmdt(mem); exit(EXIT_FAILURE); }
+    segment_warm(mem); // fallos de página ahora, no en el camino de datos
 
     int sem_id = semget(shm_key, 3, 0666);
     if (sem_id == -1) { perror("semget"); shmdt(mem); exit(EXIT_FAILURE); }
 
     /* ==============================================================
-       REGISTRO DE RECEPTOR ACTIVO Y TOTAL (protegido con mutex)
+       RITMO DE LECTURA (pacing.h)
        ============================================================== */
-    if (sem_wait_raw(sem_id, 0) == -1) {
-        if (errno==EIDRM || errno==EINVAL) goto graceful_exit;
-        perror("semop wait mutex start"); goto graceful_exit;
+    Pacer pacer;
+    if (pace_spec) {
+        if (pacer_parse(&pacer, pace_spec, mem, ROLE_RECEIVER) == -1) { shmdt(mem); exit(EXIT_FAILURE); }
+    } else {
+        pacer_default(&pacer, mode);
     }
-    mem->receivers_active++;
-    mem->receivers_total++;
-    if (sem_signal_raw(sem_id, 0) == -1) {
-        if (errno==EIDRM || errno==EINVAL) goto graceful_exit;
-        perror("semop signal mutex start"); goto graceful_exit;
+
+    /* ==============================================================
+       REGISTRO DE RECEPTOR EN LA TABLA DE PROCESOS
+       ============================================================== */
+    Codec codec;
+    if (codec_init(&codec, mem->codec, xor_key, mem->codec_key_len, CODEC_IMPL_AUTO) == -1) {
+        fprintf(stderr, "Códec no disponible en esta CPU\n"); shmdt(mem); exit(EXIT_FAILURE);
     }
+    ProcEntry *self = proc_register(mem, ROLE_RECEIVER);
+    if (!self) { perror("proc_register"); shmdt(mem); exit(EXIT_FAILURE); }
 
     /* ==============================================================
        APERTURA DE ARCHIVO DE SALIDA
-       Todos los receptores escriben en modo "append",
-       pero solo lo hacen cuando es su turno.
+       En modo "append" el candado de volcado de la ventana garantiza
+       el orden entre receptores; en los modos posicionales cada uno
+       escribe directamente en el desplazamiento de su seq.
        ============================================================== */
-    FILE *fout = fopen(out_path, "a");
-    if (!fout) { perror("fopen salida"); goto graceful_exit; }
+    int status = EXIT_SUCCESS;
+    Sink out;
+    size_t max_put = (size_t)batch_max * (size_t)mem->slot_bytes;
+    if (mem->layout == LAYOUT_RECORD && (size_t)ring_record_max(mem) > max_put) max_put = (size_t)ring_record_max(mem);
+    if (max_put < 65536) max_put = 65536; // entregas directas de recover.c
+    if (sink_open(&out, out_path, mem, self, &sink_opts, max_put) == -1) { status = EXIT_FAILURE; goto graceful_exit; }
 
-    printf("\nReceptor iniciado (modo %s). Escribiendo colaborativamente en: %s\n",
-           mode==1 ? "automático" : "manual", out_path);
+    // Cada extracción trae hasta batch_max ranuras completas (un tramo cada
+    // una en modo compacto), contiguas en chunk
+    char *chunk = malloc((size_t)batch_max * (size_t)mem->slot_bytes);
+    RingChunk *batch = malloc((size_t)batch_max * sizeof(RingChunk));
+    if (!chunk || !batch) {
+        perror("malloc"); free(chunk); free(batch); sink_close(&out); status = EXIT_FAILURE; goto graceful_exit;
+    }
+    for (int i = 0; i < batch_max; i++) batch[i].data = chunk + (size_t)i * (size_t)mem->slot_bytes;
+
+    static Logger lg; // anillo de consola (grande: fuera de la pila)
+    if (logger_start(&lg, log_level, log_every, print_table, "receptor") == -1) {
+        perror("logger_start"); free(chunk); free(batch); sink_close(&out); status = EXIT_FAILURE; goto graceful_exit;
+    }
+    // Bloqueado más de SYNC_STALL_NS: revisar si otro proceso murió con
+    // algo en la mano y completarlo (recover.h)
+    Redeliver redo = { &out, mem };
+    Recovery rcv = { .mem = mem, .sem_id = sem_id, .codec = &codec,
+                     .deliver = redeliver, .arg = &redo, .out = out.fp };
+    Stall stall = { &out, &rcv };
+    sync_on_stall(on_stall, &stall);
+    if (log_level != LOG_SILENT) {
+        printf("\nReceptor iniciado (modo %s). Escribiendo colaborativamente en: %s\n",
+               mode == RUN_AUTO ? "automático" : mode == RUN_MANUAL ? "manual" : "continuo", out_path);
+        if (out.writing)
+            printf("Escritor de salida: %s%s\n", writer_name(out.w.backend), (out.w.dfd != -1) ? " con O_DIRECT" : "");
+    }
 
     /* ==============================================================
        BUCLE PRINCIPAL DE LECTURA Y DECODIFICACIÓN
        --------------------------------------------------------------
-       1) Espera hasta que haya datos (semáforo full)
-       2) Entra en sección crítica (mutex)
-       3) Extrae el carácter y actualiza índices
-       4) Decodifica y muestra en consola
-       5) Escribe en el archivo cuando corresponda (turno)
+       1) Extrae un lote de ranuras del buffer (ring_pop_batch bloquea
+          si no hay datos; el mecanismo depende del modo del anillo)
+       2) Decodifica y deja cada carácter para la consola (asíncrona)
+       3) Lo persiste: ventana de reordenamiento (append) o escritura
+          directa en el desplazamiento seq (modos posicionales)
        ============================================================== */
-    for (;;) {
-        // Esperar a que exista al menos un dato disponible
-        if (sem_wait_raw(sem_id, 2) == -1) {
-            if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (full). Saliendo receptor...\n"); break; }
-            perror("semop wait full"); break;
-        }
-        // Entrar a la sección crítica
-        if (sem_wait_raw(sem_id, 0) == -1) {
-            if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (mutex). Saliendo receptor...\n"); break; }
-            perror("semop wait mutex"); break;
+    int records = (mem->layout == LAYOUT_RECORD);
+    int peers = batch_peers(mem);
+    long long run_max = (mem->reorder_size < INT_MAX) ? mem->reorder_size : INT_MAX;
+    for (long long round = 1;; round++) {
+        // La extracción va a bloquear: que nadie espere en la ventana a lo
+        // que el escritor tiene pendiente
+        if (out.writing && out.w.used > 0 && ring_shard_count(mem, self->shard % mem->shards) == 0 &&
+            sink_idle(&out) == -1) {
+            if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (ventana). Saliendo receptor...\n"); break; }
+            perror("sink_idle"); status = EXIT_FAILURE; break;
         }
-
-        // Leer el carácter del buffer circular
-        int idx = mem->read_index;
-        SharedChar sc = mem->buffer[idx];
-        mem->buffer[idx].is_full = 0;                //Marcar espacio vacio
-        mem->read_index = (idx + 1) % mem->size;     //Avance Circular
-        if (mem->count > 0) mem->count--;            //Decrementar contador
-
-
-        // Liberar la sección crítica y avisar que hay espacio libre
-        if (sem_signal_raw(sem_id, 0) == -1) {
-            if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (unlock). Saliendo receptor...\n"); break; }
-            perror("semop signal mutex"); break;
+        // Extraer el siguiente lote (bloquea si el buffer está vacío).
+        // Con registros no hay copia: se trabaja dentro del anillo hasta
+        // ring_release, de a un registro.
+        RingRecord rec;
+        int got;
+        if (records) {
+            got = ring_peek(mem, &rec);
+            if (got == 0) {
+                got = 1;
+                batch[0] = (RingChunk){ .data = rec.data, .len = rec.len, .seq = rec.seq,
+                                        .timestamp = rec.timestamp, .enq_ns = rec.enq_ns, .index = rec.index };
+            }
+        } else {
+            if (round % 1024 == 0) peers = batch_peers(mem);
+            got = ring_pop_batch(mem, sem_id, self->shard, batch,
+                                 batch_size(mem, self->shard, batch_max, peers));
         }
-        if (sem_signal_raw(sem_id, 1) == -1) {
-            if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (empty++). Saliendo receptor...\n"); break; }
-            perror("semop signal empty"); break;
+        if (got == -1) {
+            if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (buffer). Saliendo receptor...\n"); break; }
+            perror("extracción del buffer"); status = EXIT_FAILURE; break;
         }
 
-        // Decodificar el carácter leído mediante XOR
-        char c_dec = (char)((unsigned char)sc.ascii ^ (unsigned char)xor_key);
-
-        // Contabilizar el carácter consumido (bloque corto protegido)
-        if (sem_wait_raw(sem_id, 0) == -1) {
-            if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (mutex stats). Saliendo receptor...\n"); break; }
-            perror("semop wait mutex stats"); break;
-        }
-        mem->total_consumed++;
-        if (sem_signal_raw(sem_id, 0) == -1) {
-            if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (unlock stats). Saliendo receptor...\n"); break; }
-            perror("semop signal mutex stats"); break;
+        long long bytes = 0;
+        long long now = lat_now();
+        for (int i = 0; i < got; i++) {
+            bytes += batch[i].len;
+            lat_record(&mem->lat[LAT_DEQUEUE], now - batch[i].enq_ns, batch[i].len);
         }
+        proc_add(self, bytes);
+        logger_count(&lg, bytes);
 
-        // Mostrar en consola en tiempo real
-        print_table(sc.index, c_dec, sc.timestamp);
-        putchar(c_dec);
-        fflush(stdout);
-
-       /* ----------------------------------------------------------
+        /* ----------------------------------------------------------
            Escritura colaborativa:
-           Cada receptor espera a que su turno (seq == next_to_flush)
-           para escribir en el archivo en orden secuencial.
+           Cada corrida de tramos con seq consecutivos (y contiguos en
+           chunk) se decodifica de una vez y se deposita en la ventana
+           de reordenamiento en la posición de su seq, sin esperar
+           turno. Quien completa una corrida contigua desde
+           next_to_flush la escribe completa. (En modo posicional se
+           escribe directo en el offset seq.) Una corrida no pasa de la
+           ventana: un depósito más largo esperaría lugar para siempre.
            ---------------------------------------------------------- */
-        for (;;) {
-            if (sem_wait_raw(sem_id, 0) == -1) {
-                if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (mutex flush). Saliendo receptor...\n"); goto end_loop; }
-                perror("semop wait mutex flush"); goto end_loop;
-            }
-            long long expected = mem->next_to_flush;
-            if (sc.seq == expected) {
-                // Determina si es su turno para escribir y avanza
-                if (fputc(c_dec, fout) == EOF) perror("fputc");
-                fflush(fout);
-                mem->next_to_flush = expected + 1;
-                if (sem_signal_raw(sem_id, 0) == -1) {
-                    if (!(errno == EIDRM || errno == EINVAL)) perror("semop signal mutex flush");
-                }
-                break; //Listo el caracter
-            }
-            // No es el turno aun: libera el mutex y espera un rato
-            if (sem_signal_raw(sem_id, 0) == -1) {
-                if (!(errno == EIDRM || errno == EINVAL)) perror("semop signal mutex flush (not yet)");
-            }
-            tiny_sleep_ns(50000000L); // 50 ms
+        int wr = 0;
+        for (int i = 0; i < got && wr == 0;) {
+            int first = i;
+            RingChunk *run = &batch[i];
+            int len = run->len;
+            for (i++; i < got && batch[i].seq == run->seq + len && batch[i].data == run->data + len &&
+                      len + batch[i].len <= run_max; i++)
+                len += batch[i].len;
+            codec_apply(&codec, run->data, run->data, (size_t)len, run->seq);
+            if (log_level < LOG_SUMMARY)
+                for (RingChunk *c = run; c < &batch[i]; c++)
+                    for (int j = 0; j < c->len; j++)
+                        logger_char(&lg, c->index + j, (unsigned char)c->data[j], c->timestamp);
+            wr = sink_write(&out, mem, run->data, len, run->seq, run->enq_ns);
+            if (wr == 0 && !sink_deferred(&out)) proc_lease_drop(self, first, i - first); // ya persistidos
+        }
+        if (wr == 0) wr = sink_submit(&out); // el arriendo pasa a sus pedidos
+        if (records) ring_release(mem, &rec);
+        if (wr == -1) {
+            // Lo no persistido queda en arriendo para recover.c
+            if (errno == EIDRM || errno == EINVAL) { fprintf(stderr, "\n[INFO] IPC retirados (ventana). Saliendo receptor...\n"); break; }
+            perror("sink_write"); status = EXIT_FAILURE; break;
         }
+        proc_lease_clear(self);
+        sink_checkpoint(&out, mem, 0);
 
-        // Control de modo de ejecucion
-        if (mode == 0) {
-            printf("\nPresione ENTER para leer el siguiente carácter...\n");
+        // Control de modo de ejecucion y ritmo (pacing.h)
+        if (mode == RUN_MANUAL) {
+            logger_flush(&lg);
+            printf("\nPresione ENTER para leer la siguiente ranura...\n");
             getchar();
-        } else {
-            struct timespec d = {0, 400000000L}; // 0.4 s
-            nanosleep(&d, NULL);
         }
-        continue;
-
-end_loop:
-        break;
+        if (pacer_wait(&pacer, mem, bytes) == -1) {
+            fprintf(stderr, "\n[INFO] IPC retirados (ritmo). Saliendo receptor...\n"); break;
+        }
     }
 
-    if (fout) fclose(fout);
+    sync_on_stall(NULL, NULL);
+    logger_stop(&lg);
+    free(chunk);
+    free(batch);
+    // Lo pendiente del escritor, antes del punto final
+    if (sink_idle(&out) == -1 && status == EXIT_SUCCESS && errno != EIDRM && errno != EINVAL) {
+        perror("sink_idle"); status = EXIT_FAILURE;
+    }
+    sink_checkpoint(&out, mem, 1);
+    sink_close(&out);
     /* ==============================================================
        FINALIZACIÓN ELEGANTE DEL RECEPTOR
        --------------------------------------------------------------
@@ -241,17 +562,10 @@ end_loop:
        - Libera recursos compartidos
        ============================================================== */
 graceful_exit:
-    // Decrementar receptores activos (si se puede)
-    if (sem_wait_raw(sem_id, 0) == -1) {
-        if (!(errno == EIDRM || errno == EINVAL)) perror("semop wait mutex exit");
-    } else {
-        if (mem->receivers_active > 0) mem->receivers_active--;
-        if (sem_signal_raw(sem_id, 0) == -1) {
-            if (!(errno == EIDRM || errno == EINVAL)) perror("semop signal mutex exit");
-        }
-    }
+    proc_unregister(mem, self);
+    pacer_free(&pacer);
 
     shmdt(mem);
-    printf("\nReceptor finalizado correctamente.\n");
-    return 0;
+    if (log_level != LOG_SILENT && status == EXIT_SUCCESS) printf("\nReceptor finalizado correctamente.\n");
+    return status;
 }
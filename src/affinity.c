@@ -0,0 +1,76 @@
+/*
+ ============================================================================
+ Archivo: affinity.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Fijación de procesos a CPUs o nodos NUMA (ver affinity.h).
+ ============================================================================
+*/
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "affinity.h"
+
+// "0-3,8" -> set; -1 si la lista no es válida
+static int parse_list(const char *txt, cpu_set_t *set) {
+    CPU_ZERO(set);
+    const char *s = txt;
+    while (*s && *s != '\n') {
+        char *end;
+        long lo = strtol(s, &end, 10), hi = lo;
+        if (end == s || lo < 0) return -1;
+        if (*end == '-') {
+            s = end + 1;
+            hi = strtol(s, &end, 10);
+            if (end == s || hi < lo) return -1;
+        }
+        if (hi >= CPU_SETSIZE) return -1;
+        for (long c = lo; c <= hi; c++) CPU_SET((int)c, set);
+        s = end;
+        if (*s == ',') s++;
+        else if (*s && *s != '\n') return -1;
+    }
+    return CPU_COUNT(set) > 0 ? 0 : -1;
+}
+
+// Interpreta spec en *set; -1 con un mensaje en stderr
+static int affinity_parse(const char *spec, cpu_set_t *set) {
+    if (strncmp(spec, "node:", 5) == 0) {
+        char *end;
+        long node = strtol(spec + 5, &end, 10);
+        if (end == spec + 5 || *end != '\0' || node < 0) {
+            fprintf(stderr, "Nodo NUMA inválido: %s\n", spec + 5);
+            return -1;
+        }
+        char path[96], line[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%ld/cpulist", node);
+        FILE *f = fopen(path, "r");
+        if (!f) { fprintf(stderr, "Nodo NUMA %ld: %s\n", node, strerror(errno)); return -1; }
+        int ok = fgets(line, sizeof(line), f) != NULL;
+        fclose(f);
+        if (!ok || parse_list(line, set) == -1) {
+            fprintf(stderr, "Nodo NUMA %ld sin CPUs utilizables\n", node);
+            return -1;
+        }
+        return 0;
+    }
+    if (parse_list(spec, set) == -1) {
+        fprintf(stderr, "Lista de CPUs inválida: %s (use p. ej. 0-3,8 o node:N)\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+int affinity_apply(const char *spec) {
+    cpu_set_t set;
+    if (affinity_parse(spec, &set) == -1) return -1;
+    if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+        fprintf(stderr, "sched_setaffinity(%s): %s\n", spec, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+/*
+ =============================================================================
+  Archivo: affinity.h
+  Propósito:
+    Fijación de procesos a CPUs (-a en Inicializador, Emisor y Receptor).
+    Sin fijar, el planificador mueve los procesos entre núcleos y, en
+    máquinas con varios nodos NUMA, entre sockets: cada migración enfría
+    cachés y TLB y las líneas del segmento cruzan la interconexión.
+
+  Especificación:
+    - "0-3,8,10-11" : lista de CPUs (el formato de /sys y de taskset -c).
+    - "node:N"      : todas las CPUs del nodo NUMA N, leídas de
+                      /sys/devices/system/node/nodeN/cpulist.
+    Fijar el Inicializador a un nodo hace que el prefault (segment.h)
+    toque el segmento desde ahí y, por la política de primer toque del
+    kernel, sus páginas queden en la memoria de ese nodo.
+ =============================================================================
+*/
+// Interpreta spec y fija el proceso (todos sus hilos futuros) a esas CPUs.
+// 0, o -1 con un mensaje en stderr.
+int affinity_apply(const char *spec);
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ ============================================================================
+ Archivo: checkpoint.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Puntos de control de la salida y huella de la fuente (ver
+    checkpoint.h).
+
+    Formato del archivo lateral (texto, una clave por línea):
+      ipc-ckpt 1
+      flushed <seq>
+      length <bytes>
+      source_bytes <bytes>
+      source_fp <hex>
+    Se escribe en "<salida>.ckpt.<pid>", fsync, y rename sobre el
+    definitivo (más fsync del directorio para que el rename sea durable).
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "checkpoint.h"
+
+#define CKPT_EDGE   65536  // bytes de huella al inicio y al final de la fuente
+#define CKPT_BLOCK  4096   // bytes de cada muestra intermedia
+#define CKPT_BLOCKS 14     // muestras intermedias
+
+/* --------------------------------------------------------------------------
+   Huella
+   -------------------------------------------------------------------------- */
+static unsigned long long fnv1a(unsigned long long h, const void *data, size_t n) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Agrega a la huella hasta n bytes desde off; -1 si falla la lectura
+static int fp_range(int fd, long long off, size_t n, char *buf, unsigned long long *h) {
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = pread(fd, buf + got, n - got, (off_t)(off + (long long)got));
+        if (r == 0) break;
+        if (r == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        got += (size_t)r;
+    }
+    *h = fnv1a(*h, buf, got);
+    return 0;
+}
+
+int ckpt_fingerprint(const char *path, unsigned long long *fp) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return -1;
+    struct stat st;
+    char *buf = malloc(CKPT_EDGE);
+    if (!buf || fstat(fd, &st) == -1) { free(buf); close(fd); return -1; }
+
+    long long size = (long long)st.st_size;
+    unsigned long long h = fnv1a(0xcbf29ce484222325ULL, &size, sizeof(size));
+    int rc = fp_range(fd, 0, CKPT_EDGE, buf, &h);
+    for (int i = 1; rc == 0 && i <= CKPT_BLOCKS; i++)
+        rc = fp_range(fd, size / (CKPT_BLOCKS + 1) * i, CKPT_BLOCK, buf, &h);
+    if (rc == 0) rc = fp_range(fd, (size > CKPT_EDGE) ? size - CKPT_EDGE : 0, CKPT_EDGE, buf, &h);
+
+    int err = errno;
+    free(buf);
+    close(fd);
+    errno = err;
+    if (rc == 0) *fp = h;
+    return rc;
+}
+
+/* --------------------------------------------------------------------------
+   Archivo lateral
+   -------------------------------------------------------------------------- */
+int ckpt_path(char *buf, size_t cap, const char *out_path) {
+    int n = snprintf(buf, cap, "%s.ckpt", out_path);
+    return (n < 0 || (size_t)n >= cap) ? -1 : 0;
+}
+
+int ckpt_load(const char *out_path, Checkpoint *ck) {
+    char path[PATH_MAX];
+    if (ckpt_path(path, sizeof(path), out_path) == -1) {
+        fprintf(stderr, "Ruta de salida demasiado larga: %s\n", out_path);
+        return -1;
+    }
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return -1; }
+    int version = 0;
+    int ok = fscanf(f, "ipc-ckpt %d flushed %lld length %lld source_bytes %lld source_fp %llx",
+                    &version, &ck->flushed, &ck->length, &ck->source_bytes, &ck->source_fp) == 5;
+    fclose(f);
+    if (!ok || version != 1 || ck->flushed < 0 || ck->length < ck->flushed) {
+        fprintf(stderr, "%s: punto de control inválido\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// fsync del directorio que contiene path (el rename queda durable)
+static void sync_dir(const char *path) {
+    char dir[PATH_MAX];
+    const char *slash = strrchr(path, '/');
+    if (!slash) {
+        strcpy(dir, ".");
+    } else {
+        size_t n = (slash == path) ? 1 : (size_t)(slash - path);
+        memcpy(dir, path, n);
+        dir[n] = '\0';
+    }
+    int fd = open(dir, O_RDONLY);
+    if (fd == -1) return;
+    fsync(fd);
+    close(fd);
+}
+
+static int ckpt_write(SharedMemory *mem, const char *out_path, long long flushed) {
+    char path[PATH_MAX], tmp[PATH_MAX + 32];
+    if (ckpt_path(path, sizeof(path), out_path) == -1) { errno = ENAMETOOLONG; return -1; }
+    snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid());
+
+    long long base = atomic_load(&mem->out_base);
+    char text[256];
+    int n = snprintf(text, sizeof(text),
+                     "ipc-ckpt 1\nflushed %lld\nlength %lld\nsource_bytes %lld\nsource_fp %016llx\n",
+                     flushed, ((base > 0) ? base : 0) + flushed, mem->source_bytes, mem->source_fp);
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return -1;
+    if (write(fd, text, (size_t)n) != n || fsync(fd) == -1) {
+        int err = errno;
+        close(fd); unlink(tmp);
+        errno = err;
+        return -1;
+    }
+    close(fd);
+    if (rename(tmp, path) == -1) {
+        int err = errno;
+        unlink(tmp);
+        errno = err;
+        return -1;
+    }
+    sync_dir(path);
+    return 0;
+}
+
+int ckpt_maybe(SharedMemory *mem, int out_fd, const char *out_path, int force) {
+    long long every = mem->ckpt_every;
+    if (every <= 0 || mem->source_bytes < 0) return 0;
+
+    long long next = atomic_load(&mem->ckpt_next);
+    long long flushed = atomic_load(&mem->next_to_flush);
+    if (flushed < next && !(force && flushed > next - every)) return 0;
+    if (!atomic_compare_exchange_strong(&mem->ckpt_next, &next, flushed + every)) return 0;
+
+    // Todo lo anterior a flushed ya está en el archivo (fwrite + fflush,
+    // pwrite o el mapeo compartido): fsync lo deja en disco
+    if (fsync(out_fd) == -1 || ckpt_write(mem, out_path, flushed) == -1) {
+        perror("\n[WARN] punto de control");
+        return -1;
+    }
+    return 1;
+}
@@ -0,0 +1,56 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+/*
+ =============================================================================
+  Archivo: checkpoint.h
+  Propósito:
+    Puntos de control de transferencias largas y su reanudación. Sin ellos
+    un proceso caído o un Finalizador temprano deja la salida a medias y
+    volver a correr agrega todo de nuevo desde el seq 0.
+
+  Resumen funcional:
+    - Los Receptores escriben un archivo lateral "<salida>.ckpt" cada
+      ckpt_every bytes de next_to_flush (y uno final al salir): la marca
+      persistida, el largo que la salida tiene hasta ella y la huella de
+      la fuente. Antes se hace fsync de la salida, así que la marca es
+      durable; el archivo se reemplaza con rename, nunca queda a medias.
+      Un solo Receptor gana cada punto (CAS sobre ckpt_next).
+    - El Inicializador con -R <salida> lee el punto, verifica que la fuente
+      sea la misma, trunca la salida a su largo durable y arranca next_pos,
+      next_claim y next_to_flush en la marca: solo se rehace lo posterior.
+
+  Huella de la fuente:
+    FNV-1a de 64 bits sobre el tamaño, los primeros y últimos 64 KiB y 14
+    bloques de 4 KiB repartidos a lo largo del archivo. Cuesta lo mismo
+    para 1 MB que para 50 GB; detecta otro archivo o uno reescrito, no
+    un cambio aislado fuera de las muestras.
+ =============================================================================
+*/
+#include "shared.h"
+
+// Punto de control leído de un archivo lateral
+typedef struct {
+    long long flushed;           // seq persistido en orden (next_to_flush)
+    long long length;            // bytes de la salida hasta flushed
+    long long source_bytes;      // tamaño de la fuente
+    unsigned long long source_fp;// huella de la fuente
+} Checkpoint;
+
+// "<salida>.ckpt" en buf; -1 si no entra
+int ckpt_path(char *buf, size_t cap, const char *out_path);
+
+// Huella de la fuente en *fp; -1 con errno si no se puede leer
+int ckpt_fingerprint(const char *path, unsigned long long *fp);
+
+// Lee el punto de control de la salida; -1 con un mensaje en stderr si no
+// existe o no es válido
+int ckpt_load(const char *out_path, Checkpoint *ck);
+
+// Escribe un punto si next_to_flush alcanzó ckpt_next (o, con force, si
+// avanzó desde el último) y este proceso gana el turno. out_fd es el
+// descriptor de la salida, para hacerla durable antes. 1 si escribió,
+// 0 si no tocaba, -1 si falló (con aviso en stderr; la transferencia
+// sigue).
+int ckpt_maybe(SharedMemory *mem, int out_fd, const char *out_path, int force);
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ ============================================================================
+ Archivo: codec.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Códecs XOR por bloques con despacho por CPU (ver codec.h).
+
+    Todos los núcleos recorren la clave expandida con una "fase"
+    (offset % key_len): tras procesar V bytes la fase avanza V % key_len.
+    Si key_len divide a V (xor, o claves de 2/4/8/16/32 bytes) la fase no
+    cambia y el vector de clave se carga una sola vez fuera del lazo.
+ ============================================================================
+*/
+#include <string.h>
+#include <stdint.h>
+#include "codec.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CODEC_X86 1
+#endif
+
+static const char *const NAMES[] = { "xor", "roll" };
+static const char *const IMPL_NAMES[] = { "scalar", "sse2", "avx2" };
+
+int codec_lookup(const char *name) {
+    for (int i = 0; i < (int)(sizeof(NAMES) / sizeof(NAMES[0])); i++)
+        if (strcmp(name, NAMES[i]) == 0) return i;
+    return -1;
+}
+
+const char *codec_name(int id) {
+    return (id >= 0 && id < (int)(sizeof(NAMES) / sizeof(NAMES[0]))) ? NAMES[id] : "?";
+}
+
+const char *codec_impl_name(int impl) {
+    return (impl >= 0 && impl < CODEC_IMPL_COUNT) ? IMPL_NAMES[impl] : "?";
+}
+
+int codec_impl_supported(int impl) {
+    switch (impl) {
+    case CODEC_IMPL_SCALAR: return 1;
+#ifdef CODEC_X86
+    case CODEC_IMPL_SSE2:   return __builtin_cpu_supports("sse2");
+    case CODEC_IMPL_AVX2:   return __builtin_cpu_supports("avx2");
+#endif
+    default:                return 0;
+    }
+}
+
+/* --------------------------------------------------------------------------
+   Núcleos
+   -------------------------------------------------------------------------- */
+static void xor_scalar(unsigned char *dst, const unsigned char *src, size_t n,
+                       const unsigned char *ks, int len, int phase) {
+    int step = 8 % len;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t k, x;
+        memcpy(&k, ks + phase, 8);
+        memcpy(&x, src + i, 8);
+        x ^= k;
+        memcpy(dst + i, &x, 8);
+        phase += step;
+        if (phase >= len) phase -= len;
+    }
+    for (; i < n; i++) {
+        dst[i] = src[i] ^ ks[phase];
+        if (++phase == len) phase = 0;
+    }
+}
+
+#ifdef CODEC_X86
+__attribute__((target("sse2")))
+static void xor_sse2(unsigned char *dst, const unsigned char *src, size_t n,
+                     const unsigned char *ks, int len, int phase) {
+    int step = 16 % len;
+    size_t i = 0;
+    if (step == 0) {
+        __m128i k = _mm_loadu_si128((const __m128i *)(ks + phase));
+        for (; i + 64 <= n; i += 64) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+            __m128i b = _mm_loadu_si128((const __m128i *)(src + i + 16));
+            __m128i c = _mm_loadu_si128((const __m128i *)(src + i + 32));
+            __m128i d = _mm_loadu_si128((const __m128i *)(src + i + 48));
+            _mm_storeu_si128((__m128i *)(dst + i),      _mm_xor_si128(a, k));
+            _mm_storeu_si128((__m128i *)(dst + i + 16), _mm_xor_si128(b, k));
+            _mm_storeu_si128((__m128i *)(dst + i + 32), _mm_xor_si128(c, k));
+            _mm_storeu_si128((__m128i *)(dst + i + 48), _mm_xor_si128(d, k));
+        }
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m128i k = _mm_loadu_si128((const __m128i *)(ks + phase));
+        __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(x, k));
+        phase += step;
+        if (phase >= len) phase -= len;
+    }
+    xor_scalar(dst + i, src + i, n - i, ks, len, phase);
+}
+
+__attribute__((target("avx2")))
+static void xor_avx2(unsigned char *dst, const unsigned char *src, size_t n,
+                     const unsigned char *ks, int len, int phase) {
+    int step = 32 % len;
+    size_t i = 0;
+    if (step == 0) {
+        __m256i k = _mm256_loadu_si256((const __m256i *)(ks + phase));
+        for (; i + 128 <= n; i += 128) {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(src + i));
+            __m256i b = _mm256_loadu_si256((const __m256i *)(src + i + 32));
+            __m256i c = _mm256_loadu_si256((const __m256i *)(src + i + 64));
+            __m256i d = _mm256_loadu_si256((const __m256i *)(src + i + 96));
+            _mm256_storeu_si256((__m256i *)(dst + i),      _mm256_xor_si256(a, k));
+            _mm256_storeu_si256((__m256i *)(dst + i + 32), _mm256_xor_si256(b, k));
+            _mm256_storeu_si256((__m256i *)(dst + i + 64), _mm256_xor_si256(c, k));
+            _mm256_storeu_si256((__m256i *)(dst + i + 96), _mm256_xor_si256(d, k));
+        }
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256i k = _mm256_loadu_si256((const __m256i *)(ks + phase));
+        __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(x, k));
+        phase += step;
+        if (phase >= len) phase -= len;
+    }
+    xor_scalar(dst + i, src + i, n - i, ks, len, phase);
+}
+#endif
+
+/* --------------------------------------------------------------------------
+   Interfaz pública
+   -------------------------------------------------------------------------- */
+int codec_init(Codec *c, int id, int key, int key_len, int impl) {
+    if (impl == CODEC_IMPL_AUTO) {
+        impl = CODEC_IMPL_SCALAR;
+        for (int i = CODEC_IMPL_COUNT - 1; i > CODEC_IMPL_SCALAR; i--)
+            if (codec_impl_supported(i)) { impl = i; break; }
+    }
+    if (!codec_impl_supported(impl)) return -1;
+
+    c->id = id;
+    c->impl = impl;
+    c->key_len = (id == CODEC_ROLL) ? key_len : 1;
+    if (c->key_len < 1) c->key_len = 1;
+    if (c->key_len > CODEC_KEY_MAX) c->key_len = CODEC_KEY_MAX;
+
+    // "xor": la clave de 8 bits tal cual. "roll": generador lineal
+    // congruente sembrado con la clave (mismos bytes en todo proceso).
+    unsigned char k[CODEC_KEY_MAX];
+    if (id == CODEC_ROLL) {
+        uint32_t state = (uint32_t)key;
+        for (int i = 0; i < c->key_len; i++) {
+            state = state * 1103515245u + 12345u;
+            k[i] = (unsigned char)(state >> 16);
+        }
+    } else {
+        k[0] = (unsigned char)key;
+    }
+    for (int j = 0; j < c->key_len + CODEC_VEC; j++) c->ks[j] = k[j % c->key_len];
+    return 0;
+}
+
+void codec_apply(const Codec *c, char *dst, const char *src, size_t n, long long offset) {
+    int phase = (int)(offset % c->key_len);
+    unsigned char *d = (unsigned char *)dst;
+    const unsigned char *s = (const unsigned char *)src;
+    switch (c->impl) {
+#ifdef CODEC_X86
+    case CODEC_IMPL_AVX2: xor_avx2(d, s, n, c->ks, c->key_len, phase); break;
+    case CODEC_IMPL_SSE2: xor_sse2(d, s, n, c->ks, c->key_len, phase); break;
+#endif
+    default:              xor_scalar(d, s, n, c->ks, c->key_len, phase); break;
+    }
+}
+
+unsigned char codec_key_at(const Codec *c, long long offset) {
+    return c->ks[offset % c->key_len];
+}
@@ -0,0 +1,66 @@
+#ifndef CODEC_H
+#define CODEC_H
+/*
+ =============================================================================
+  Archivo: codec.h
+  Propósito:
+    Capa de codificación del camino de datos. Reemplaza el "c ^ xor_key"
+    byte a byte de Emisor/Receptor por núcleos por bloques.
+
+  Códecs (se eligen por nombre en el Inicializador y quedan en el segmento):
+    - "xor" : XOR con la clave de 8 bits de siempre.
+    - "roll": XOR con una clave rodante de key_len bytes derivada de la
+      clave entera; el byte de la fuente en el desplazamiento p usa
+      k[p % key_len], así que cualquier tramo se (de)codifica sabiendo
+      solo su seq.
+    XOR es simétrico: la misma llamada codifica y decodifica.
+
+  Implementaciones (despacho en tiempo de ejecución):
+    - CODEC_IMPL_AVX2 / CODEC_IMPL_SSE2: 32/16 bytes por instrucción.
+    - CODEC_IMPL_SCALAR: palabra de 64 bits a la vez; respaldo portátil.
+    codec_init() con impl = CODEC_IMPL_AUTO toma la mejor que soporte la
+    CPU del proceso.
+ =============================================================================
+*/
+#include <stddef.h>
+
+#define CODEC_XOR   0
+#define CODEC_ROLL  1
+
+#define CODEC_IMPL_AUTO   (-1)
+#define CODEC_IMPL_SCALAR 0
+#define CODEC_IMPL_SSE2   1
+#define CODEC_IMPL_AVX2   2
+#define CODEC_IMPL_COUNT  3
+
+#define CODEC_KEY_MAX  64   // longitud máxima de la clave rodante
+#define CODEC_VEC      32   // bytes del vector más ancho
+
+typedef struct {
+    int id;                 // CODEC_XOR | CODEC_ROLL
+    int impl;               // implementación resuelta
+    int key_len;            // 1 para "xor"
+    // Clave expandida: ks[j] = k[j % key_len] para j < key_len + CODEC_VEC,
+    // de modo que una carga sin alinear desde ks + fase cubre un vector.
+    unsigned char ks[CODEC_KEY_MAX + CODEC_VEC];
+} Codec;
+
+// Id del códec con ese nombre, o -1 si no existe
+int codec_lookup(const char *name);
+const char *codec_name(int id);
+
+// 1 si la CPU actual soporta la implementación
+int codec_impl_supported(int impl);
+const char *codec_impl_name(int impl);
+
+// Prepara el códec con la clave entera del proyecto. key_len solo se usa en
+// "roll" (1..CODEC_KEY_MAX). Devuelve -1 si impl no está soportada.
+int codec_init(Codec *c, int id, int key, int key_len, int impl);
+
+// dst[i] = src[i] ^ k[(offset + i) % key_len]; dst puede ser src
+void codec_apply(const Codec *c, char *dst, const char *src, size_t n, long long offset);
+
+// Byte de clave que corresponde al desplazamiento offset
+unsigned char codec_key_at(const Codec *c, long long offset);
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ ============================================================================
+ Archivo: encolador.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Este proceso (Encolador) agrega trabajos (fuente, destino) a la cola de
+    flujos de un segmento creado con -J (ver stream.h). Los Emisores y
+    Receptores que ya corren los toman sin reiniciar nada: así un solo
+    segmento de larga vida transporta miles de archivos chicos y unos
+    pocos enormes.
+
+    Cada destino se crea (o se trunca) al tamaño de su fuente al encolarlo.
+    Si la tabla está llena, espera a que se persista el trabajo más viejo
+    (con -n falla en su lugar).
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <string.h>
+#include <errno.h>
+#include "shared.h"
+#include "segment.h"
+#include "stream.h"
+
+/* --------------------------------------------------------------------------
+   PROCESO PRINCIPAL DEL ENCOLADOR
+   Uso:
+       ./encolador [-n] <id_memoria> [<fuente> <destino>]...
+       - id_memoria : identificador usado por ftok() (entero)
+       - fuente/destino : pares a encolar; sin pares se leen de la entrada
+                      estándar, "<fuente> <destino>" por línea ('#' comenta)
+       - -n         : no esperar lugar en la tabla; falla si está llena
+   -------------------------------------------------------------------------- */
+int main(int argc, char *argv[]) {
+    int wait = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "n")) != -1) {
+        switch (opt) {
+        case 'n': wait = 0; break;
+        default: exit(EXIT_FAILURE);
+        }
+    }
+    int pairs = argc - optind - 1;
+    if (pairs < 0 || pairs % 2 != 0) {
+        fprintf(stderr, "Uso: %s [-n] <id_memoria> [<fuente> <destino>]...\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    key_t shm_key = ftok(".", atoi(argv[optind]));
+    if (shm_key == (key_t)-1) { perror("ftok"); exit(EXIT_FAILURE); }
+    int shm_id = shmget(shm_key, 0, 0666);
+    if (shm_id == -1) { perror("shmget"); exit(EXIT_FAILURE); }
+    SharedMemory *mem = (SharedMemory *)shmat(shm_id, NULL, 0);
+    if (mem == (void *)-1) { perror("shmat"); exit(EXIT_FAILURE); }
+    if (segment_check(mem) == -1) { shmdt(mem); exit(EXIT_FAILURE); }
+    if (mem->jobs_max == 0) {
+        fprintf(stderr, "El segmento no tiene cola de flujos (use -J en el Inicializador)\n");
+        shmdt(mem); exit(EXIT_FAILURE);
+    }
+
+    long long before = atomic_load(&mem->jobs_added);
+    long long queued = 0;
+    if (pairs == 0) {
+        queued = stream_enqueue_list(mem, stdin, "stdin", wait);
+    } else {
+        for (int i = optind + 1; i < argc; i += 2, queued++)
+            if (stream_enqueue(mem, argv[i], argv[i + 1], wait) == -1) { queued = -1; break; }
+    }
+    if (queued == -1) { shmdt(mem); exit(EXIT_FAILURE); }
+
+    printf("Encolados %lld trabajos (ids desde %lld); en cola %lld de %lld, %lld bytes en total\n",
+           queued, before, atomic_load(&mem->jobs_added) - stream_done(mem),
+           (long long)atomic_load(&mem->jobs_added), (long long)atomic_load(&mem->jobs_end));
+    shmdt(mem);
+    return 0;
+}
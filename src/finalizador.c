@@ -10,10 +10,18 @@
     de forma ordenada y sin uso de 'kill', tal como exige el enunciado.
     El cierre se activa por un evento "físico" (aquí: ENTER en consola),
     y luego:
-      1) Espera a que el buffer compartido quede vacío (sin busy waiting).
+      1) Drena: activa sync.draining para que los Emisores no reclamen
+         tramos nuevos y duerme en SYNC_EV_DRAIN (sin busy waiting) hasta
+         que no queden emisores y next_to_flush alcance next_claim, es
+         decir, hasta que todo lo reclamado esté persistido. La espera
+         tiene un plazo (-t); si vence, se informa lo que quedó sin
+         persistir y se cierra igual. Mientras espera revisa si algún
+         proceso murió con algo en la mano (recover.h): suelta lo que
+         tenía tomado y deja el resto a los Receptores.
       2) Toma un "snapshot" de estadísticas en memoria compartida.
       3) Imprime un resumen elegante y conciso.
-      4) Libera los recursos IPC (memoria compartida y semáforos).
+      4) Activa sync.shutdown (despierta a todo proceso bloqueado) y
+         libera los recursos IPC (memoria compartida y semáforos).
 
     Relación con el enunciado:
       - Accionamiento por señal externa y finalización normal. 
@@ -33,35 +41,84 @@
 #include <time.h>
 #include <errno.h>
 #include "shared.h"
+#include "ring.h"
+#include "proc.h"
+#include "segment.h"
+#include "recover.h"
+#include "stream.h"
+
+#define DRAIN_TIMEOUT_S 30.0 // plazo de drenaje por defecto (-t)
 
 /* --------------------------------------------------------------------------
-   Utilidad: obtener el valor actual de un semáforo con semctl(GETVAL)
+   Drenaje
+   Terminado cuando no quedan emisores (ningún tramo más por reclamar) y
+   todo seq por debajo de next_claim (reservado en el anillo, en orden)
+   ya se persistió. Con el anillo vacío de datos ordenados, ambas cosas
+   las avisa SYNC_EV_DRAIN: la salida de un proceso y cada avance de
+   next_to_flush mientras draining está activo. Un proceso muerto no avisa
+   nada: se duerme de a SYNC_STALL_NS y se revisa la tabla entre medio.
    -------------------------------------------------------------------------- */
-static int sem_getval(int sem_id, int sem_num) {
-    return semctl(sem_id, sem_num, GETVAL);
+static int drain_done(SharedMemory *mem) {
+    return proc_active(mem, ROLE_EMITTER) == 0 && proc_pending(mem) == 0 &&
+           atomic_load(&mem->next_to_flush) >= atomic_load(&mem->next_claim);
+}
+
+// 1 si drenó, 0 si venció el plazo, -1 si otro Finalizador ya cerró
+static int drain_wait(SharedMemory *mem, int sem_id, double timeout_s) {
+    long long deadline = lat_now() + (long long)(timeout_s * 1e9);
+    Recovery rcv = { .mem = mem, .sem_id = sem_id };
+    sync_drain(&mem->sync);
+    while (recover_run(&rcv), !drain_done(mem)) {
+        long long left = deadline - lat_now();
+        if (left <= 0) return 0;
+        if (left > SYNC_STALL_NS) left = SYNC_STALL_NS;
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_DRAIN);
+        if (drain_done(mem)) { sync_cancel(&mem->sync, SYNC_EV_DRAIN); break; }
+        if (sync_sleep_for(&mem->sync, SYNC_EV_DRAIN, snap, left) == -1) return -1;
+    }
+    return 1;
 }
 
 /* --------------------------------------------------------------------------
-   Utilidad: pequeña espera
+   Utilidad: una línea de percentiles de latencia (en µs)
    -------------------------------------------------------------------------- */
-static void tiny_sleep_ns(long ns) {
-    struct timespec d = {0, ns};
-    nanosleep(&d, NULL);
+static void print_latency(const char *label, const LatHist *h) {
+    if (atomic_load(&h->count) == 0) {
+        printf("%s\033[0msin muestras\n", label);
+        return;
+    }
+    printf("%s\033[0mp50 %.1f | p99 %.1f | p99.9 %.1f | max %.1f µs\n", label,
+           lat_percentile(h, 50.0) / 1e3, lat_percentile(h, 99.0) / 1e3,
+           lat_percentile(h, 99.9) / 1e3, atomic_load(&h->max) / 1e3);
 }
 
 /* --------------------------------------------------------------------------
    PROCESO PRINCIPAL DEL FINALIZADOR
    Uso:
-       ./finalizador <id_memoria>
+       ./finalizador [-t segundos] <id_memoria>
    Donde:
        - id_memoria: entero base para ftok() que identifica el conjunto IPC.
+       - -t segundos: plazo máximo del drenaje (por defecto 30)
    -------------------------------------------------------------------------- */
 int main(int argc, char *argv[]) {
     // Validación de parámetros
-    if (argc != 2) {
-        fprintf(stderr, "Uso: %s <id_memoria>\n", argv[0]);
+    double timeout_s = DRAIN_TIMEOUT_S;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:")) != -1) {
+        switch (opt) {
+        case 't':
+            timeout_s = atof(optarg);
+            if (timeout_s < 0) { fprintf(stderr, "Plazo inválido: %s\n", optarg); return 1; }
+            break;
+        default:
+            return 1;
+        }
+    }
+    if (argc - optind != 1) {
+        fprintf(stderr, "Uso: %s [-t segundos] <id_memoria>\n", argv[0]);
         return 1;
     }
+    argv += optind - 1; // argv[1] queda como id_memoria
 
     // Derivar clave IPC a partir del id solicitado
     key_t shm_key = ftok(".", atoi(argv[1]));
@@ -73,6 +130,7 @@ int main(int argc, char *argv[]) {
 
     SharedMemory *mem = (SharedMemory*)shmat(shm_id, NULL, 0);
     if (mem == (void*)-1) { perror("shmat"); return 1; }
+    if (segment_check(mem) == -1) { shmdt(mem); return 1; }
 
     int sem_id = semget(shm_key, 3, 0666);
     if (sem_id == -1) { perror("semget"); shmdt(mem); return 1; }
@@ -86,34 +144,45 @@ int main(int argc, char *argv[]) {
     getchar(); // Simula el “botón físico” de cierre
 
     /* ==============================================================
-       2) Esperar a que el buffer esté vacío antes de cerrar
+       2) Drenar antes de cerrar
        --------------------------------------------------------------
-       Se consulta el semáforo 'full' (idx=2). Si es >0, aún hay datos
-       por consumir. Se duerme brevemente.
+       Los emisores terminan su tramo y salen; los receptores vacían
+       el anillo y la ventana. Igual en todos los modos: el estado
+       vive en el segmento y los avisos son eventos futex.
        ============================================================== */
-    for (;;) {
-        int full_val = sem_getval(sem_id, 2); // 'full' (espacios ocupados)
-        if (full_val <= 0) break;             // buffer vacío
-        tiny_sleep_ns(100000000L);            // 0.1 s
-    }
+    printf("\033[1;34mDrenando...\033[0m (plazo %.0f s)\n", timeout_s);
+    fflush(stdout);
+    int drained = drain_wait(mem, sem_id, timeout_s);
+    if (drained == -1) { fprintf(stderr, "Los IPC ya fueron retirados\n"); shmdt(mem); return 1; }
+
+    // Lo reclamado (next_pos, acotado a la fuente) que no llegó al archivo
+    long long claimed = atomic_load(&mem->next_pos);
+    if (mem->source_bytes >= 0 && claimed > mem->source_bytes) claimed = mem->source_bytes;
+    long long flushed = atomic_load(&mem->next_to_flush);
+    long long unflushed = (claimed > flushed) ? claimed - flushed : 0;
+    if (!drained)
+        fprintf(stderr, "\n[WARN] Drenaje incompleto tras %.0f s: %lld bytes sin persistir "
+                        "(persistido hasta %lld de %lld; emisores vivos %d; caídos sin recuperar %d)\n",
+                timeout_s, unflushed, flushed, claimed, proc_active(mem, ROLE_EMITTER), proc_pending(mem));
 
     /* ==============================================================
        3) Tomar snapshot de estadísticas ANTES de desmontar IPC
        --------------------------------------------------------------
        El enunciado solicita reportar estos indicadores al final.     [Secc. 4.4]
        ============================================================== */
-    int size            = mem->size;
-    int count           = mem->count;
-    long long written   = mem->total_written;
-    long long consumed  = mem->total_consumed;
-    int e_act           = mem->emitters_active;
-    int r_act           = mem->receivers_active;
-    int e_tot           = mem->emitters_total;
-    int r_tot           = mem->receivers_total;
+    long long written   = proc_total_chars(mem, ROLE_EMITTER);
+    long long consumed  = proc_total_chars(mem, ROLE_RECEIVER);
+    long long count     = (written > consumed) ? written - consumed : 0; // caracteres, no ranuras
+    int e_act           = proc_active(mem, ROLE_EMITTER);
+    int r_act           = proc_active(mem, ROLE_RECEIVER);
+    int e_tot           = mem->registered[ROLE_EMITTER];
+    int r_tot           = mem->registered[ROLE_RECEIVER];
 
     // Cálculo solicitado
     long long transferidos = (written < consumed) ? written : consumed;
-    size_t bytes_mem = sizeof(SharedMemory) + (size_t)size * sizeof(SharedChar);
+    size_t bytes_mem = mem->segment_bytes;
+    long long steals = 0;
+    for (int k = 0; k < mem->shards; k++) steals += atomic_load(&mem->shard[k].steals);
 
     /* ==============================================================
        4) Imprimir resumen final de manera elegante (colores/alineado)
@@ -121,21 +190,38 @@ int main(int argc, char *argv[]) {
        ============================================================== */
     printf("\n\033[1;32m========== RESUMEN FINAL ==========\033[0m\n");
     printf("\033[1;33m- Cantidad de caracteres transferidos:   \033[0m%lld\n", transferidos);
-    printf("\033[1;34m- Cantidad de caracteres en memoria:     \033[0m%d\n", count);
+    printf("\033[1;34m- Cantidad de caracteres en memoria:     \033[0m%lld\n", count);
+    printf("\033[1;31m- Bytes sin persistir:                   \033[0m%lld\n", unflushed);
     printf("\033[1;35m- Emisores vivos / totales:              \033[0m%d / %d\n", e_act, e_tot);
     printf("\033[1;36m- Receptores vivos / totales:            \033[0m%d / %d\n", r_act, r_tot);
     printf("\033[1;37m- Memoria compartida utilizada:          \033[0m%zu bytes\n", bytes_mem);
+    if (mem->jobs_max > 0)
+        printf("\033[1;36m- Trabajos persistidos / encolados:      \033[0m%lld / %lld\n",
+               stream_done(mem), (long long)atomic_load(&mem->jobs_added));
+    if (mem->ingest_bytes > 0) {
+        long long ingested = atomic_load(&mem->ingest_end);
+        long long pos = atomic_load(&mem->next_pos);
+        printf("\033[1;36m- Bytes ingeridos / sin enviar:          \033[0m%lld / %lld%s\n", ingested,
+               (ingested > pos) ? ingested - pos : 0, atomic_load(&mem->ingest_eof) ? "" : " (flujo abierto)");
+    }
+    if (mem->shards > 1)
+        printf("\033[1;35m- Fragmentos / ranuras robadas:          \033[0m%d / %lld\n", mem->shards, steals);
+    print_latency("\033[1;33m- Latencia encolado → extracción:        ", &mem->lat[LAT_DEQUEUE]);
+    print_latency("\033[1;34m- Latencia encolado → disco:             ", &mem->lat[LAT_DISK]);
     printf("\033[1;32m===================================\033[0m\n");
 
     /* ==============================================================
        5) Liberación ordenada de recursos IPC
        --------------------------------------------------------------
+       - Activar la palabra de cierre y despertar a quien duerma en
+         una palabra futex (sync_shutdown)
        - Desacoplar memoria del proceso (shmdt)
        - Marcar la memoria compartida para destrucción (IPC_RMID)
        - Remover el conjunto de semáforos (IPC_RMID)
        Los emisores/receptores están programados para detectar EIDRM/
        EINVAL y cerrarse en forma “normal” (sin kill).                
        ============================================================== */
+    sync_shutdown(&mem->sync);
     shmdt(mem);
     shmctl(shm_id, IPC_RMID, NULL);
     semctl(sem_id, 0, IPC_RMID);
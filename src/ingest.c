@@ -0,0 +1,148 @@
+/*
+ ============================================================================
+ Archivo: ingest.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Área de ingesta de la fuente en flujo (ver ingest.h).
+
+    Solo el ingestor escribe el área e ingest_end. Antes de escribir lee
+    next_to_flush: el lugar libre es ingest_bytes - (ingest_end -
+    next_to_flush), así que solo pisa seqs ya persistidos. Quien lee copia
+    y después comprueba que su primer seq siga sin persistir: si lo está,
+    la copia pudo mezclarse con bytes nuevos y se descarta.
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <signal.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include "ingest.h"
+
+static char *area(SharedMemory *mem) {
+    return (char *)mem + mem->ingest_offset;
+}
+
+long long ingest_capacity(long long want) {
+    if (want < INGEST_MIN) return -1;
+    long long p = INGEST_MIN;
+    while (p <= want / 2) p <<= 1;
+    return p;
+}
+
+size_t ingest_region(long long capacity) {
+    return ((size_t)capacity + 63) & ~(size_t)63;
+}
+
+void ingest_init(SharedMemory *mem, size_t offset, long long capacity) {
+    mem->ingest_offset = offset;
+    mem->ingest_bytes = capacity;
+    atomic_store(&mem->ingest_end, 0);
+    atomic_store(&mem->ingest_eof, 0);
+    atomic_store(&mem->ingest_lock, 0);
+}
+
+/* --------------------------------------------------------------------------
+   Ingestor
+   -------------------------------------------------------------------------- */
+int ingest_attach(SharedMemory *mem, int *owner) {
+    int self = (int)getpid();
+    for (;;) {
+        int cur = 0;
+        if (atomic_compare_exchange_strong(&mem->ingest_lock, &cur, self)) return 0;
+        if (kill(cur, 0) == -1 && errno == ESRCH) {
+            if (atomic_compare_exchange_strong(&mem->ingest_lock, &cur, self)) return 0;
+            continue;
+        }
+        *owner = cur;
+        errno = EBUSY;
+        return -1;
+    }
+}
+
+static long long room(SharedMemory *mem) {
+    return mem->ingest_bytes - (atomic_load(&mem->ingest_end) - atomic_load(&mem->next_to_flush));
+}
+
+ssize_t ingest_space(SharedMemory *mem, char **dst) {
+    long long avail = room(mem);
+    if (avail == 0) {
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_WINDOW);
+        avail = room(mem);
+        if (avail > 0) sync_cancel(&mem->sync, SYNC_EV_WINDOW);
+        else if (sync_sleep_for(&mem->sync, SYNC_EV_WINDOW, snap, SYNC_STALL_NS) == -1) return -1;
+        else return 0;
+    }
+    long long off = atomic_load(&mem->ingest_end) & (mem->ingest_bytes - 1);
+    long long run = mem->ingest_bytes - off; // hasta la vuelta del anillo
+    *dst = area(mem) + off;
+    return (ssize_t)((avail < run) ? avail : run);
+}
+
+void ingest_publish(SharedMemory *mem, size_t n) {
+    atomic_fetch_add(&mem->ingest_end, (long long)n); // libera los bytes escritos
+    sync_notify(&mem->sync, SYNC_EV_JOBS, INT_MAX);
+}
+
+void ingest_finish(SharedMemory *mem) {
+    atomic_store(&mem->ingest_eof, 1);
+    sync_notify(&mem->sync, SYNC_EV_JOBS, INT_MAX);
+    int self = (int)getpid();
+    atomic_compare_exchange_strong(&mem->ingest_lock, &self, 0);
+}
+
+/* --------------------------------------------------------------------------
+   Emisores
+   -------------------------------------------------------------------------- */
+long long ingest_claim(SharedMemory *mem, int chunk, long long *pos) {
+    long long p = atomic_load(&mem->next_pos);
+    for (;;) {
+        long long end = atomic_load(&mem->ingest_end);
+        if (p >= end) return 0;
+        long long n = (end - p < chunk) ? end - p : chunk;
+        if (atomic_compare_exchange_weak(&mem->next_pos, &p, p + n)) {
+            *pos = p;
+            return n;
+        }
+    }
+}
+
+int ingest_ended(SharedMemory *mem) {
+    // ingest_eof se activa tras publicar lo último: leído antes, el
+    // ingest_end que sigue ya es el final
+    return atomic_load(&mem->ingest_eof) &&
+           atomic_load(&mem->next_pos) >= atomic_load(&mem->ingest_end);
+}
+
+static int nothing_ingested(SharedMemory *mem) {
+    return !sync_is_draining(&mem->sync) && !atomic_load(&mem->ingest_eof) &&
+           atomic_load(&mem->next_pos) >= atomic_load(&mem->ingest_end);
+}
+
+int ingest_wait(SharedMemory *mem) {
+    while (nothing_ingested(mem)) {
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_JOBS);
+        if (!nothing_ingested(mem)) { sync_cancel(&mem->sync, SYNC_EV_JOBS); break; }
+        if (sync_sleep(&mem->sync, SYNC_EV_JOBS, snap) == -1) return -1;
+    }
+    return 0;
+}
+
+ssize_t ingest_read(SharedMemory *mem, long long seq, char *buf, size_t n) {
+    long long end = atomic_load(&mem->ingest_end);
+    if (seq >= end) return 0;
+    if (seq < atomic_load(&mem->next_to_flush)) { errno = ESTALE; return -1; }
+    if ((long long)n > end - seq) n = (size_t)(end - seq); // <= ingest_bytes
+
+    long long off = seq & (mem->ingest_bytes - 1);
+    size_t first = (size_t)(mem->ingest_bytes - off);
+    if (first > n) first = n;
+    memcpy(buf, area(mem) + off, first);
+    memcpy(buf + first, area(mem), n - first);
+
+    atomic_thread_fence(memory_order_acquire); // ¿se pisó durante la copia?
+    if (seq < atomic_load(&mem->next_to_flush)) { errno = ESTALE; return -1; }
+    return (ssize_t)n;
+}
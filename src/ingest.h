@@ -0,0 +1,91 @@
+#ifndef INGEST_H
+#define INGEST_H
+/*
+ =============================================================================
+  Archivo: ingest.h
+  Propósito:
+    Fuente en flujo: los Emisores leen la fuente con pread en cualquier
+    posición, así que tiene que ser un archivo regular completo. Con la
+    ingesta (-I en el Inicializador) un único proceso, el ingestor, lee
+    la entrada estándar, una FIFO o un archivo que crece (tail -f) y la
+    deja en el segmento; la salida de un productor en vivo pasa por el
+    sistema sin guardarse antes en disco.
+
+  Resumen funcional:
+    - Área de ingesta (tras la ventana y la tabla de trabajos): anillo de
+      ingest_bytes bytes en claro (potencia de dos) donde el byte de seq s
+      vive en s & (ingest_bytes - 1).
+    - El ingestor lee directo al área y publica cada lectura avanzando
+      ingest_end (y avisa SYNC_EV_JOBS); al terminar la entrada activa
+      ingest_eof.
+    - Los Emisores reclaman tramos de next_pos hasta ingest_end (con menos
+      de un tramo disponible reclaman lo que haya: un flujo lento no
+      espera a juntar un tramo entero), los copian del área y los
+      codifican como cualquier tramo. Sin nada que reclamar duermen en
+      SYNC_EV_JOBS; con ingest_eof y todo reclamado salen.
+    - Un byte se sobrescribe recién cuando next_to_flush lo pasó: lo que
+      un Emisor o un Receptor muerto dejó en arriendo sigue en el área y
+      recover.c lo entrega desde ahí. Con el área llena el ingestor
+      espera a que avance next_to_flush (SYNC_EV_WINDOW).
+    - Un solo ingestor a la vez (ingest_lock guarda su pid); si muere, el
+      siguiente lo hereda y sigue el flujo desde ingest_end.
+
+  Restricciones:
+    - Sin tamaño de fuente: salida append, sin -f mmap, -l lines (una
+      línea puede no haber llegado aún), -J, -R ni puntos de control.
+ =============================================================================
+*/
+#include <sys/types.h>
+#include "shared.h"
+
+#define INGEST_MIN 4096   // área mínima (bytes)
+
+// Área efectiva para want bytes pedidos: la mayor potencia de dos que
+// entra, o -1 si es menor que INGEST_MIN
+long long ingest_capacity(long long want);
+
+// Bytes de segmento de un área de capacity bytes
+size_t ingest_region(long long capacity);
+
+// Ubica el área en el desplazamiento offset del segmento, vacía
+// (capacity 0 = sin ingesta)
+void ingest_init(SharedMemory *mem, size_t offset, long long capacity);
+
+/* ---- Ingestor ---- */
+
+// Toma el papel de ingestor (o lo hereda de uno muerto). 0, o -1 con
+// errno = EBUSY y el pid del dueño en *owner.
+int ingest_attach(SharedMemory *mem, int *owner);
+
+// Lugar en el área: devuelve en *dst dónde leer y los bytes contiguos
+// disponibles. Con el área llena espera a lo sumo SYNC_STALL_NS a que
+// avance next_to_flush y devuelve 0 (el llamador revisa si debe seguir);
+// -1 con errno = EIDRM si se retiraron los IPC.
+ssize_t ingest_space(SharedMemory *mem, char **dst);
+
+// Publica n bytes leídos en el lugar de ingest_space
+void ingest_publish(SharedMemory *mem, size_t n);
+
+// Fin del flujo: activa ingest_eof, despierta a los Emisores y suelta el
+// papel de ingestor
+void ingest_finish(SharedMemory *mem);
+
+/* ---- Emisores ---- */
+
+// Reclama hasta chunk bytes desde next_pos sin pasar ingest_end. Devuelve
+// los bytes reclamados (posición en *pos) o 0 si no hay nada ingerido.
+long long ingest_claim(SharedMemory *mem, int chunk, long long *pos);
+
+// 1 si el flujo terminó y ya se reclamó entero
+int ingest_ended(SharedMemory *mem);
+
+// Espera a que haya algo por reclamar, termine el flujo o empiece el
+// drenaje. 0, o -1 con errno = EIDRM si se retiraron los IPC.
+int ingest_wait(SharedMemory *mem);
+
+// Copia los seq [seq, seq + n) del área. Bytes copiados (menos si se
+// llega a ingest_end), o -1 con errno = ESTALE si parte ya se persistió y
+// pudo sobrescribirse.
+ssize_t ingest_read(SharedMemory *mem, long long seq, char *buf, size_t n);
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ ============================================================================
+ Archivo: ingestor.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Este proceso (Ingestor) es la etapa de entrada de un segmento creado
+    con -I (ver ingest.h): lee la fuente en flujo, que puede ser su
+    entrada estándar, una FIFO o un archivo que sigue creciendo, y la deja
+    en el área de ingesta. Los Emisores que ya corren la cortan en tramos
+    numerados por seq, la codifican y la publican como a un archivo.
+
+    Cada read() va directo al área y se publica enseguida: un productor
+    lento no espera a juntar un tramo. Con el área llena espera a que los
+    Receptores persistan (SYNC_EV_WINDOW); así la fuente nunca se adelanta
+    más que el área a la salida.
+
+    El flujo termina al fin de la entrada (la tubería o la FIFO se
+    cerraron, o el archivo se acabó sin -f), con SIGINT/SIGTERM o cuando
+    el Finalizador empieza a drenar; entonces activa ingest_eof y los
+    Emisores salen al reclamar lo último.
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include "shared.h"
+#include "segment.h"
+#include "ingest.h"
+
+#define FOLLOW_NS 100000000LL // espera de -f al final del archivo (0.1 s)
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+/* --------------------------------------------------------------------------
+   Fuente
+   --------------------------------------------------------------------------
+   open_source() abre path ("-" = entrada estándar). Con follow, al llegar
+   al final follow_source() distingue un archivo truncado (se vuelve a
+   leer desde el inicio) de uno rotado (otro archivo con el mismo nombre,
+   que se abre) y si no, espera FOLLOW_NS a que crezca.
+   -------------------------------------------------------------------------- */
+static int open_source(const char *path, int follow) {
+    int fd = (strcmp(path, "-") == 0) ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd == -1) { perror(path); return -1; }
+    struct stat st;
+    if (follow && (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode))) {
+        fprintf(stderr, "%s: -f sigue archivos regulares\n", path);
+        if (fd != STDIN_FILENO) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 0 para seguir leyendo de *fd, -1 con un mensaje en stderr
+static int follow_source(const char *path, int *fd) {
+    struct stat cur, named;
+    off_t at = lseek(*fd, 0, SEEK_CUR);
+    if (fstat(*fd, &cur) == -1 || at == (off_t)-1) { perror(path); return -1; }
+    if (cur.st_size < at) {
+        fprintf(stderr, "\n[WARN] %s se truncó; se sigue desde el inicio\n", path);
+        return (lseek(*fd, 0, SEEK_SET) == (off_t)-1) ? -1 : 0;
+    }
+    if (stat(path, &named) == 0 && (named.st_ino != cur.st_ino || named.st_dev != cur.st_dev)) {
+        int nfd = open(path, O_RDONLY);
+        if (nfd != -1) {
+            fprintf(stderr, "\n[INFO] %s rotó; se sigue el archivo nuevo\n", path);
+            close(*fd);
+            *fd = nfd;
+            return 0;
+        }
+    }
+    struct timespec t = {0, FOLLOW_NS};
+    nanosleep(&t, NULL);
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+   PROCESO PRINCIPAL DEL INGESTOR
+   Uso:
+       ./ingestor [-f] <id_memoria> [fuente]
+       - id_memoria : identificador usado por ftok() (entero)
+       - fuente     : tubería, FIFO o archivo a ingerir; por defecto la del
+                      Inicializador. "-" = entrada estándar
+       - -f         : seguir el archivo al llegar a su final, como
+                      tail -f (también si se trunca o rota); el flujo
+                      termina con SIGINT/SIGTERM o con el drenaje
+   -------------------------------------------------------------------------- */
+int main(int argc, char *argv[]) {
+    int follow = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "f")) != -1) {
+        switch (opt) {
+        case 'f': follow = 1; break;
+        default: exit(EXIT_FAILURE);
+        }
+    }
+    if (argc - optind != 1 && argc - optind != 2) {
+        fprintf(stderr, "Uso: %s [-f] <id_memoria> [fuente]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    key_t shm_key = ftok(".", atoi(argv[optind]));
+    if (shm_key == (key_t)-1) { perror("ftok"); exit(EXIT_FAILURE); }
+    int shm_id = shmget(shm_key, 0, 0666);
+    if (shm_id == -1) { perror("shmget"); exit(EXIT_FAILURE); }
+    SharedMemory *mem = (SharedMemory *)shmat(shm_id, NULL, 0);
+    if (mem == (void *)-1) { perror("shmat"); exit(EXIT_FAILURE); }
+    if (segment_check(mem) == -1) { shmdt(mem); exit(EXIT_FAILURE); }
+    if (mem->ingest_bytes == 0) {
+        fprintf(stderr, "El segmento no tiene área de ingesta (use -I en el Inicializador)\n");
+        shmdt(mem); exit(EXIT_FAILURE);
+    }
+    if (atomic_load(&mem->ingest_eof)) {
+        fprintf(stderr, "El flujo de este segmento ya terminó\n");
+        shmdt(mem); exit(EXIT_FAILURE);
+    }
+
+    // Abrir antes de tomar el papel: una FIFO bloquea hasta que llegue
+    // quien escribe
+    const char *path = (argc - optind == 2) ? argv[optind + 1] : mem->fuente_path;
+    int fd = open_source(path, follow);
+    if (fd == -1) { shmdt(mem); exit(EXIT_FAILURE); }
+    int owner;
+    if (ingest_attach(mem, &owner) == -1) {
+        fprintf(stderr, "Ya hay un ingestor en este segmento (pid %d)\n", owner);
+        if (fd != STDIN_FILENO) close(fd);
+        shmdt(mem); exit(EXIT_FAILURE);
+    }
+
+    // Sin SA_RESTART: la señal corta poll/read y el bucle ve stop
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    long long before = atomic_load(&mem->ingest_end);
+    printf("Ingestor iniciado: %s%s (área de %lld bytes, desde seq %lld)\n",
+            (fd == STDIN_FILENO) ? "entrada estándar" : path, follow ? ", siguiendo" : "",
+            mem->ingest_bytes, before);
+
+    // ============================================================
+    // BUCLE DE INGESTA
+    // ------------------------------------------------------------
+    //  1) Espera lugar en el área (o el drenaje)
+    //  2) Espera datos de la fuente, revisando el drenaje y las
+    //     señales cada SYNC_STALL_NS
+    //  3) Lee directo al área y publica lo leído
+    // ============================================================
+    int failed = 0;
+    while (!stop) {
+        if (sync_is_draining(&mem->sync)) {
+            fprintf(stderr, "\n[INFO] Cierre solicitado (drenaje). Saliendo ingestor...\n"); break;
+        }
+        char *dst;
+        ssize_t room = ingest_space(mem, &dst);
+        if (room == -1) { fprintf(stderr, "\n[INFO] IPC retirados. Saliendo ingestor...\n"); break; }
+        if (room == 0) continue;
+
+        struct pollfd p = { .fd = fd, .events = POLLIN };
+        int ready = poll(&p, 1, (int)(SYNC_STALL_NS / 1000000));
+        if (ready == 0 || (ready == -1 && errno == EINTR)) continue;
+        if (ready == -1) { perror("poll fuente"); failed = 1; break; }
+
+        ssize_t r = read(fd, dst, (size_t)room);
+        if (r > 0) { ingest_publish(mem, (size_t)r); continue; }
+        if (r == -1) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            perror("lectura fuente"); failed = 1; break;
+        }
+        if (!follow) break; // fin de la entrada
+        if (follow_source(path, &fd) == -1) { failed = 1; break; }
+    }
+    if (stop) fprintf(stderr, "\n[INFO] Señal recibida. Fin del flujo.\n");
+
+    // ============================================================
+    // FIN DEL FLUJO
+    // ------------------------------------------------------------
+    // Los Emisores reclaman lo que quede en el área y salen.
+    // ============================================================
+    long long total = atomic_load(&mem->ingest_end) - before;
+    if (!sync_is_shutdown(&mem->sync)) ingest_finish(mem);
+    if (fd != STDIN_FILENO) close(fd);
+    shmdt(mem);
+    printf("Ingeridos %lld bytes\n", total);
+    return failed ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,81 @@
+/*
+ ============================================================================
+ Archivo: latency.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Marcas monotónicas e histogramas de latencia log-bucketed (ver
+    latency.h).
+
+    Índice de cubeta de v:
+      v < 32  : v
+      v >= 32 : msb = bit más alto, shift = msb - 4,
+                idx = shift * 16 + (v >> shift)   (v >> shift en [16, 31])
+    La cubeta idx >= 32 cubre [m << s, ((m + 1) << s) - 1] con
+    s = idx / 16 - 1 y m = idx % 16 + 16.
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <time.h>
+#include "latency.h"
+
+long long lat_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int lat_index(unsigned long long v) {
+    if (v < 2 * LAT_SUB) return (int)v;
+    int shift = 63 - __builtin_clzll(v) - 4;
+    return shift * LAT_SUB + (int)(v >> shift);
+}
+
+static long long lat_upper(int idx) {
+    if (idx < 2 * LAT_SUB) return idx;
+    int shift = idx / LAT_SUB - 1;
+    unsigned long long mant = (unsigned long long)(idx % LAT_SUB + LAT_SUB);
+    return (long long)(((mant + 1) << shift) - 1);
+}
+
+void lat_init(LatHist *h) {
+    atomic_store_explicit(&h->count, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->max, 0, memory_order_relaxed);
+    for (int i = 0; i < LAT_BUCKETS; i++)
+        atomic_store_explicit(&h->buckets[i], 0, memory_order_relaxed);
+}
+
+void lat_record(LatHist *h, long long ns, long long weight) {
+    if (weight <= 0) return;
+    if (ns < 0) ns = 0; // relojes de distintas CPU nunca deberían ir atrás
+    atomic_fetch_add_explicit(&h->buckets[lat_index((unsigned long long)ns)],
+                              (unsigned long long)weight, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, (unsigned long long)weight, memory_order_relaxed);
+
+    long long cur = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (ns > cur &&
+           !atomic_compare_exchange_weak_explicit(&h->max, &cur, ns,
+                                                  memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+long long lat_percentile(const LatHist *h, double p) {
+    unsigned long long total = atomic_load_explicit(&h->count, memory_order_relaxed);
+    long long max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    if (total == 0) return 0;
+
+    // Muestra de rango ceil(p% * total), al menos la primera
+    unsigned long long rank = (unsigned long long)(p / 100.0 * (double)total);
+    if ((double)rank < p / 100.0 * (double)total) rank++;
+    if (rank == 0) rank = 1;
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < LAT_BUCKETS; i++) {
+        seen += atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        if (seen >= rank) {
+            long long up = lat_upper(i);
+            return (up < max) ? up : max;
+        }
+    }
+    return max;
+}
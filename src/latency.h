@@ -0,0 +1,53 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+/*
+ =============================================================================
+  Archivo: latency.h
+  Propósito:
+    Marcas de tiempo monotónicas (ns) e histogramas de latencia en el
+    segmento compartido.
+
+  Resumen funcional:
+    - El Emisor sella cada tramo con lat_now() al encolarlo (enq_ns).
+    - El Receptor registra enq→deq al extraerlo (LAT_DEQUEUE) y enq→disco
+      cuando el tramo queda escrito en la salida (LAT_DISK): al volcar la
+      ventana en modo append, o tras su pwrite/copia en modo posicional.
+    - Cada muestra pesa sus bytes, así que los percentiles son por carácter.
+
+  Histograma (estilo HDR, log-buckets):
+    Valores < 32 ns tienen cubeta propia; desde ahí cada potencia de dos se
+    divide en 16 sub-cubetas, con error relativo <= 1/16. Se cubre todo el
+    rango de long long con LAT_BUCKETS cubetas de 8 bytes. Las cubetas son
+    contadores atómicos relajados: varios receptores registran a la vez y
+    el Finalizador las lee sin detenerlos.
+ =============================================================================
+*/
+#include <stdatomic.h>
+
+#define LAT_SUB      16   // Sub-cubetas por potencia de dos
+#define LAT_BUCKETS  960  // (63 - 4 + 1) * LAT_SUB
+
+#define LAT_DEQUEUE  0    // Encolado → extracción por un Receptor
+#define LAT_DISK     1    // Encolado → escritura en el archivo de salida
+#define LAT_COUNT    2
+
+typedef struct {
+    _Atomic unsigned long long count;                // Bytes registrados
+    _Atomic long long max;                           // Máximo exacto (ns)
+    _Atomic unsigned long long buckets[LAT_BUCKETS];
+} LatHist;
+
+// CLOCK_MONOTONIC en nanosegundos
+long long lat_now(void);
+
+// Deja el histograma vacío (solo el Inicializador)
+void lat_init(LatHist *h);
+
+// Registra una latencia de ns nanosegundos con peso weight (bytes)
+void lat_record(LatHist *h, long long ns, long long weight);
+
+// Percentil p (0..100) en ns: cota superior de la cubeta que lo contiene
+// (el máximo exacto si p cae en la última). 0 si no hay muestras.
+long long lat_percentile(const LatHist *h, double p);
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ ============================================================================
+ Archivo: logger.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Salida de consola asíncrona (ver logger.h).
+
+    Anillo SPSC: el hilo principal escribe recs[head % LOG_RING] y publica
+    head (release); el hilo registrador lee hasta head e avanza tail. Para
+    dormir, el hilo se anota en sleeping, toma bell y vuelve a mirar head;
+    el productor publica, hace un fence y solo si ve sleeping cambia bell
+    y lo despierta (mismo protocolo que ShmEvent en sync.c, con futex
+    privados porque todo vive en el proceso).
+ ============================================================================
+*/
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include "logger.h"
+#include "latency.h"
+
+#define LOG_PERIOD_NS 1000000000LL // resumen cada segundo
+
+static void bell_wait(_Atomic unsigned int *addr, unsigned int expected, long long ns) {
+    struct timespec t = {ns / 1000000000LL, ns % 1000000000LL};
+    syscall(SYS_futex, (unsigned int *)addr, FUTEX_WAIT_PRIVATE, expected, &t, NULL, 0);
+}
+
+static void bell_ring(_Atomic unsigned int *addr) {
+    atomic_fetch_add(addr, 1);
+    syscall(SYS_futex, (unsigned int *)addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+int logger_level(const char *name) {
+    static const char *names[] = {"full", "sample", "summary", "silent"};
+    for (int i = 0; i < 4; i++)
+        if (strcmp(name, names[i]) == 0) return i;
+    return -1;
+}
+
+/* --------------------------------------------------------------------------
+   Hilo registrador
+   -------------------------------------------------------------------------- */
+static void print_summary(Logger *lg, long long *last_chars, long long *last_ns, int final) {
+    long long now = lat_now();
+    long long chars = atomic_load_explicit(&lg->chars, memory_order_relaxed);
+    double dt = (now - *last_ns) / 1e9;
+    printf("\033[1;32m[%s %d]\033[0m %lld caracteres | %.0f car/s%s",
+           lg->label, (int)getpid(), chars, dt > 0 ? (chars - *last_chars) / dt : 0.0,
+           final ? " (final)" : "");
+    long long dropped = atomic_load_explicit(&lg->dropped, memory_order_relaxed);
+    if (dropped > 0) printf(" | %lld registros descartados", dropped);
+    putchar('\n');
+    fflush(stdout);
+    *last_chars = chars;
+    *last_ns = now;
+}
+
+static void *logger_main(void *arg) {
+    Logger *lg = arg;
+    long long last_ns = lat_now(), last_chars = 0;
+
+    for (;;) {
+        // Imprimir todo lo publicado
+        unsigned long long tail = atomic_load_explicit(&lg->tail, memory_order_relaxed);
+        unsigned long long head = atomic_load_explicit(&lg->head, memory_order_acquire);
+        if (tail != head) {
+            for (; tail != head; tail++) lg->print(&lg->recs[tail % LOG_RING]);
+            fflush(stdout);
+            atomic_store_explicit(&lg->tail, tail, memory_order_release);
+            bell_ring(&lg->bell); // logger_flush espera en la misma palabra
+        }
+
+        long long now = lat_now();
+        if (lg->level == LOG_SUMMARY && now - last_ns >= LOG_PERIOD_NS)
+            print_summary(lg, &last_chars, &last_ns, 0);
+        if (atomic_load(&lg->stop) && atomic_load(&lg->head) == tail) break;
+
+        // Dormir hasta el próximo registro o el próximo resumen
+        atomic_store(&lg->sleeping, 1);
+        unsigned snap = atomic_load(&lg->bell);
+        if (atomic_load(&lg->head) == tail && !atomic_load(&lg->stop)) {
+            long long left = LOG_PERIOD_NS - (now - last_ns);
+            bell_wait(&lg->bell, snap, left > 0 ? left : 1);
+        }
+        atomic_store(&lg->sleeping, 0);
+    }
+
+    if (lg->level == LOG_SUMMARY) print_summary(lg, &last_chars, &last_ns, 1);
+    else if (atomic_load(&lg->dropped) > 0)
+        printf("\n[%s] %lld registros de consola descartados (anillo lleno)\n",
+               lg->label, atomic_load(&lg->dropped));
+    fflush(stdout);
+    return NULL;
+}
+
+/* --------------------------------------------------------------------------
+   Lado del proceso (camino de datos)
+   -------------------------------------------------------------------------- */
+int logger_start(Logger *lg, int level, long long every, LogPrint print, const char *label) {
+    lg->level = level;
+    lg->every = (every > 0) ? every : 1;
+    lg->print = print;
+    lg->label = label;
+    lg->seen = 0;
+    atomic_store(&lg->head, 0);
+    atomic_store(&lg->tail, 0);
+    atomic_store(&lg->bell, 0);
+    atomic_store(&lg->sleeping, 0);
+    atomic_store(&lg->stop, 0);
+    atomic_store(&lg->chars, 0);
+    atomic_store(&lg->dropped, 0);
+    lg->started = 0;
+    if (level == LOG_SILENT) return 0;
+
+    int err = pthread_create(&lg->thread, NULL, logger_main, lg);
+    if (err != 0) { errno = err; return -1; }
+    lg->started = 1;
+    return 0;
+}
+
+void logger_char(Logger *lg, long long index, unsigned char c, time_t ts) {
+    if (lg->level >= LOG_SUMMARY) return;
+    if (lg->level == LOG_SAMPLE && lg->seen++ % lg->every != 0) return;
+
+    unsigned long long head = atomic_load_explicit(&lg->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&lg->tail, memory_order_acquire) >= LOG_RING) {
+        atomic_fetch_add_explicit(&lg->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    lg->recs[head % LOG_RING] = (LogRec){ .index = index, .ts = ts, .c = c };
+    atomic_store_explicit(&lg->head, head + 1, memory_order_release);
+
+    atomic_thread_fence(memory_order_seq_cst); // publica head antes de leer sleeping
+    if (atomic_load_explicit(&lg->sleeping, memory_order_relaxed)) bell_ring(&lg->bell);
+}
+
+void logger_count(Logger *lg, long long n) {
+    long long cur = atomic_load_explicit(&lg->chars, memory_order_relaxed);
+    atomic_store_explicit(&lg->chars, cur + n, memory_order_relaxed);
+}
+
+void logger_flush(Logger *lg) {
+    if (!lg->started) return;
+    for (;;) {
+        unsigned snap = atomic_load(&lg->bell);
+        if (atomic_load(&lg->tail) == atomic_load(&lg->head)) return;
+        bell_wait(&lg->bell, snap, 100000000LL); // 0.1 s de respaldo
+    }
+}
+
+void logger_stop(Logger *lg) {
+    if (!lg->started) return;
+    atomic_store(&lg->stop, 1);
+    bell_ring(&lg->bell);
+    pthread_join(lg->thread, NULL);
+    lg->started = 0;
+}
@@ -0,0 +1,80 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+/*
+ =============================================================================
+  Archivo: logger.h
+  Propósito:
+    Salida de consola asíncrona de Emisor y Receptor. Reemplaza los
+    print_table por carácter dentro del camino de datos.
+
+  Resumen funcional:
+    - El proceso deja cada carácter a mostrar en un anillo local SPSC sin
+      candados (logger_char); un hilo registrador lo vacía y es el único
+      que escribe en la terminal. El camino de datos nunca espera a la tty:
+      si el anillo está lleno el registro se descarta y se cuenta.
+    - Niveles de salida (LOG_*): tabla completa, 1 de cada N caracteres,
+      solo resumen periódico (caracteres y caudal del proceso) o silencio.
+    - logger_flush() espera a que el hilo vacíe el anillo; solo lo usa el
+      modo manual antes de pedir ENTER, para no mezclar el aviso con la
+      tabla del tramo anterior.
+ =============================================================================
+*/
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define LOG_FULL     0   // tabla por carácter
+#define LOG_SAMPLE   1   // tabla de 1 de cada N caracteres
+#define LOG_SUMMARY  2   // solo resumen periódico
+#define LOG_SILENT   3   // nada
+
+#define LOG_RING     16384 // registros del anillo (potencia de dos)
+
+// Carácter a mostrar: posición en el buffer, valor y hora de inserción
+typedef struct {
+    long long index;
+    time_t ts;
+    unsigned char c;
+} LogRec;
+
+// Función que imprime un registro (la provee Emisor o Receptor)
+typedef void (*LogPrint)(const LogRec *r);
+
+typedef struct {
+    int level;                      // LOG_*
+    long long every;                // N de LOG_SAMPLE
+    LogPrint print;
+    const char *label;              // nombre del proceso en el resumen
+    long long seen;                 // caracteres ofrecidos (solo el productor)
+
+    LogRec recs[LOG_RING];
+    _Atomic unsigned long long head; // próximo a escribir (productor)
+    _Atomic unsigned long long tail; // próximo a imprimir (hilo)
+    _Atomic unsigned int bell;       // palabra futex: cambia en cada aviso
+    _Atomic int sleeping;            // el hilo duerme en bell
+    _Atomic int stop;
+    _Atomic long long chars;         // caracteres procesados (resumen)
+    _Atomic long long dropped;       // registros descartados por anillo lleno
+    pthread_t thread;
+    int started;
+} Logger;
+
+// Convierte "full", "sample", "summary" o "silent" a LOG_*; -1 si no existe
+int logger_level(const char *name);
+
+// Arranca el hilo registrador (ninguno en LOG_SILENT). 0 o -1 con errno.
+int logger_start(Logger *lg, int level, long long every, LogPrint print, const char *label);
+
+// Ofrece un carácter para mostrar; nunca bloquea
+void logger_char(Logger *lg, long long index, unsigned char c, time_t ts);
+
+// Suma n caracteres procesados (para el resumen)
+void logger_count(Logger *lg, long long n);
+
+// Espera a que el hilo imprima todo lo encolado
+void logger_flush(Logger *lg);
+
+// Vacía el anillo, imprime el resumen final y termina el hilo
+void logger_stop(Logger *lg);
+
+#endif
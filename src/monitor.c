@@ -0,0 +1,313 @@
+/*
+ ============================================================================
+ Archivo: monitor.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Este proceso (Monitor) se anexa en solo lectura (SHM_RDONLY) a un
+    segmento en uso y lo muestrea cada intervalo sin tocar el camino de
+    datos: no toma candados, no se registra en la tabla de procesos y no
+    escribe en el segmento.
+
+    En cada muestra informa, por segundo:
+      - Caudal de emisores y receptores (caracteres/s).
+      - Ocupación del anillo (ranuras ocupadas / ranuras) y, con varios
+        fragmentos, la de cada uno y sus robos en el intervalo.
+      - Con cola de flujos, trabajos persistidos / encolados.
+      - Caudal de cada proceso vivo y la fracción del intervalo que pasó
+        bloqueado en mutex, sin espacio (empty), sin datos (full) o en la
+        ventana de reordenamiento (contadores de sync_account()).
+    Con -p escribe además la última muestra en formato de exposición de
+    Prometheus (texto), reemplazando el archivo de forma atómica con
+    rename() para que un scraper nunca lea una muestra a medias.
+
+    Termina al ver la palabra de cierre del Finalizador o tras -n muestras.
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include "shared.h"
+#include "ring.h"
+#include "proc.h"
+#include "segment.h"
+#include "stream.h"
+
+static const char *role_name[2] = {"emisor", "receptor"};
+static const char *wait_name[SYNC_WAIT_COUNT] = {"mutex", "empty", "full", "window"};
+
+/* --------------------------------------------------------------------------
+   Muestra de la tabla de procesos
+   --------------------------------------------------------------------------
+   Una entrada se considera el mismo proceso entre muestras si conserva el
+   pid; si no, su delta se mide desde cero.
+   -------------------------------------------------------------------------- */
+typedef struct {
+    int active;
+    int role;
+    int pid;
+    int shard;
+    long long chars;
+    long long blocked_ns[SYNC_WAIT_COUNT];
+} ProcSample;
+
+typedef struct {
+    long long at_ns;                 // lat_now() de la muestra
+    long long chars[2];              // totales por rol (incluye retirados)
+    long long used_slots;
+    long long flushed;               // next_to_flush
+    long long jobs_done, jobs_added; // cola de flujos (stream.h)
+    long long ingested, claimed;     // ingesta (ingest.h)
+    long long shard_used[SHARD_MAX];
+    long long shard_steals[SHARD_MAX];
+    ProcSample procs[PROC_MAX];
+} Sample;
+
+static void take_sample(SharedMemory *mem, Sample *s) {
+    s->at_ns = lat_now();
+    s->chars[ROLE_EMITTER]  = proc_total_chars(mem, ROLE_EMITTER);
+    s->chars[ROLE_RECEIVER] = proc_total_chars(mem, ROLE_RECEIVER);
+    s->used_slots = ring_count(mem);
+    s->flushed = atomic_load(&mem->next_to_flush);
+    if (mem->jobs_max > 0) {
+        s->jobs_added = atomic_load(&mem->jobs_added);
+        s->jobs_done = stream_done(mem);
+    }
+    if (mem->ingest_bytes > 0) {
+        s->ingested = atomic_load(&mem->ingest_end);
+        s->claimed = atomic_load(&mem->next_pos);
+    }
+    for (int k = 0; k < mem->shards; k++) {
+        s->shard_used[k] = ring_shard_count(mem, k);
+        s->shard_steals[k] = atomic_load_explicit(&mem->shard[k].steals, memory_order_relaxed);
+    }
+    for (int i = 0; i < PROC_MAX; i++) {
+        ProcEntry *e = &mem->procs[i];
+        ProcSample *p = &s->procs[i];
+        p->active = atomic_load(&e->state) == PROC_ACTIVE;
+        if (!p->active) continue;
+        p->role = e->role;
+        p->pid = e->pid;
+        p->shard = e->shard;
+        p->chars = atomic_load_explicit(&e->chars, memory_order_relaxed);
+        for (int k = 0; k < SYNC_WAIT_COUNT; k++)
+            p->blocked_ns[k] = atomic_load_explicit(&e->blocked_ns[k], memory_order_relaxed);
+    }
+}
+
+// Delta de la entrada i respecto de la muestra anterior (0 si es nueva)
+static const ProcSample *prev_of(const Sample *prev, const ProcSample *p, int i) {
+    const ProcSample *q = &prev->procs[i];
+    return (q->active && q->pid == p->pid) ? q : NULL;
+}
+
+/* --------------------------------------------------------------------------
+   Salida en consola
+   -------------------------------------------------------------------------- */
+static void print_sample(SharedMemory *mem, const Sample *prev, const Sample *cur, double start_s) {
+    double dt = (cur->at_ns - prev->at_ns) / 1e9;
+    double e_rate = (cur->chars[ROLE_EMITTER] - prev->chars[ROLE_EMITTER]) / dt;
+    double r_rate = (cur->chars[ROLE_RECEIVER] - prev->chars[ROLE_RECEIVER]) / dt;
+
+    printf("\n\033[1;32m[%7.1f s]\033[0m emisores %.0f car/s | receptores %.0f car/s | "
+           "anillo %lld/%lld ranuras (%.0f%%) | volcado %lld\n",
+           cur->at_ns / 1e9 - start_s, e_rate, r_rate,
+           cur->used_slots, mem->slots, 100.0 * (double)cur->used_slots / mem->slots, cur->flushed);
+    if (mem->shards > 1) {
+        printf("  fragmentos:");
+        for (int k = 0; k < mem->shards; k++)
+            printf(" [%d] %lld/%lld robos %lld", k, cur->shard_used[k], mem->shard[k].slots,
+                   cur->shard_steals[k] - prev->shard_steals[k]);
+        putchar('\n');
+    }
+    if (mem->jobs_max > 0) printf("  trabajos: %lld/%lld persistidos\n", cur->jobs_done, cur->jobs_added);
+    if (mem->ingest_bytes > 0)
+        printf("  ingesta: %.0f B/s | área %lld/%lld bytes | sin reclamar %lld%s\n",
+               (cur->ingested - prev->ingested) / dt, cur->ingested - cur->flushed, mem->ingest_bytes,
+               cur->ingested - cur->claimed, atomic_load(&mem->ingest_eof) ? " | flujo terminado" : "");
+    printf("\033[1;36m  %-8s %8s %5s %12s %7s %7s %7s %7s\033[0m\n",
+           "rol", "pid", "frag", "car/s", "mutex", "empty", "full", "window");
+
+    for (int i = 0; i < PROC_MAX; i++) {
+        const ProcSample *p = &cur->procs[i];
+        if (!p->active) continue;
+        const ProcSample *q = prev_of(prev, p, i);
+        printf("  %-8s %8d %5d %12.0f", role_name[p->role], p->pid, p->shard,
+               (p->chars - (q ? q->chars : 0)) / dt);
+        for (int k = 0; k < SYNC_WAIT_COUNT; k++) {
+            long long d = p->blocked_ns[k] - (q ? q->blocked_ns[k] : 0);
+            printf(" %6.1f%%", 100.0 * d / (dt * 1e9));
+        }
+        putchar('\n');
+    }
+    fflush(stdout);
+}
+
+/* --------------------------------------------------------------------------
+   Exposición Prometheus (texto), escrita en path.tmp y renombrada
+   -------------------------------------------------------------------------- */
+static int write_prometheus(const char *path, SharedMemory *mem, const Sample *prev, const Sample *cur) {
+    char tmp[PATH_MAX];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) { errno = ENAMETOOLONG; return -1; }
+    FILE *f = fopen(tmp, "w");
+    if (!f) return -1;
+
+    double dt = (cur->at_ns - prev->at_ns) / 1e9;
+
+    fprintf(f, "# HELP ipc_chars_total Caracteres procesados por rol (incluye procesos retirados).\n"
+               "# TYPE ipc_chars_total counter\n");
+    for (int r = 0; r < 2; r++)
+        fprintf(f, "ipc_chars_total{role=\"%s\"} %lld\n", role_name[r], cur->chars[r]);
+
+    fprintf(f, "# HELP ipc_chars_per_second Caudal por rol en el último intervalo.\n"
+               "# TYPE ipc_chars_per_second gauge\n");
+    for (int r = 0; r < 2; r++)
+        fprintf(f, "ipc_chars_per_second{role=\"%s\"} %.1f\n", role_name[r],
+                (cur->chars[r] - prev->chars[r]) / dt);
+
+    fprintf(f, "# HELP ipc_processes_active Procesos vivos por rol.\n"
+               "# TYPE ipc_processes_active gauge\n");
+    for (int r = 0; r < 2; r++)
+        fprintf(f, "ipc_processes_active{role=\"%s\"} %d\n", role_name[r], proc_active(mem, r));
+
+    fprintf(f, "# HELP ipc_ring_slots_used Ranuras ocupadas del anillo.\n"
+               "# TYPE ipc_ring_slots_used gauge\n"
+               "ipc_ring_slots_used %lld\n"
+               "# HELP ipc_ring_slots Ranuras del anillo.\n"
+               "# TYPE ipc_ring_slots gauge\n"
+               "ipc_ring_slots %lld\n"
+               "# HELP ipc_flushed_bytes Bytes persistidos en orden (next_to_flush).\n"
+               "# TYPE ipc_flushed_bytes gauge\n"
+               "ipc_flushed_bytes %lld\n",
+            cur->used_slots, mem->slots, cur->flushed);
+
+    fprintf(f, "# HELP ipc_shard_slots_used Ranuras ocupadas por fragmento.\n"
+               "# TYPE ipc_shard_slots_used gauge\n");
+    for (int k = 0; k < mem->shards; k++)
+        fprintf(f, "ipc_shard_slots_used{shard=\"%d\"} %lld\n", k, cur->shard_used[k]);
+    fprintf(f, "# HELP ipc_shard_steals_total Ranuras extraídas por Receptores de otro fragmento hogar.\n"
+               "# TYPE ipc_shard_steals_total counter\n");
+    for (int k = 0; k < mem->shards; k++)
+        fprintf(f, "ipc_shard_steals_total{shard=\"%d\"} %lld\n", k, cur->shard_steals[k]);
+
+    fprintf(f, "# HELP ipc_process_chars_total Caracteres del proceso.\n"
+               "# TYPE ipc_process_chars_total counter\n");
+    for (int i = 0; i < PROC_MAX; i++) {
+        const ProcSample *p = &cur->procs[i];
+        if (p->active)
+            fprintf(f, "ipc_process_chars_total{role=\"%s\",pid=\"%d\"} %lld\n",
+                    role_name[p->role], p->pid, p->chars);
+    }
+    fprintf(f, "# HELP ipc_process_chars_per_second Caudal del proceso en el último intervalo.\n"
+               "# TYPE ipc_process_chars_per_second gauge\n");
+    for (int i = 0; i < PROC_MAX; i++) {
+        const ProcSample *p = &cur->procs[i];
+        if (!p->active) continue;
+        const ProcSample *q = prev_of(prev, p, i);
+        fprintf(f, "ipc_process_chars_per_second{role=\"%s\",pid=\"%d\"} %.1f\n",
+                role_name[p->role], p->pid, (p->chars - (q ? q->chars : 0)) / dt);
+    }
+    fprintf(f, "# HELP ipc_process_blocked_seconds_total Tiempo bloqueado del proceso por clase de espera.\n"
+               "# TYPE ipc_process_blocked_seconds_total counter\n");
+    for (int i = 0; i < PROC_MAX; i++) {
+        const ProcSample *p = &cur->procs[i];
+        if (!p->active) continue;
+        for (int k = 0; k < SYNC_WAIT_COUNT; k++)
+            fprintf(f, "ipc_process_blocked_seconds_total{role=\"%s\",pid=\"%d\",wait=\"%s\"} %.6f\n",
+                    role_name[p->role], p->pid, wait_name[k], p->blocked_ns[k] / 1e9);
+    }
+
+    static const char *lat_name[LAT_COUNT] = {"dequeue", "disk"};
+    static const double quantiles[] = {0.5, 0.99, 0.999};
+    fprintf(f, "# HELP ipc_latency_quantile_seconds Latencia desde el encolado (por carácter).\n"
+               "# TYPE ipc_latency_quantile_seconds gauge\n");
+    for (int k = 0; k < LAT_COUNT; k++) {
+        for (size_t j = 0; j < sizeof(quantiles) / sizeof(quantiles[0]); j++)
+            fprintf(f, "ipc_latency_quantile_seconds{kind=\"%s\",quantile=\"%g\"} %.9f\n", lat_name[k],
+                    quantiles[j], lat_percentile(&mem->lat[k], quantiles[j] * 100.0) / 1e9);
+        fprintf(f, "ipc_latency_quantile_seconds{kind=\"%s\",quantile=\"1\"} %.9f\n", lat_name[k],
+                atomic_load(&mem->lat[k].max) / 1e9);
+    }
+
+    if (fclose(f) != 0) { unlink(tmp); return -1; }
+    if (rename(tmp, path) == -1) { unlink(tmp); return -1; }
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+   PROCESO PRINCIPAL DEL MONITOR
+   Uso:
+       ./monitor [-i ms] [-n muestras] [-p archivo] [-q] <id_memoria>
+       -i ms       : intervalo de muestreo (por defecto 1000)
+       -n muestras : termina tras n muestras (por defecto 0 = hasta el cierre)
+       -p archivo  : exposición Prometheus de la última muestra
+       -q          : sin tabla en consola (solo -p)
+   -------------------------------------------------------------------------- */
+int main(int argc, char *argv[]) {
+    long interval_ms = 1000;
+    long samples = 0;
+    const char *prom_path = NULL;
+    int quiet = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:p:q")) != -1) {
+        switch (opt) {
+        case 'i':
+            interval_ms = atol(optarg);
+            if (interval_ms < 1) { fprintf(stderr, "Intervalo inválido: %s\n", optarg); exit(EXIT_FAILURE); }
+            break;
+        case 'n': samples = atol(optarg); break;
+        case 'p': prom_path = optarg; break;
+        case 'q': quiet = 1; break;
+        default: exit(EXIT_FAILURE);
+        }
+    }
+    if (argc - optind != 1) {
+        fprintf(stderr, "Uso: %s [-i ms] [-n muestras] [-p archivo] [-q] <id_memoria>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    key_t shm_key = ftok(".", atoi(argv[optind]));
+    if (shm_key == (key_t)-1) { perror("ftok"); exit(EXIT_FAILURE); }
+
+    // Solo lectura: el monitor nunca escribe en el segmento
+    int shm_id = shmget(shm_key, 0, 0);
+    if (shm_id == -1) { perror("shmget"); exit(EXIT_FAILURE); }
+    SharedMemory *mem = (SharedMemory *)shmat(shm_id, NULL, SHM_RDONLY);
+    if (mem == (void *)-1) { perror("shmat"); exit(EXIT_FAILURE); }
+    if (segment_check(mem) == -1) { shmdt(mem); exit(EXIT_FAILURE); }
+
+    static Sample a, b;
+    Sample *prev = &a, *cur = &b;
+    take_sample(mem, prev);
+    double start_s = prev->at_ns / 1e9;
+
+    if (!quiet)
+        printf("Monitor anexado (intervalo %ld ms, %lld ranuras de %d bytes)%s%s\n",
+               interval_ms, mem->slots, mem->slot_bytes,
+               prom_path ? ", Prometheus en " : "", prom_path ? prom_path : "");
+
+    for (long n = 0; samples == 0 || n < samples; n++) {
+        struct timespec d = {interval_ms / 1000, (interval_ms % 1000) * 1000000L};
+        nanosleep(&d, NULL);
+
+        take_sample(mem, cur);
+        if (!quiet) print_sample(mem, prev, cur, start_s);
+        if (prom_path && write_prometheus(prom_path, mem, prev, cur) == -1)
+            perror("escritura Prometheus");
+
+        Sample *t = prev; prev = cur; cur = t;
+        if (sync_is_shutdown(&mem->sync)) {
+            if (!quiet) printf("\n[INFO] El Finalizador cerró el segmento. Saliendo monitor...\n");
+            break;
+        }
+    }
+
+    shmdt(mem);
+    return 0;
+}
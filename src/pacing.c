@@ -0,0 +1,179 @@
+/*
+ ============================================================================
+ Archivo: pacing.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Control de ritmo de Emisores y Receptores (ver pacing.h).
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include "pacing.h"
+
+/* --------------------------------------------------------------------------
+   Utilidades
+   -------------------------------------------------------------------------- */
+
+// "250000", "1.5M" o "64K" (bytes/s); -1 si no es válido
+static double parse_rate(const char *txt) {
+    char *end;
+    double v = strtod(txt, &end);
+    if (end == txt || v <= 0) return -1;
+    switch (*end) {
+    case 'k': case 'K': v *= 1024.0; end++; break;
+    case 'm': case 'M': v *= 1024.0 * 1024.0; end++; break;
+    case 'g': case 'G': v *= 1024.0 * 1024.0 * 1024.0; end++; break;
+    default: break;
+    }
+    return (*end == '\0') ? v : -1;
+}
+
+// Duerme hasta deadline (CLOCK_MONOTONIC, ns) en trozos de hasta 100 ms,
+// revisando la palabra de cierre entre trozos
+static int sleep_until(SharedMemory *mem, long long deadline) {
+    for (;;) {
+        if (sync_is_shutdown(&mem->sync)) { errno = EIDRM; return -1; }
+        long long now = lat_now();
+        if (now >= deadline) return 0;
+        long long until = (deadline - now > 100000000LL) ? now + 100000000LL : deadline;
+        struct timespec t = {until / 1000000000LL, until % 1000000000LL};
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL);
+    }
+}
+
+// Reserva n bytes en la cubeta (tat local o compartido) y devuelve el
+// instante hasta el que hay que dormir
+static long long gcra_reserve(Pacer *p, long long n) {
+    long long now = lat_now();
+    long long cost = (long long)(n * p->ns_per_byte);
+    long long tat, next;
+    if (p->shared) {
+        tat = atomic_load_explicit(p->shared, memory_order_relaxed);
+        do {
+            next = ((tat > now) ? tat : now) + cost;
+        } while (!atomic_compare_exchange_weak_explicit(p->shared, &tat, next,
+                                                        memory_order_relaxed, memory_order_relaxed));
+    } else {
+        next = ((p->tat > now) ? p->tat : now) + cost;
+        p->tat = next;
+    }
+    return next - PACE_BURST_NS;
+}
+
+/* --------------------------------------------------------------------------
+   Traza de llegadas
+   -------------------------------------------------------------------------- */
+static int load_trace(Pacer *p, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror("traza de ritmo"); return -1; }
+
+    int cap = 0, line = 0;
+    long long total = 0, last_t = 0;
+    char buf[256];
+    while (fgets(buf, sizeof(buf), f)) {
+        line++;
+        char *s = buf + strspn(buf, " \t");
+        if (*s == '#' || *s == '\n' || *s == '\0') continue;
+        double secs;
+        long long bytes;
+        if (sscanf(s, "%lf %lld", &secs, &bytes) != 2 || secs < 0 || bytes < 0) {
+            fprintf(stderr, "%s:%d: se esperaba \"<segundos> <bytes>\"\n", path, line);
+            fclose(f); return -1;
+        }
+        long long t = (long long)(secs * 1e9);
+        if (t < last_t) {
+            fprintf(stderr, "%s:%d: los instantes deben ser crecientes\n", path, line);
+            fclose(f); return -1;
+        }
+        if (p->entries == cap) {
+            cap = cap ? cap * 2 : 256;
+            long long *nt = realloc(p->t_ns, (size_t)cap * sizeof(long long));
+            if (nt) p->t_ns = nt;
+            long long *nc = realloc(p->cum, (size_t)cap * sizeof(long long));
+            if (nc) p->cum = nc;
+            if (!nt || !nc) { perror("realloc"); fclose(f); return -1; }
+        }
+        total += bytes;
+        last_t = t;
+        p->t_ns[p->entries] = t;
+        p->cum[p->entries] = total;
+        p->entries++;
+    }
+    fclose(f);
+    if (total == 0) { fprintf(stderr, "%s: la traza no tiene bytes\n", path); return -1; }
+    return 0;
+}
+
+static long long replay_deadline(Pacer *p, long long n) {
+    if (p->start_ns == 0) p->start_ns = lat_now();
+    long long target = p->done + n;
+    long long lap = p->cum[p->entries - 1];
+
+    // Vueltas completas de la traza que el tramo deja atrás
+    while (target > p->base + lap) {
+        p->base += lap;
+        p->start_ns += p->t_ns[p->entries - 1];
+        p->at = 0;
+    }
+    while (p->base + p->cum[p->at] < target) p->at++;
+    p->done = target;
+    return p->start_ns + p->t_ns[p->at];
+}
+
+/* --------------------------------------------------------------------------
+   Interfaz
+   -------------------------------------------------------------------------- */
+void pacer_default(Pacer *p, int run_mode) {
+    memset(p, 0, sizeof(*p));
+    p->mode = (run_mode == RUN_AUTO) ? PACE_FIXED : PACE_UNLIMITED;
+}
+
+int pacer_parse(Pacer *p, const char *spec, SharedMemory *mem, int role) {
+    memset(p, 0, sizeof(*p));
+    if (strcmp(spec, "unlimited") == 0) {
+        p->mode = PACE_UNLIMITED;
+    } else if (strcmp(spec, "fixed") == 0) {
+        p->mode = PACE_FIXED;
+    } else if (strncmp(spec, "rate:", 5) == 0) {
+        double rate = parse_rate(spec + 5);
+        if (rate <= 0) { fprintf(stderr, "Ritmo inválido: %s\n", spec + 5); return -1; }
+        p->mode = PACE_RATE;
+        p->ns_per_byte = 1e9 / rate;
+    } else if (strcmp(spec, "global") == 0) {
+        if (mem->pace_rate <= 0) {
+            fprintf(stderr, "El segmento no tiene cubeta global (use -t en el Inicializador)\n");
+            return -1;
+        }
+        p->mode = PACE_GLOBAL;
+        p->ns_per_byte = 1e9 / (double)mem->pace_rate;
+        p->shared = &mem->pace[role].tat;
+    } else if (strncmp(spec, "replay:", 7) == 0) {
+        p->mode = PACE_REPLAY;
+        if (load_trace(p, spec + 7) == -1) { pacer_free(p); return -1; }
+    } else {
+        fprintf(stderr, "Ritmo desconocido: %s (use unlimited|fixed|rate:B|global|replay:ARCHIVO)\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+int pacer_wait(Pacer *p, SharedMemory *mem, long long n) {
+    switch (p->mode) {
+    case PACE_FIXED:  return sleep_until(mem, lat_now() + PACE_FIXED_NS);
+    case PACE_RATE:
+    case PACE_GLOBAL: return sleep_until(mem, gcra_reserve(p, n));
+    case PACE_REPLAY: return sleep_until(mem, replay_deadline(p, n));
+    default:          return 0;
+    }
+}
+
+void pacer_free(Pacer *p) {
+    free(p->t_ns);
+    free(p->cum);
+    p->t_ns = p->cum = NULL;
+}
@@ -0,0 +1,73 @@
+#ifndef PACING_H
+#define PACING_H
+/*
+ =============================================================================
+  Archivo: pacing.h
+  Propósito:
+    Control de ritmo de Emisores y Receptores. Reemplaza el nanosleep fijo
+    de 0.4 s del modo automático por un subsistema con varios modos.
+
+  Modos (-p en Emisor/Receptor):
+    - "fixed"        : 0.4 s por tramo (el modo automático de siempre).
+    - "unlimited"    : sin pausas (máximo caudal).
+    - "rate:B"       : cubeta de fichas local, B bytes/s para este proceso
+                       (admite sufijos K/M/G).
+    - "global"       : cubeta compartida en el segmento; todos los procesos
+                       del mismo rol que la usan suman pace_rate bytes/s
+                       (lo fija el Inicializador con -t).
+    - "replay:ARCH"  : sigue una traza de llegadas grabada. Cada línea es
+                       "<segundos> <bytes>" (tiempo relativo al inicio,
+                       creciente; '#' comenta); el proceso no supera, en el
+                       instante t, los bytes acumulados de la traza hasta t.
+                       Al agotarse, la traza se repite desplazada.
+
+  Cubetas (local y global) con GCRA: un único instante teórico de llegada
+  (tat). Cada tramo de n bytes reserva n / rate segundos con un CAS sobre
+  tat y duerme hasta tat - ráfaga si quedó adelantado; la compartida es
+  un solo entero atómico en el segmento, sin candados.
+
+  Las esperas duermen con CLOCK_MONOTONIC en trozos de hasta 100 ms y
+  devuelven -1 con errno = EIDRM si el Finalizador pidió el cierre.
+ =============================================================================
+*/
+#include "shared.h"
+
+#define PACE_UNLIMITED  0
+#define PACE_FIXED      1
+#define PACE_RATE       2   // cubeta local
+#define PACE_GLOBAL     3   // cubeta compartida del rol
+#define PACE_REPLAY     4
+
+#define PACE_FIXED_NS   400000000LL  // 0.4 s por tramo (modo automático)
+#define PACE_BURST_NS   10000000LL   // ráfaga tolerada por las cubetas (10 ms)
+
+typedef struct {
+    int mode;                    // PACE_*
+    double ns_per_byte;          // cubetas
+    long long tat;               // instante teórico de llegada (cubeta local)
+    _Atomic long long *shared;   // tat de la cubeta compartida
+
+    // Traza (PACE_REPLAY)
+    long long *t_ns;             // instantes relativos, crecientes
+    long long *cum;              // bytes acumulados hasta cada instante
+    int entries;
+    int at;                      // primera entrada con cum > done (vuelta actual)
+    long long start_ns;          // inicio de la vuelta actual
+    long long base;              // bytes de las vueltas anteriores
+    long long done;              // bytes ya procesados
+} Pacer;
+
+// Ritmo por defecto del modo de ejecución (RUN_AUTO = fixed; otros = unlimited)
+void pacer_default(Pacer *p, int run_mode);
+
+// Interpreta una especificación de -p para un proceso del rol dado.
+// -1 con un mensaje en stderr si no es válida.
+int pacer_parse(Pacer *p, const char *spec, SharedMemory *mem, int role);
+
+// Espera lo necesario antes/después de procesar n bytes.
+// 0, o -1 con errno = EIDRM si se pidió el cierre mientras dormía.
+int pacer_wait(Pacer *p, SharedMemory *mem, long long n);
+
+void pacer_free(Pacer *p);
+
+#endif
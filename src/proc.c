@@ -0,0 +1,125 @@
+/*
+ ============================================================================
+ Archivo: proc.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Tabla de procesos y estadísticas agregadas (ver proc.h).
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include "proc.h"
+#include "ring.h"
+
+ProcEntry *proc_register(SharedMemory *mem, int role) {
+    for (int i = 0; i < PROC_MAX; i++) {
+        ProcEntry *e = &mem->procs[i];
+        int expected = PROC_FREE;
+        if (atomic_load_explicit(&e->state, memory_order_relaxed) != PROC_FREE) continue;
+        if (!atomic_compare_exchange_strong(&e->state, &expected, PROC_ACTIVE)) continue;
+
+        e->role = role;
+        e->pid = (int)getpid();
+        // Fragmento hogar: reparto rotativo entre los procesos del rol
+        int ordinal = atomic_fetch_add(&mem->registered[role], 1);
+        e->shard = ordinal % (mem->shards > 0 ? mem->shards : 1);
+        atomic_store(&e->chars, 0);
+        for (int k = 0; k < SYNC_WAIT_COUNT; k++) atomic_store(&e->blocked_ns[k], 0);
+        atomic_store(&e->lease_n, 0);
+        atomic_store(&e->lease_tokens, 0);
+        atomic_store(&e->lease_pos, 0);
+        atomic_store(&e->reaper, 0);
+        e->lease_direct = 0;
+        for (int k = 0; k < PROC_INFLIGHT; k++) e->inflight[k].len = 0;
+        sync_account(e->blocked_ns);
+        ring_set_owner(e);
+        return e;
+    }
+    errno = ENOSPC;
+    return NULL;
+}
+
+// 1 si la entrada tiene algo en curso: arriendo, pedidos de salida sin
+// marcar, o posición y empty/full tomados en el anillo
+static int proc_holds(ProcEntry *e) {
+    if (atomic_load(&e->lease_tokens) > 0 || atomic_load(&e->lease_pos) != 0) return 1;
+    int n = atomic_load(&e->lease_n);
+    for (int i = 0; i < n; i++)
+        if (e->lease[i].len > 0) return 1;
+    for (int i = 0; i < PROC_INFLIGHT; i++)
+        if (e->inflight[i].len > 0) return 1;
+    return 0;
+}
+
+void proc_unregister(SharedMemory *mem, ProcEntry *self) {
+    sync_account(NULL);
+    ring_set_owner(NULL);
+    if (proc_holds(self)) {
+        // Sale por un error con trabajo en la mano: lo completa recover.c
+        // como el de un proceso muerto, y recién entonces se libera
+        fprintf(stderr, "\n[WARN] %s %d sale con trabajo en curso; queda para recuperación\n",
+                (self->role == ROLE_EMITTER) ? "Emisor" : "Receptor", self->pid);
+        atomic_store(&self->state, PROC_DEAD);
+        sync_notify(&mem->sync, SYNC_EV_DRAIN, INT_MAX);
+        return;
+    }
+    proc_retire(mem, self);
+}
+
+void proc_retire(SharedMemory *mem, ProcEntry *e) {
+    atomic_fetch_add(&mem->retired_chars[e->role], atomic_load(&e->chars));
+    atomic_store(&e->chars, 0);
+    atomic_store(&e->reaper, 0);
+    e->pid = 0; // recover.c no revisa entradas a medio registrar
+    atomic_store(&e->state, PROC_FREE);
+    sync_notify(&mem->sync, SYNC_EV_DRAIN, INT_MAX); // el Finalizador cuenta emisores vivos
+}
+
+void proc_lease_set(ProcEntry *self, long long seq, int len) {
+    self->lease[0] = (SeqRange){ seq, len };
+    atomic_store_explicit(&self->lease_n, 1, memory_order_release);
+}
+
+void proc_lease_drop(ProcEntry *self, int first, int n) {
+    for (int i = first; i < first + n; i++) self->lease[i].len = 0;
+    atomic_thread_fence(memory_order_release);
+}
+
+void proc_lease_clear(ProcEntry *self) {
+    atomic_store_explicit(&self->lease_n, 0, memory_order_release);
+}
+
+void proc_add(ProcEntry *self, long long n) {
+    long long cur = atomic_load_explicit(&self->chars, memory_order_relaxed);
+    atomic_store_explicit(&self->chars, cur + n, memory_order_relaxed);
+}
+
+long long proc_total_chars(SharedMemory *mem, int role) {
+    long long total = atomic_load(&mem->retired_chars[role]);
+    for (int i = 0; i < PROC_MAX; i++) {
+        ProcEntry *e = &mem->procs[i];
+        if (atomic_load(&e->state) != PROC_FREE && e->role == role)
+            total += atomic_load_explicit(&e->chars, memory_order_relaxed);
+    }
+    return total;
+}
+
+int proc_active(SharedMemory *mem, int role) {
+    int n = 0;
+    for (int i = 0; i < PROC_MAX; i++) {
+        ProcEntry *e = &mem->procs[i];
+        if (atomic_load(&e->state) == PROC_ACTIVE && e->role == role) n++;
+    }
+    return n;
+}
+
+int proc_pending(SharedMemory *mem) {
+    int n = 0;
+    for (int i = 0; i < PROC_MAX; i++)
+        if (atomic_load(&mem->procs[i].state) == PROC_DEAD) n++;
+    return n;
+}
@@ -0,0 +1,58 @@
+#ifndef PROC_H
+#define PROC_H
+/*
+ =============================================================================
+  Archivo: proc.h
+  Propósito:
+    Tabla de procesos del segmento: registro de Emisores/Receptores y
+    estadísticas por proceso agregadas al leer.
+
+  Resumen funcional:
+    - Cada proceso toma una entrada libre de procs[] al iniciar y cuenta en
+      ella sus caracteres y su tiempo bloqueado (sync_account); nadie más
+      escribe esa línea de caché.
+    - Al salir, suma su contador a retired_chars[rol] y libera la entrada.
+    - Los totales (caracteres, procesos vivos) se calculan recorriendo la
+      tabla; son aproximados mientras haya registros o salidas en curso.
+    - Arriendo: lo que el proceso tiene en la mano y aún no terminó (el
+      tramo de la fuente de un Emisor, los tramos extraídos de un
+      Receptor). El anillo anota sus propias posiciones (ring_set_owner);
+      si el proceso muere, o sale por un error sin haberlo terminado,
+      recover.c completa el arriendo y libera la entrada con proc_retire.
+ =============================================================================
+*/
+#include "shared.h"
+
+// Toma una entrada para el proceso actual. NULL con errno = ENOSPC si la
+// tabla está llena.
+ProcEntry *proc_register(SharedMemory *mem, int role);
+
+// Acumula los caracteres del proceso en retired_chars y libera la entrada.
+// Si aún tiene algo en curso (salida por error) la deja PROC_DEAD para
+// recover.c, que la libera al completarlo.
+void proc_unregister(SharedMemory *mem, ProcEntry *self);
+
+// Arriendo del proceso: un solo tramo [seq, seq+len) (Emisor), quitar
+// los tramos first..first+n-1 ya persistidos (Receptor) o vaciarlo
+void proc_lease_set(ProcEntry *self, long long seq, int len);
+void proc_lease_drop(ProcEntry *self, int first, int n);
+void proc_lease_clear(ProcEntry *self);
+
+// Libera la entrada de un proceso muerto ya recuperado (como si hubiera
+// salido con proc_unregister)
+void proc_retire(SharedMemory *mem, ProcEntry *e);
+
+// Suma n caracteres al contador propio (sin operaciones atómicas de
+// lectura-modificación: el dueño es el único escritor)
+void proc_add(ProcEntry *self, long long n);
+
+// Caracteres totales del rol (retirados + vivos)
+long long proc_total_chars(SharedMemory *mem, int role);
+
+// Procesos vivos del rol
+int proc_active(SharedMemory *mem, int role);
+
+// Procesos muertos cuya recuperación sigue pendiente (PROC_DEAD)
+int proc_pending(SharedMemory *mem);
+
+#endif
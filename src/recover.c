@@ -0,0 +1,274 @@
+/*
+ ============================================================================
+ Archivo: recover.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Recuperación de procesos caídos a mitad de una transferencia (ver
+    recover.h).
+
+    Emisor muerto con un tramo [pos, pos + chunk) en arriendo:
+      1) Si reclamó ranuras o un registro sin publicarlos, se publican
+         (ring_repair) con los bytes de la fuente: los Receptores del
+         anillo los esperan en esas posiciones.
+      2) Con frame_lines el tramo es el de sus líneas: de la primera que
+         empieza en pos a la primera que empieza en pos + chunk.
+      3) Si el turno de reclamo next_claim ya llegó al tramo, lo que falta
+         publicar va de max(next_claim, lo ya publicado) al final: se pasa
+         el turno al final del tramo y ese resto queda como arriendo
+         directo (lease_direct), que un Receptor entrega en claro a la
+         salida cuando la ventana tenga lugar.
+    Receptor muerto: se libera su registro tomado y cada tramo extraído
+    aún sin persistir se entrega igual, desde la fuente; también los
+    pedidos de su escritor de salida que no llegó a marcar (writer.h).
+    Una entrega repetida (el proceso murió justo después de persistir) la
+    descarta la ventana si ya se volcó, o reescribe los mismos bytes.
+    Con la cola de flujos la fuente es la de los trabajos (stream.h); con
+    ingesta, el área de ingesta (ingest.h), que conserva todo seq aún sin
+    persistir. Lo que next_to_flush ya cubre no se entrega: está
+    persistido y el área pudo pisarlo.
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "recover.h"
+#include "ring.h"
+#include "reorder.h"
+#include "proc.h"
+#include "stream.h"
+#include "ingest.h"
+
+#define RECOVER_PIECE 65536 // bytes por lectura de la fuente y por entrega
+
+/* --------------------------------------------------------------------------
+   Fuente (descriptor propio del proceso que recupera)
+   -------------------------------------------------------------------------- */
+static int src_fd = -1;
+static char *src_buf;
+static size_t src_cap;
+static StreamFile src_job = { .id = -1, .fd = -1 };
+
+static int source_ready(SharedMemory *mem) {
+    if (src_fd == -1) src_fd = open(mem->fuente_path, O_RDONLY);
+    return (src_fd == -1) ? -1 : 0;
+}
+
+static long long source_size(SharedMemory *mem) {
+    if (mem->jobs_max > 0) return atomic_load(&mem->jobs_end);
+    if (mem->ingest_bytes > 0) return atomic_load(&mem->ingest_end);
+    struct stat st;
+    if (source_ready(mem) == -1 || fstat(src_fd, &st) == -1) return -1;
+    return (long long)st.st_size;
+}
+
+// Hasta n bytes desde off (menos al final del archivo); -1 con errno
+static ssize_t source_at(SharedMemory *mem, long long off, size_t n, const char **data) {
+    int file = (mem->jobs_max == 0 && mem->ingest_bytes == 0);
+    if (file && source_ready(mem) == -1) return -1;
+    if (n > src_cap) {
+        char *b = realloc(src_buf, n);
+        if (!b) return -1;
+        src_buf = b;
+        src_cap = n;
+    }
+    if (mem->jobs_max > 0) {
+        *data = src_buf;
+        return stream_read(&src_job, mem, off, src_buf, n);
+    }
+    if (mem->ingest_bytes > 0) {
+        *data = src_buf;
+        return ingest_read(mem, off, src_buf, n);
+    }
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = pread(src_fd, src_buf + got, n - got, (off_t)(off + (long long)got));
+        if (r == 0) break;
+        if (r == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        got += (size_t)r;
+    }
+    *data = src_buf;
+    return (ssize_t)got;
+}
+
+// Primer inicio de línea >= x (tras el primer '\n' desde x - 1); size si no
+// hay más líneas. -1 si falla la lectura.
+static long long line_start(SharedMemory *mem, long long x, long long size) {
+    if (x <= 0) return 0;
+    for (long long at = x - 1; at < size;) {
+        const char *d;
+        ssize_t got = source_at(mem, at, RECOVER_PIECE, &d);
+        if (got == -1) return -1;
+        if (got == 0) break;
+        const char *nl = memchr(d, '\n', (size_t)got);
+        if (nl) return at + (nl - d) + 1;
+        at += got;
+    }
+    return size;
+}
+
+/* --------------------------------------------------------------------------
+   Vida de un proceso
+   -------------------------------------------------------------------------- */
+static int pid_alive(int pid) {
+    if (kill(pid, 0) == -1 && errno == ESRCH) return 0;
+
+    // Un hijo terminado que nadie esperó (zombi) sigue respondiendo a kill
+    char path[64], line[512];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *f = fopen(path, "r");
+    if (!f) return 1;
+    int alive = 1;
+    if (fgets(line, sizeof(line), f)) {
+        char *p = strrchr(line, ')'); // el nombre puede tener espacios
+        if (p && p[1] == ' ' && (p[2] == 'Z' || p[2] == 'X')) alive = 0;
+    }
+    fclose(f);
+    return alive;
+}
+
+/* --------------------------------------------------------------------------
+   Arriendos
+   Todas devuelven 0 si esa parte quedó completa y 1 si falta algo.
+   -------------------------------------------------------------------------- */
+
+// Emisor: publica lo reclamado, pasa el turno y deja el resto en lease[0]
+static int emitter_to_direct(Recovery *rc, ProcEntry *e) {
+    SharedMemory *mem = rc->mem;
+    long long size = source_size(mem);
+    if (size == -1) return 1;
+
+    if (atomic_load(&e->lease_pos)) {
+        const char *d;
+        if (!rc->codec) return 1;
+        if (source_at(mem, e->lease_pos_seq, (size_t)e->lease_pos_len, &d) != e->lease_pos_len) return 1;
+        if (ring_repair(mem, e, d, rc->codec) != 0) return 1;
+    }
+
+    long long start = e->lease[0].seq;
+    long long end = start + e->lease[0].len;
+    if (end > size) end = size;
+    if (start > end) start = end;
+    if (mem->frame_lines) {
+        end = line_start(mem, end, size);
+        start = line_start(mem, start, size);
+        if (start == -1 || end == -1) return 1;
+        if (start > end) start = end;
+    }
+
+    long long from = start;
+    if (start < end) {
+        long long claim = atomic_load(&mem->next_claim);
+        if (claim < start) return 1; // el turno aún no llega a este tramo
+        long long published = e->lease_pos_seq;
+        if (published > from && published <= end) from = published;
+        if (claim > from) from = (claim < end) ? claim : end;
+        if (claim < end) ring_claim_skip(mem, claim, end);
+    }
+    e->lease[0] = (SeqRange){ from, (int)(end - from) };
+    atomic_store(&e->lease_n, 1);
+    e->lease_direct = 1;
+    return 0;
+}
+
+// Entrega directa de un tramo a la salida, de a lo sumo una ventana
+static int deliver_range(Recovery *rc, SeqRange *r) {
+    SharedMemory *mem = rc->mem;
+    long long most = (mem->reorder_size < RECOVER_PIECE) ? mem->reorder_size : RECOVER_PIECE;
+    long long flushed = atomic_load(&mem->next_to_flush);
+    if (r->len > 0 && r->seq < flushed) {
+        long long done = (flushed - r->seq < r->len) ? flushed - r->seq : r->len;
+        r->seq += done;
+        r->len -= (int)done;
+    }
+    while (r->len > 0) {
+        if (!rc->deliver) return 1;
+        const char *d;
+        ssize_t got = source_at(mem, r->seq, (size_t)((r->len < most) ? r->len : most), &d);
+        if (got == -1) return 1;
+        if (got == 0) { r->len = 0; break; } // más allá de la fuente
+        if (rc->deliver(rc->arg, d, (int)got, r->seq) != 0) return 1;
+        r->seq += got;
+        r->len -= (int)got;
+    }
+    return 0;
+}
+
+// lease[] y, de un Receptor, los pedidos de su escritor sin marcar
+static int deliver_lease(Recovery *rc, ProcEntry *e) {
+    int n = atomic_load(&e->lease_n);
+    for (int i = 0; i < n; i++)
+        if (deliver_range(rc, &e->lease[i]) != 0) return 1;
+    atomic_store(&e->lease_n, 0);
+    if (e->role == ROLE_RECEIVER)
+        for (int i = 0; i < PROC_INFLIGHT; i++)
+            if (deliver_range(rc, &e->inflight[i]) != 0) return 1;
+    return 0;
+}
+
+static int recover_entry(Recovery *rc, ProcEntry *e) {
+    SharedMemory *mem = rc->mem;
+    sync_release_dead(&mem->sync, e->pid);
+    reorder_release_dead(mem, e->pid, rc->out);
+
+    int tokens = atomic_exchange(&e->lease_tokens, 0);
+    if (tokens > 0 &&
+        sync_post(&mem->sync, rc->sem_id, (e->role == ROLE_EMITTER) ? SEM_EMPTY : SEM_FULL, tokens) == -1) {
+        atomic_store(&e->lease_tokens, tokens);
+        return 1;
+    }
+
+    if (e->role == ROLE_RECEIVER) ring_release_dead(mem, e);
+    else if (!e->lease_direct && atomic_load(&e->lease_n) > 0 && emitter_to_direct(rc, e) != 0) return 1;
+    return deliver_lease(rc, e);
+}
+
+/* --------------------------------------------------------------------------
+   Interfaz
+   -------------------------------------------------------------------------- */
+int recover_run(Recovery *rc) {
+    SharedMemory *mem = rc->mem;
+    int self = (int)getpid();
+    int pending = 0;
+
+    for (int i = 0; i < PROC_MAX; i++) {
+        ProcEntry *e = &mem->procs[i];
+        int state = atomic_load(&e->state);
+        if (state == PROC_ACTIVE) {
+            // pid == 0: la entrada se está registrando
+            if (e->pid == 0 || e->pid == self || pid_alive(e->pid)) continue;
+            if (!atomic_compare_exchange_strong(&e->state, &state, PROC_DEAD)) continue;
+            fprintf(stderr, "\n[WARN] %s %d terminó sin cerrar; recuperando lo que tenía en curso\n",
+                    (e->role == ROLE_EMITTER) ? "Emisor" : "Receptor", e->pid);
+        } else if (state != PROC_DEAD) {
+            continue;
+        }
+
+        // Un solo recuperador por entrada; se hereda si el anterior murió
+        int reaper = 0;
+        if (!atomic_compare_exchange_strong(&e->reaper, &reaper, self) &&
+            (reaper == self || pid_alive(reaper) || !atomic_compare_exchange_strong(&e->reaper, &reaper, self))) {
+            pending++;
+            continue;
+        }
+        if (recover_entry(rc, e) == 0) {
+            proc_retire(mem, e);
+        } else {
+            atomic_store(&e->reaper, 0);
+            pending++;
+        }
+    }
+    return pending;
+}
+
+void recover_hook(void *rc) {
+    recover_run(rc);
+}
@@ -0,0 +1,69 @@
+#ifndef RECOVER_H
+#define RECOVER_H
+/*
+ =============================================================================
+  Archivo: recover.h
+  Propósito:
+    Recuperación de Emisores y Receptores que mueren a mitad de una
+    transferencia (kill -9, fallo). Sin ella un proceso caído deja tomado
+    lo que tenía en la mano y todos los demás quedan esperando para
+    siempre: el mutex, el turno de reclamo next_claim, ranuras reclamadas
+    sin publicar, el candado de volcado o un seq que nunca llega a la
+    ventana de reordenamiento.
+
+  Resumen funcional:
+    - Cada proceso anota en su entrada de la tabla (ProcEntry) un arriendo:
+      el tramo de la fuente que publica (Emisor) o los tramos extraídos
+      aún sin persistir (Receptor); el anillo agrega la posición reclamada
+      y los empty/full tomados (ring_set_owner).
+    - recover_run() recorre la tabla: una entrada PROC_ACTIVE cuyo pid ya
+      no existe pasa a PROC_DEAD y quien gana e->reaper la completa:
+        . suelta el mutex (modo futex) y el candado de volcado,
+        . devuelve empty/full tomados sin usar,
+        . publica las ranuras o el registro reclamados sin publicar,
+          leyendo esos bytes de la fuente y codificándolos,
+        . cede el turno de reclamo más allá del tramo del Emisor muerto y
+          entrega el resto del tramo (o los tramos del Receptor) directo
+          a la salida, en claro desde la fuente.
+      Lo que aún no puede hacerse (la ventana no tiene lugar, falta el
+      turno, el proceso no sabe entregar) queda para una pasada posterior
+      u otro proceso. Completo el arriendo, la entrada se libera.
+    - Los procesos la llaman desde el gancho de espera prolongada
+      (sync_on_stall): solo quien lleva SYNC_STALL_NS bloqueado revisa la
+      tabla, y el camino de datos sin muertes no paga nada. El Finalizador
+      la llama mientras drena.
+
+  Limitaciones:
+    - La vida se comprueba con kill(pid, 0): un proceso colgado pero vivo
+      no se considera muerto.
+    - Un proceso que muere entre reclamar (CAS de next_pos o de read_index)
+      y anotar su arriendo pierde ese tramo: la ventana es de unas pocas
+      instrucciones.
+    - En modo semáforos, una muerte dentro de la sección crítica solo se
+      recupera hasta el mutex; empty/full ya movidos no se rehacen.
+ =============================================================================
+*/
+#include <stdio.h>
+#include "shared.h"
+#include "codec.h"
+
+typedef struct {
+    SharedMemory *mem;
+    int sem_id;
+    const Codec *codec;   // para publicar lo reclamado (NULL: no puede)
+    // Entrega n bytes en claro de seq..seq+n-1 a la salida (Receptor).
+    // 0 hecho, 1 todavía no (la ventana no tiene lugar), -1 error.
+    // NULL: el proceso no entrega; lo harán los Receptores.
+    int (*deliver)(void *arg, const char *data, int n, long long seq);
+    void *arg;
+    FILE *out;            // salida append del Receptor (para volcar), o NULL
+} Recovery;
+
+// Una pasada sobre la tabla de procesos. Devuelve cuántos procesos
+// muertos quedan con su recuperación pendiente.
+int recover_run(Recovery *rc);
+
+// Adaptador para sync_on_stall(recover_hook, rc)
+void recover_hook(void *rc);
+
+#endif
@@ -0,0 +1,255 @@
+/*
+ ============================================================================
+ Archivo: reorder.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Ventana de reordenamiento compartida (ver reorder.h).
+
+    Distribución dentro del segmento (a partir de reorder_offset):
+      ready[w/64]: un bit por posición; el bit seq % w se enciende al
+                depositar seq y lo apaga quien lo vuelca, antes de avanzar
+                next_to_flush (recién entonces puede llegar seq + w)
+      stamps[w/WIN_GRAIN + 2]: marca de encolado (ns) del último depósito
+                que tocó cada grano de WIN_GRAIN seq; la latencia enq→disco
+                se registra por grano, no por depósito
+      data[w] : bytes decodificados, en data[seq % w]
+    Así la ventana cuesta poco más que sus datos (1/8 de byte por
+    posición más 8 bytes por grano) aunque los depósitos sean de un byte.
+    El candado de volcado (flush_lock) solo se intenta tomar, nunca se
+    espera: quien lo suelta vuelve a revisar si quedó algo listo. Guarda el
+    pid de quien vuelca para que recover.c pueda soltarlo si ese proceso
+    muere con él tomado.
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include "reorder.h"
+
+#define WIN_GRAIN 4096 // seq por marca de encolado
+
+/* --------------------------------------------------------------------------
+   Acceso a los arreglos de la ventana
+   -------------------------------------------------------------------------- */
+static long long ready_words(long long w) { return (w + 63) / 64; }
+// Dos granos de más: dos seq de la ventana nunca comparten marca
+static long long stamp_count(long long w) { return w / WIN_GRAIN + 2; }
+
+static _Atomic unsigned long long *win_ready(SharedMemory *mem) {
+    return (_Atomic unsigned long long *)((char *)mem + mem->reorder_offset);
+}
+static _Atomic long long *win_stamps(SharedMemory *mem) {
+    return (_Atomic long long *)(win_ready(mem) + ready_words(mem->reorder_size));
+}
+static char *win_data(SharedMemory *mem) {
+    return (char *)(win_stamps(mem) + stamp_count(mem->reorder_size));
+}
+
+size_t reorder_bytes(long long w) {
+    size_t bytes = (size_t)ready_words(w) * sizeof(unsigned long long) +
+                   (size_t)stamp_count(w) * sizeof(long long) + (size_t)w;
+    return (bytes + 63) & ~(size_t)63;
+}
+
+void reorder_init(SharedMemory *mem, size_t offset, long long w) {
+    mem->reorder_offset = offset;
+    mem->reorder_size = w;
+    atomic_store(&mem->flush_lock, 0);
+    _Atomic unsigned long long *ready = win_ready(mem);
+    for (long long i = 0; i < ready_words(w); i++) atomic_store_explicit(&ready[i], 0, memory_order_relaxed);
+}
+
+/* --------------------------------------------------------------------------
+   Bits de depósito
+   -------------------------------------------------------------------------- */
+
+// Enciende (on) o apaga los bits [at, at + n) sin pasar del fin de la
+// ventana. Con otros depositando en la misma palabra: fetch_or/fetch_and.
+static void bits_apply(_Atomic unsigned long long *ready, long long at, long long n, int on) {
+    while (n > 0) {
+        int bit = (int)(at % 64);
+        long long k = (n < 64 - bit) ? n : 64 - bit;
+        unsigned long long mask = (k == 64) ? ~0ULL : ((1ULL << k) - 1) << bit;
+        if (on) atomic_fetch_or_explicit(&ready[at / 64], mask, memory_order_release);
+        else    atomic_fetch_and_explicit(&ready[at / 64], ~mask, memory_order_relaxed);
+        at += k;
+        n -= k;
+    }
+}
+
+// Bits de seq..seq+n-1 (n <= w), partidos en la vuelta de la ventana
+static void bits_range(SharedMemory *mem, long long seq, long long n, int on) {
+    long long w = mem->reorder_size;
+    long long at = seq % w;
+    long long first = (at + n > w) ? w - at : n;
+    bits_apply(win_ready(mem), at, first, on);
+    bits_apply(win_ready(mem), 0, n - first, on);
+}
+
+// Primer seq desde start sin depositar (a lo sumo start + w)
+static long long ready_end(SharedMemory *mem, long long start) {
+    long long w = mem->reorder_size;
+    _Atomic unsigned long long *ready = win_ready(mem);
+    long long s = start;
+    while (s < start + w) {
+        long long at = s % w;
+        int bit = (int)(at % 64);
+        long long avail = (w - at < 64 - bit) ? w - at : 64 - bit; // bits de la palabra dentro de la ventana
+        unsigned long long word = atomic_load_explicit(&ready[at / 64], memory_order_acquire) >> bit;
+        long long run = (~word == 0) ? 64 : __builtin_ctzll(~word);
+        if (run > avail) run = avail;
+        s += run;
+        if (run < avail) break;
+    }
+    return (s < start + w) ? s : start + w;
+}
+
+// Marca de encolado de cada grano que toca el depósito
+static void stamps_set(SharedMemory *mem, long long seq, long long n, long long enq_ns) {
+    _Atomic long long *stamps = win_stamps(mem);
+    long long count = stamp_count(mem->reorder_size);
+    for (long long g = seq / WIN_GRAIN; g <= (seq + n - 1) / WIN_GRAIN; g++)
+        atomic_store_explicit(&stamps[g % count], enq_ns, memory_order_relaxed);
+}
+
+// Latencia enq→disco de [from, to), grano por grano
+static void stamps_record(SharedMemory *mem, long long from, long long to) {
+    _Atomic long long *stamps = win_stamps(mem);
+    long long count = stamp_count(mem->reorder_size);
+    long long now = lat_now();
+    while (from < to) {
+        long long g = from / WIN_GRAIN;
+        long long next = (g + 1) * WIN_GRAIN;
+        if (next > to) next = to;
+        lat_record(&mem->lat[LAT_DISK], now - atomic_load_explicit(&stamps[g % count], memory_order_relaxed),
+                   next - from);
+        from = next;
+    }
+}
+
+/* --------------------------------------------------------------------------
+   Volcado de la corrida contigua lista desde next_to_flush
+   -------------------------------------------------------------------------- */
+// Escribe [from, to) al final de out con write(2): sin búfer de stdio, lo
+// que falla no queda pendiente para un fflush o fclose posterior. Si
+// falla a medias, recorta la salida a su largo antes del tramo (out_base
+// + from) para que otro volcado lo reescriba completo. 0, o -1 con errno.
+static int write_span(SharedMemory *mem, FILE *out, long long from, long long to) {
+    long long w = mem->reorder_size;
+    char *data = win_data(mem);
+    int fd = fileno(out);
+    for (long long s = from; s < to;) {
+        long long at = s % w;
+        long long n = to - s;
+        if (at + n > w) n = w - at; // la corrida da la vuelta a la ventana
+        ssize_t put = write(fd, data + at, (size_t)n);
+        if (put == -1 && errno == EINTR) continue;
+        if (put == -1) {
+            int err = errno;
+            perror("\nescritura de salida");
+            long long base = atomic_load(&mem->out_base);
+            if (s > from && base >= 0 && ftruncate(fd, (off_t)(base + from)) == -1)
+                perror("\nftruncate salida (tras un error de escritura)");
+            errno = err;
+            return -1;
+        }
+        s += put;
+    }
+    return 0;
+}
+
+// Vuelca lo contiguo desde next_to_flush mientras haya. 0, o -1 con errno
+// si la escritura falló: next_to_flush no avanza y el tramo queda en la
+// ventana para el próximo volcado.
+static int reorder_flush(SharedMemory *mem, FILE *out) {
+    static int self;
+    if (!self) self = (int)getpid();
+
+    for (;;) {
+        int unlocked = 0;
+        if (!atomic_compare_exchange_strong(&mem->flush_lock, &unlocked, self)) return 0;
+
+        long long start = atomic_load(&mem->next_to_flush);
+        long long end = ready_end(mem, start);
+
+        if (end > start) {
+            if (out) {
+                if (write_span(mem, out, start, end) == -1) {
+                    int err = errno;
+                    atomic_store(&mem->flush_lock, 0);
+                    errno = err;
+                    return -1;
+                }
+                stamps_record(mem, start, end);
+            }
+            bits_range(mem, start, end - start, 0); // antes de liberar esas posiciones
+            atomic_store(&mem->next_to_flush, end);
+            sync_notify(&mem->sync, SYNC_EV_WINDOW, INT_MAX);
+            if (sync_is_draining(&mem->sync)) sync_notify(&mem->sync, SYNC_EV_DRAIN, INT_MAX);
+        }
+        atomic_store(&mem->flush_lock, 0);
+
+        // Un depósito que llegó mientras se tenía el candado no pudo volcar:
+        // si completa la corrida, se vuelve a intentar.
+        if (ready_end(mem, end) == end) return 0;
+    }
+}
+
+/* --------------------------------------------------------------------------
+   Depósito (data == NULL: solo marca de completitud, out no se usa)
+   -------------------------------------------------------------------------- */
+int reorder_deposit(SharedMemory *mem, const char *data, int n, long long seq,
+                    long long enq_ns, FILE *out) {
+    long long w = mem->reorder_size;
+
+    // Un tramo entregado dos veces (recuperación de un proceso muerto)
+    // puede quedar ya volcado: esa parte se descarta
+    long long done = atomic_load(&mem->next_to_flush) - seq;
+    if (done >= n) return 0;
+    if (done > 0) {
+        if (data) data += done;
+        seq += done; n -= (int)done;
+    }
+
+    // Esperar solo si el depósito cae fuera de la ventana
+    while (seq + n - atomic_load(&mem->next_to_flush) > w) {
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_WINDOW);
+        if (seq + n - atomic_load(&mem->next_to_flush) <= w) {
+            sync_cancel(&mem->sync, SYNC_EV_WINDOW);
+            break;
+        }
+        if (sync_sleep(&mem->sync, SYNC_EV_WINDOW, snap) == -1) return -1;
+    }
+
+    if (data) {
+        // A lo sumo dos copias: antes y después de la vuelta de la ventana
+        char *dst = win_data(mem);
+        long long at = seq % w;
+        long long first = (at + n > w) ? w - at : n;
+        memcpy(dst + at, data, (size_t)first);
+        memcpy(dst, data + first, (size_t)(n - first));
+    } else {
+        out = NULL;
+    }
+    stamps_set(mem, seq, n, enq_ns);
+    bits_range(mem, seq, n, 1); // publica datos y marca
+
+    return reorder_flush(mem, out);
+}
+
+int reorder_complete(SharedMemory *mem, int n, long long seq) {
+    return reorder_deposit(mem, NULL, n, seq, 0, NULL);
+}
+
+int reorder_fits(SharedMemory *mem, int n, long long seq) {
+    return seq + n - atomic_load(&mem->next_to_flush) <= mem->reorder_size;
+}
+
+void reorder_release_dead(SharedMemory *mem, int pid, FILE *out) {
+    int owner = pid;
+    if (atomic_compare_exchange_strong(&mem->flush_lock, &owner, 0) || (out && owner == 0))
+        if (out || mem->output_mode != OUTPUT_APPEND) reorder_flush(mem, out);
+}
@@ -0,0 +1,65 @@
+#ifndef REORDER_H
+#define REORDER_H
+/*
+ =============================================================================
+  Archivo: reorder.h
+  Propósito:
+    Ventana de reordenamiento compartida para la escritura colaborativa del
+    archivo de salida. Reemplaza la espera por turno (seq == next_to_flush
+    con reintentos de 50 ms) del Receptor.
+
+  Resumen funcional:
+    - La ventana es un arreglo circular de reorder_size bytes ubicado en el
+      segmento después del buffer circular, indexado por seq % reorder_size.
+    - Un Receptor deposita sus bytes decodificados en la posición de su seq
+      sin esperar su turno; solo se bloquea si el seq queda más allá de la
+      ventana (next_to_flush + reorder_size).
+    - Quien deposita intenta tomar el candado de volcado: si lo obtiene,
+      escribe de una vez toda la corrida contigua lista desde next_to_flush
+      y avanza el contador (solo si la escritura terminó bien). Si otro receptor está volcando, éste vuelve a
+      revisar la ventana al soltar el candado, así que ningún depósito queda
+      sin escribir.
+    - En salida posicional los receptores escriben por su cuenta y solo
+      marcan rangos completos; la ventana se usa sin datos y next_to_flush
+      pasa a ser únicamente la marca de completitud.
+
+  Restricción de tamaño:
+    La ventana debe cubrir los seq que pueden estar "en vuelo" a la vez
+    (tramos reclamados por emisores + celdas del buffer + uno por receptor);
+    si es más chica, los receptores pueden quedar esperando espacio en la
+    ventana mientras el seq faltante sigue sin publicarse. Como los
+    Emisores reservan ranuras en orden de seq (next_claim, ver ring.c),
+    un Emisor rezagado no puede quedar detrás de un anillo lleno de seq
+    posteriores.
+ =============================================================================
+*/
+#include <stdio.h>
+#include "shared.h"
+
+// Bytes de segmento que ocupa una ventana de w posiciones
+size_t reorder_bytes(long long w);
+
+// Ubica la ventana en el desplazamiento offset del segmento y la deja vacía
+void reorder_init(SharedMemory *mem, size_t offset, long long w);
+
+// Deposita n bytes ya decodificados que corresponden a seq..seq+n-1 y vuelca
+// en out lo que quede contiguo. enq_ns es la marca de encolado del tramo:
+// al volcarlo se registra enq→disco en mem->lat[LAT_DISK].
+// 0 en éxito, -1 con errno (EIDRM = cierre; otro = falló la escritura de
+// la salida: el depósito sigue en la ventana y next_to_flush no avanza).
+int reorder_deposit(SharedMemory *mem, const char *data, int n, long long seq,
+                    long long enq_ns, FILE *out);
+
+// Marca seq..seq+n-1 como ya persistidos por el llamador (salida posicional):
+// la ventana solo avanza la marca de completitud next_to_flush, sin datos.
+int reorder_complete(SharedMemory *mem, int n, long long seq);
+
+// 1 si seq..seq+n-1 cabe ya en la ventana (un depósito no esperaría)
+int reorder_fits(SharedMemory *mem, int n, long long seq);
+
+// Suelta el candado de volcado si lo tiene el proceso muerto pid y vuelca
+// lo pendiente. Sin out (quien no es Receptor) en salida append solo
+// suelta el candado: el próximo depósito vuelca.
+void reorder_release_dead(SharedMemory *mem, int pid, FILE *out);
+
+#endif
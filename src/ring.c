@@ -0,0 +1,770 @@
+/*
+ ============================================================================
+ Archivo: ring.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Implementación del buffer circular compartido en sus dos modos:
+      - Semáforos (compatibilidad): triple mutex/empty/full.
+      - Lock-free: cola MPMC acotada con un número de turno por ranura.
+    Ambos trabajan sobre ranuras, cuya forma depende de mem->layout; la
+    distribución de registros (LAYOUT_RECORD) es un anillo de bytes propio,
+    al final del archivo.
+    Las ranuras se reparten en mem->shards fragmentos contiguos; cada uno
+    es un anillo independiente (RingShard) sobre [base, base + slots), con
+    slots potencia de dos: la ranura de la posición p es base + (p & mask),
+    sin divisiones en el camino de datos.
+
+    Protocolo lock-free (por ranura, con p = posición global reclamada):
+      turn == p           -> ranura libre para el emisor que reclame p
+      turn == p + 1       -> ranura publicada, lista para el receptor de p
+      turn == p + slots   -> ranura liberada para la siguiente vuelta
+    (p y slots relativos al fragmento). Emisores reclaman write_index y
+    receptores read_index del fragmento con CAS. Cuando el fragmento está
+    lleno el emisor se anota en SYNC_EV_SPACE + k; cuando no hay datos en
+    ningún fragmento el receptor se anota en SYNC_EV_DATA (compartido, ya
+    que puede robar de cualquiera). Tras anotarse vuelve a intentar y
+    recién entonces duerme en la palabra futex. El lado contrario solo
+    hace FUTEX_WAKE si ve a alguien anotado, por lo que sin contención no
+    se entra al kernel.
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include "ring.h"
+#include "latency.h"
+
+/* --------------------------------------------------------------------------
+   Acceso a las ranuras
+   Una ranura es la unidad de reserva del anillo: en LAYOUT_TRACE es una
+   celda SharedChar (1 byte con sus metadatos) y en LAYOUT_COMPACT es un
+   tramo de hasta slot_bytes bytes en arreglos separados (ver shared.h):
+     turn[slots] | seq[slots] | ts[slots] | ns[slots] | len[slots] |
+     data[slots*slot_bytes]
+   (ts = hora de pared para la consola, ns = CLOCK_MONOTONIC al encolar)
+   -------------------------------------------------------------------------- */
+static _Atomic unsigned long long *c_turn(SharedMemory *mem) {
+    return (_Atomic unsigned long long *)((char *)mem + mem->slots_offset);
+}
+static long long *c_seq(SharedMemory *mem) {
+    return (long long *)(c_turn(mem) + mem->slots);
+}
+static time_t *c_ts(SharedMemory *mem) {
+    return (time_t *)(c_seq(mem) + mem->slots);
+}
+static long long *c_ns(SharedMemory *mem) {
+    return (long long *)(c_ts(mem) + mem->slots);
+}
+static int *c_len(SharedMemory *mem) {
+    return (int *)(c_ns(mem) + mem->slots);
+}
+static char *c_data(SharedMemory *mem) {
+    return (char *)(c_len(mem) + mem->slots);
+}
+
+static _Atomic unsigned long long *slot_turn(SharedMemory *mem, long long s) {
+    if (mem->layout == LAYOUT_TRACE) return &mem->buffer[s].turn;
+    return &c_turn(mem)[s];
+}
+
+// Ranura física de la posición monotónica p del fragmento
+static long long slot_at(const RingShard *sh, unsigned long long p) {
+    return sh->base + (long long)(p & sh->mask);
+}
+
+// Copia n bytes (n <= slot_bytes) codificándolos con codec (NULL = sin codificar)
+static void slot_store(SharedMemory *mem, long long s, const char *data, int n, long long seq,
+                       time_t ts, long long enq_ns, const Codec *codec) {
+    if (mem->layout == LAYOUT_TRACE) {
+        SharedChar *cell = &mem->buffer[s];
+        cell->ascii     = codec ? (char)((unsigned char)data[0] ^ codec_key_at(codec, seq)) : data[0];
+        cell->index     = s;
+        cell->timestamp = ts;
+        cell->enq_ns    = enq_ns;
+        cell->seq       = seq;
+        cell->is_full   = 1;
+        return;
+    }
+    char *dst = c_data(mem) + (size_t)s * (size_t)mem->slot_bytes;
+    if (codec) codec_apply(codec, dst, data, (size_t)n, seq);
+    else memcpy(dst, data, (size_t)n);
+    c_seq(mem)[s] = seq;
+    c_ts(mem)[s]  = ts;
+    c_ns(mem)[s]  = enq_ns;
+    c_len(mem)[s] = n;
+}
+
+static void slot_load(SharedMemory *mem, long long s, RingChunk *out) {
+    if (mem->layout == LAYOUT_TRACE) {
+        SharedChar *cell = &mem->buffer[s];
+        out->data[0]   = cell->ascii;
+        out->len       = 1;
+        out->index     = cell->index;
+        out->timestamp = cell->timestamp;
+        out->enq_ns    = cell->enq_ns;
+        out->seq       = cell->seq;
+        cell->is_full  = 0;
+        return;
+    }
+    int n = c_len(mem)[s];
+    memcpy(out->data, c_data(mem) + (size_t)s * (size_t)mem->slot_bytes, (size_t)n);
+    out->len       = n;
+    out->index     = s * mem->slot_bytes; // derivado de la posición
+    out->timestamp = c_ts(mem)[s];
+    out->enq_ns    = c_ns(mem)[s];
+    out->seq       = c_seq(mem)[s];
+}
+
+/* --------------------------------------------------------------------------
+   Inicialización
+   -------------------------------------------------------------------------- */
+static size_t slots_offset(void) {
+    return (sizeof(SharedMemory) + 63) & ~(size_t)63;
+}
+
+// Mayor potencia de dos <= n (0 si n < 1)
+static long long pow2_floor(long long n) {
+    long long p = 1;
+    if (n < 1) return 0;
+    while (p <= n / 2) p *= 2;
+    return p;
+}
+
+// Un anillo de registros de potencia de dos >= 16 deja medio anillo menos
+// un encabezado alineado a 8
+long long ring_shard_slots(long long size, int layout, int slot_bytes, int shards) {
+    if (layout == LAYOUT_RECORD) return pow2_floor(size);
+    if (layout != LAYOUT_COMPACT) slot_bytes = 1;
+    return pow2_floor(size / slot_bytes / shards);
+}
+
+size_t ring_bytes(long long size, int layout, int slot_bytes, int shards) {
+    size_t slots = (size_t)ring_shard_slots(size, layout, slot_bytes, shards);
+    if (layout == LAYOUT_RECORD) return slots_offset() + slots;
+    slots *= (size_t)shards;
+    if (layout == LAYOUT_TRACE) return sizeof(SharedMemory) + slots * sizeof(SharedChar);
+    size_t per_slot = sizeof(unsigned long long) + sizeof(long long) + sizeof(time_t) + sizeof(long long) + sizeof(int);
+    return slots_offset() + slots * per_slot + slots * (size_t)slot_bytes;
+}
+
+void ring_init(SharedMemory *mem, long long size, int ring_mode, int layout, int slot_bytes, int shards) {
+    long long per_shard = ring_shard_slots(size, layout, slot_bytes, shards);
+    mem->size = size;
+    mem->ring_mode = ring_mode;
+    mem->layout = layout;
+    mem->slot_bytes = (layout == LAYOUT_COMPACT) ? slot_bytes : 1;
+    mem->slots = per_shard * shards;
+    mem->slots_offset = (layout == LAYOUT_TRACE) ? 0 : slots_offset();
+    mem->shards = shards;
+
+    long long base = 0;
+    for (int k = 0; k < shards; k++) {
+        RingShard *sh = &mem->shard[k];
+        sh->base = base;
+        sh->slots = per_shard;
+        sh->mask = (unsigned long long)per_shard - 1;
+        atomic_store(&sh->write_index, 0);
+        atomic_store(&sh->read_index, 0);
+        sh->count = 0;
+        atomic_store(&sh->steals, 0);
+        atomic_store(&sh->free_index, 0);
+        if (layout == LAYOUT_RECORD) { base += sh->slots; continue; } // sin turnos
+        for (long long i = 0; i < sh->slots; i++) {
+            long long s = base + i;
+            if (layout == LAYOUT_TRACE) mem->buffer[s].is_full = 0;
+            else c_len(mem)[s] = 0;
+            atomic_store(slot_turn(mem, s), (unsigned long long)i);
+        }
+        base += sh->slots;
+    }
+}
+
+long long ring_shard_count(SharedMemory *mem, int k) {
+    RingShard *sh = &mem->shard[k];
+    if (mem->ring_mode == RING_MODE_SEM) return sh->count;
+    unsigned long long w = atomic_load(&sh->write_index);
+    unsigned long long r = atomic_load((mem->layout == LAYOUT_RECORD) ? &sh->free_index : &sh->read_index);
+    return (w > r) ? (long long)(w - r) : 0;
+}
+
+long long ring_count(SharedMemory *mem) {
+    long long total = 0;
+    for (int k = 0; k < mem->shards; k++) total += ring_shard_count(mem, k);
+    return total;
+}
+
+/* --------------------------------------------------------------------------
+   Arriendo del proceso (recover.h)
+   El anillo anota en la entrada del proceso lo que reclama: el Emisor la
+   posición reservada y aún sin publicar, el Receptor los tramos extraídos.
+   Si muere, otro proceso lo completa a partir de esa anotación.
+   -------------------------------------------------------------------------- */
+static ProcEntry *owner;
+
+void ring_set_owner(ProcEntry *self) {
+    owner = self;
+}
+
+static void lease_claim(int shard, unsigned long long pos, long long seq, int len) {
+    if (!owner) return;
+    owner->lease_pos_shard = shard;
+    owner->lease_pos_seq = seq;
+    owner->lease_pos_len = len;
+    atomic_store_explicit(&owner->lease_pos, pos + 1, memory_order_release);
+}
+
+// Publicado: lease_pos_seq queda como el seq hasta el que se publicó
+static void lease_claim_done(void) {
+    if (!owner) return;
+    atomic_store_explicit(&owner->lease_pos, 0, memory_order_release);
+    owner->lease_pos_seq += owner->lease_pos_len;
+    owner->lease_pos_len = 0;
+}
+
+static void lease_tokens(int k) {
+    if (owner) atomic_store_explicit(&owner->lease_tokens, k, memory_order_release);
+}
+
+// Tramos recién extraídos: quedan en mano hasta que el Receptor los persiste
+static void lease_chunks(const RingChunk *out, int k) {
+    if (!owner) return;
+    for (int i = 0; i < k; i++) owner->lease[i] = (SeqRange){ out[i].seq, out[i].len };
+    atomic_store_explicit(&owner->lease_n, k, memory_order_release);
+}
+
+/* --------------------------------------------------------------------------
+   Modo lock-free: intentos sin bloqueo
+   Devuelven 1 si lograron la operación y 0 si el anillo está lleno/vacío.
+   lf_try_claim reclama k posiciones contiguas cuando la primera está libre;
+   el llamador espera luego el turno de cada una antes de escribirla.
+   -------------------------------------------------------------------------- */
+static int lf_try_claim(SharedMemory *mem, RingShard *sh, int k, unsigned long long *pos_out) {
+    unsigned long long pos = atomic_load_explicit(&sh->write_index, memory_order_relaxed);
+    for (;;) {
+        _Atomic unsigned long long *t = slot_turn(mem, slot_at(sh, pos));
+        unsigned long long turn = atomic_load_explicit(t, memory_order_acquire);
+        long long diff = (long long)(turn - pos);
+
+        if (diff == 0) {
+            // Ranura libre: intentar reclamar k posiciones de una vez
+            if (atomic_compare_exchange_weak_explicit(&sh->write_index, &pos, pos + (unsigned long long)k,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *pos_out = pos;
+                return 1;
+            }
+            // CAS fallido: pos ya quedó actualizado con el valor vigente
+        } else if (diff < 0) {
+            return 0; // la ranura aún no fue liberada: fragmento lleno
+        } else {
+            pos = atomic_load_explicit(&sh->write_index, memory_order_relaxed);
+        }
+    }
+}
+
+// Toma de una vez la corrida de hasta max ranuras publicadas desde
+// read_index con un solo CAS; devuelve cuántas (0 = fragmento vacío).
+// Las ranuras de la corrida ya tienen turno pos + 1 y nadie más puede
+// cambiarlo hasta que alguien gane read_index, así que tras el CAS son
+// todas del llamador.
+static int lf_try_pop(SharedMemory *mem, RingShard *sh, RingChunk *out, int max) {
+    unsigned long long slots = (unsigned long long)sh->slots;
+    unsigned long long pos = atomic_load_explicit(&sh->read_index, memory_order_relaxed);
+    if ((unsigned long long)max > slots) max = (int)slots;
+    for (;;) {
+        _Atomic unsigned long long *t = slot_turn(mem, slot_at(sh, pos));
+        unsigned long long turn = atomic_load_explicit(t, memory_order_acquire);
+        long long diff = (long long)(turn - (pos + 1));
+
+        if (diff == 0) {
+            int k = 1;
+            while (k < max) {
+                unsigned long long p = pos + (unsigned long long)k;
+                t = slot_turn(mem, slot_at(sh, p));
+                if (atomic_load_explicit(t, memory_order_acquire) != p + 1) break;
+                k++;
+            }
+            if (atomic_compare_exchange_weak_explicit(&sh->read_index, &pos, pos + (unsigned long long)k,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                for (int i = 0; i < k; i++) {
+                    unsigned long long p = pos + (unsigned long long)i;
+                    long long s = slot_at(sh, p);
+                    slot_load(mem, s, &out[i]);
+                    atomic_store_explicit(slot_turn(mem, s), p + slots, memory_order_release);
+                }
+                lease_chunks(out, k);
+                return k;
+            }
+        } else if (diff < 0) {
+            return 0; // nadie ha publicado esta posición: fragmento vacío
+        } else {
+            pos = atomic_load_explicit(&sh->read_index, memory_order_relaxed);
+        }
+    }
+}
+
+// Extrae del fragmento hogar; si está vacío, roba del más lleno de los
+// demás (y si ése ya se vació, de cualquiera que tenga datos). Devuelve el
+// fragmento usado (con *got ranuras) o -1 si no encontró datos.
+static int lf_try_pop_any(SharedMemory *mem, int home, RingChunk *out, int max, int *got) {
+    if ((*got = lf_try_pop(mem, &mem->shard[home], out, max)) > 0) return home;
+    if (mem->shards == 1) return -1;
+
+    int victim = -1;
+    long long best = 0;
+    for (int k = 0; k < mem->shards; k++) {
+        if (k == home) continue;
+        long long n = ring_shard_count(mem, k);
+        if (n > best) { best = n; victim = k; }
+    }
+    if (victim < 0) return -1;
+    if ((*got = lf_try_pop(mem, &mem->shard[victim], out, max)) == 0) {
+        int k = 0;
+        for (; k < mem->shards; k++)
+            if (k != home && k != victim && (*got = lf_try_pop(mem, &mem->shard[k], out, max)) > 0) break;
+        if (k == mem->shards) return -1;
+        victim = k;
+    }
+    atomic_fetch_add_explicit(&mem->shard[victim].steals, (unsigned long long)*got, memory_order_relaxed);
+    return victim;
+}
+
+// Ranuras que ocupa el próximo tramo de n bytes (nunca más que el fragmento)
+static int piece_slots(SharedMemory *mem, RingShard *sh, int n) {
+    int k = (n + mem->slot_bytes - 1) / mem->slot_bytes;
+    return (k < sh->slots) ? k : (int)sh->slots;
+}
+
+/* --------------------------------------------------------------------------
+   Orden de reclamo
+   next_pos reparte los seq, pero un Emisor puede quedar rezagado (lectura
+   lenta, o perder siempre el CAS del reclamo) mientras los demás llenan el
+   anillo con seq posteriores. Si esos seq ya no caben en la ventana de
+   reordenamiento, los Receptores se bloquean con sus tramos en la mano, el
+   anillo no se vacía y el seq faltante nunca entra: interbloqueo. Por eso
+   cada tramo espera su turno (next_claim == seq) solo para reservar sus
+   ranuras; la copia y la codificación siguen siendo concurrentes.
+   -------------------------------------------------------------------------- */
+static int claim_order_wait(SharedMemory *mem, long long seq) {
+    while (atomic_load_explicit(&mem->next_claim, memory_order_acquire) != seq) {
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_CLAIM);
+        if (atomic_load_explicit(&mem->next_claim, memory_order_acquire) == seq) {
+            sync_cancel(&mem->sync, SYNC_EV_CLAIM);
+            break;
+        }
+        if (sync_sleep(&mem->sync, SYNC_EV_CLAIM, snap) == -1) return -1;
+    }
+    return 0;
+}
+
+// Cede el turno al tramo que empieza en next (todos despiertan: solo uno
+// tiene ese seq)
+static void claim_order_pass(SharedMemory *mem, long long next) {
+    atomic_store_explicit(&mem->next_claim, next, memory_order_release);
+    sync_notify(&mem->sync, SYNC_EV_CLAIM, INT_MAX);
+}
+
+/* --------------------------------------------------------------------------
+   Modo lock-free: espera con timbre
+   Se anota como durmiente, reintenta (para no perder un aviso que llegó
+   antes de anotarse) y solo entonces duerme en el evento.
+   -------------------------------------------------------------------------- */
+static int lf_push_range(SharedMemory *mem, int shard, const char *data, int n, long long seq,
+                         time_t ts, long long enq_ns, const Codec *codec, long long *first_index, int ordered) {
+    if (sync_is_shutdown(&mem->sync)) { errno = EIDRM; return -1; }
+    RingShard *sh = &mem->shard[shard];
+    int space = SYNC_EV_SPACE + shard;
+    int first = 1;
+    if (ordered && claim_order_wait(mem, seq) == -1) return -1;
+
+    while (n > 0) {
+        int k = piece_slots(mem, sh, n);
+        unsigned long long pos;
+        while (!lf_try_claim(mem, sh, k, &pos)) {
+            unsigned snap = sync_prepare(&mem->sync, space);
+            if (lf_try_claim(mem, sh, k, &pos)) { sync_cancel(&mem->sync, space); break; }
+            if (sync_sleep(&mem->sync, space, snap) == -1) return -1;
+        }
+        lease_claim(shard, pos, seq, ((long long)k * mem->slot_bytes < n) ? k * mem->slot_bytes : n);
+        if (ordered && (long long)k * mem->slot_bytes >= n) claim_order_pass(mem, seq + n);
+        if (first) { *first_index = slot_at(sh, pos) * mem->slot_bytes; first = 0; }
+
+        // Las ranuras siguientes a la primera pueden seguir ocupadas por
+        // receptores de la vuelta anterior: se espera cada una por su turno.
+        int bytes = 0;
+        for (int i = 0; i < k; i++) {
+            unsigned long long p = pos + (unsigned long long)i;
+            long long s = slot_at(sh, p);
+            _Atomic unsigned long long *t = slot_turn(mem, s);
+            while (atomic_load_explicit(t, memory_order_acquire) != p) {
+                sync_notify(&mem->sync, SYNC_EV_DATA, INT_MAX); // lo ya publicado debe drenarse
+                unsigned snap = sync_prepare(&mem->sync, space);
+                if (atomic_load_explicit(t, memory_order_acquire) == p) {
+                    sync_cancel(&mem->sync, space);
+                    break;
+                }
+                if (sync_sleep(&mem->sync, space, snap) == -1) return -1;
+            }
+            int len = (n - bytes < mem->slot_bytes) ? n - bytes : mem->slot_bytes;
+            slot_store(mem, s, data + bytes, len, seq + bytes, ts, enq_ns, codec);
+            atomic_store_explicit(t, p + 1, memory_order_release);
+            bytes += len;
+        }
+
+        lease_claim_done();
+        sync_notify(&mem->sync, SYNC_EV_DATA, k);
+        data += bytes; seq += bytes; n -= bytes;
+    }
+    return 0;
+}
+
+static int lf_pop(SharedMemory *mem, int home, RingChunk *out, int max) {
+    if (sync_is_shutdown(&mem->sync)) { errno = EIDRM; return -1; }
+    int from, got;
+    while ((from = lf_try_pop_any(mem, home, out, max, &got)) < 0) {
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_DATA);
+        if ((from = lf_try_pop_any(mem, home, out, max, &got)) >= 0) { sync_cancel(&mem->sync, SYNC_EV_DATA); break; }
+        if (sync_sleep(&mem->sync, SYNC_EV_DATA, snap) == -1) return -1;
+    }
+    // En el evento de espacio duermen emisores que esperan ranuras distintas
+    // (la del reclamo o la de un turno dentro de su rango): se despierta a
+    // todos para que el dueño de la ranura liberada no se pierda el aviso.
+    // Un solo aviso por lote.
+    sync_notify(&mem->sync, SYNC_EV_SPACE + from, INT_MAX);
+    return got;
+}
+
+/* --------------------------------------------------------------------------
+   Modo semáforos (compatibilidad; semop o futex según sync.mode)
+   empty/full cuentan ranuras. Un único fragmento (el Inicializador no
+   permite fragmentar este modo): se usa shard[0].
+   -------------------------------------------------------------------------- */
+static int sem_push_range(SharedMemory *mem, int sem_id, const char *data, int n, long long seq,
+                          time_t ts, long long enq_ns, const Codec *codec, long long *first_index, int ordered) {
+    RingShard *sh = &mem->shard[0];
+    int first = 1;
+    if (ordered && claim_order_wait(mem, seq) == -1) return -1;
+    while (n > 0) {
+        // Un rango nunca pide más ranuras que las del buffer
+        int k = piece_slots(mem, sh, n);
+        if (sync_wait(&mem->sync, sem_id, SEM_EMPTY, k) == -1) return -1; // empty -= k
+        lease_tokens(k);
+        if (sync_wait(&mem->sync, sem_id, SEM_MUTEX, 1) == -1) return -1; // mutex--
+        lease_tokens(0);
+
+        // Inserción segura de las k ranuras consecutivas
+        unsigned long long pos = atomic_load_explicit(&sh->write_index, memory_order_relaxed);
+        if (first) { *first_index = slot_at(sh, pos) * mem->slot_bytes; first = 0; }
+        int bytes = 0;
+        for (int i = 0; i < k; i++) {
+            int len = (n - bytes < mem->slot_bytes) ? n - bytes : mem->slot_bytes;
+            slot_store(mem, slot_at(sh, pos + (unsigned long long)i), data + bytes, len,
+                       seq + bytes, ts, enq_ns, codec);
+            bytes += len;
+        }
+
+        atomic_store_explicit(&sh->write_index, pos + (unsigned long long)k, memory_order_relaxed);
+        sh->count += k;
+        if (ordered && bytes == n) claim_order_pass(mem, seq + n);
+
+        if (sync_post(&mem->sync, sem_id, SEM_MUTEX, 1) == -1) return -1; // mutex++
+        if (sync_post(&mem->sync, sem_id, SEM_FULL, k) == -1) return -1;  // full += k
+        data += bytes; seq += bytes; n -= bytes;
+    }
+    return 0;
+}
+
+// Lote: si count sugiere que hay más de una ranura llena se intenta tomar
+// todo el lote con un solo full -= k sin espera; si no alcanza (otro
+// receptor se adelantó) se cae al full-- bloqueante de siempre. Luego una
+// sola sección crítica mueve las k ranuras, read_index y count.
+static int sem_pop(SharedMemory *mem, int sem_id, RingChunk *out, int max) {
+    RingShard *sh = &mem->shard[0];
+    int k = (sh->count < max) ? (int)sh->count : max; // pista sin mutex
+    int rc = (k > 1) ? sync_trywait(&mem->sync, sem_id, SEM_FULL, k) : 0;
+    if (rc == -1) return -1;
+    if (rc == 0) {
+        k = 1;
+        if (sync_wait(&mem->sync, sem_id, SEM_FULL, 1) == -1) return -1;  // full--
+    }
+    lease_tokens(k);
+    if (sync_wait(&mem->sync, sem_id, SEM_MUTEX, 1) == -1) return -1; // mutex--
+    lease_tokens(0);
+
+    unsigned long long pos = atomic_load_explicit(&sh->read_index, memory_order_relaxed);
+    for (int i = 0; i < k; i++) // libera las ranuras
+        slot_load(mem, slot_at(sh, pos + (unsigned long long)i), &out[i]);
+    atomic_store_explicit(&sh->read_index, pos + (unsigned long long)k, memory_order_relaxed); // Avance circular
+    sh->count = (sh->count > k) ? sh->count - k : 0; // Decrementar contador
+    lease_chunks(out, k);
+
+    if (sync_post(&mem->sync, sem_id, SEM_MUTEX, 1) == -1) return -1; // mutex++
+    if (sync_post(&mem->sync, sem_id, SEM_EMPTY, k) == -1) return -1; // empty += k
+    return k;
+}
+
+/* --------------------------------------------------------------------------
+   Interfaz pública
+   -------------------------------------------------------------------------- */
+int ring_push_range(SharedMemory *mem, int sem_id, int shard, const char *data, int n, long long seq,
+                    time_t ts, long long enq_ns, const Codec *codec, long long *first_index) {
+    if (mem->layout == LAYOUT_RECORD) { errno = ENOTSUP; return -1; } // ring_reserve
+    if (mem->ring_mode == RING_MODE_LOCKFREE)
+        return lf_push_range(mem, shard % mem->shards, data, n, seq, ts, enq_ns, codec, first_index, 1);
+    return sem_push_range(mem, sem_id, data, n, seq, ts, enq_ns, codec, first_index, 1);
+}
+
+// Sin orden de reclamo: los seq de quien llama no tienen por qué ser
+// consecutivos entre procesos (bench_sync publica seq 0)
+int ring_push(SharedMemory *mem, int sem_id, SharedChar *sc) {
+    if (mem->ring_mode == RING_MODE_LOCKFREE)
+        return lf_push_range(mem, 0, &sc->ascii, 1, sc->seq, sc->timestamp, sc->enq_ns, NULL, &sc->index, 0);
+    return sem_push_range(mem, sem_id, &sc->ascii, 1, sc->seq, sc->timestamp, sc->enq_ns, NULL, &sc->index, 0);
+}
+
+int ring_pop_batch(SharedMemory *mem, int sem_id, int shard, RingChunk *out, int max) {
+    if (mem->layout == LAYOUT_RECORD) { errno = ENOTSUP; return -1; } // ring_peek
+    if (max < 1) max = 1;
+    if (mem->ring_mode == RING_MODE_LOCKFREE) return lf_pop(mem, shard % mem->shards, out, max);
+    return sem_pop(mem, sem_id, out, max);
+}
+
+int ring_pop_chunk(SharedMemory *mem, int sem_id, int shard, RingChunk *out) {
+    return (ring_pop_batch(mem, sem_id, shard, out, 1) == -1) ? -1 : 0;
+}
+
+int ring_pop(SharedMemory *mem, int sem_id, SharedChar *out) {
+    RingChunk c = { .data = &out->ascii };
+    if (ring_pop_chunk(mem, sem_id, 0, &c) == -1) return -1;
+    out->index     = c.index;
+    out->timestamp = c.timestamp;
+    out->enq_ns    = c.enq_ns;
+    out->seq       = c.seq;
+    out->is_full   = 1;
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+   Registros de largo variable (LAYOUT_RECORD)
+   Un solo fragmento: shard[0].write_index/read_index/free_index son bytes
+   monotónicos y el anillo ocupa slots bytes desde slots_offset. Una
+   posición p con menos de RECORD_HDR bytes hasta el final del anillo nunca
+   lleva encabezado: Emisores, Receptores y la liberación la saltan igual.
+   Los encabezados los escribe el Emisor con el turno antes de publicar
+   write_index, así que nadie lee un encabezado viejo dentro de
+   [read_index, write_index).
+   -------------------------------------------------------------------------- */
+static RecordHeader *rec_at(SharedMemory *mem, unsigned long long pos) {
+    return (RecordHeader *)((char *)mem + mem->slots_offset + (pos & mem->shard[0].mask));
+}
+
+static unsigned long long rec_total(int len) {
+    return (unsigned long long)RECORD_HDR + (((unsigned long long)len + 7) & ~7ULL);
+}
+
+// Bytes hasta el final del anillo si p no admite encabezado; si no, 0
+static unsigned long long rec_tail_gap(SharedMemory *mem, unsigned long long p) {
+    unsigned long long left = (unsigned long long)mem->slots - (p & mem->shard[0].mask);
+    return (left < (unsigned long long)RECORD_HDR) ? left : 0;
+}
+
+int ring_record_max(const SharedMemory *mem) {
+    long long max = mem->slots / 2 - RECORD_HDR;
+    return (max < (1LL << 30)) ? (int)max : (1 << 30); // len es int
+}
+
+int ring_reserve(SharedMemory *mem, int n, long long seq, RingRecord *r) {
+    if (sync_is_shutdown(&mem->sync)) { errno = EIDRM; return -1; }
+    if (n < 1 || n > ring_record_max(mem)) { errno = EMSGSIZE; return -1; }
+    if (claim_order_wait(mem, seq) == -1) return -1;
+
+    // Con el turno, este Emisor es el único que mueve write_index
+    RingShard *sh = &mem->shard[0];
+    unsigned long long cap = (unsigned long long)mem->slots;
+    unsigned long long head = atomic_load_explicit(&sh->write_index, memory_order_relaxed);
+    unsigned long long total = rec_total(n);
+    unsigned long long off = head & sh->mask;
+    unsigned long long pad = (off + total > cap) ? cap - off : 0;
+
+    while (head + pad + total - atomic_load(&sh->free_index) > cap) {
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_SPACE);
+        if (head + pad + total - atomic_load(&sh->free_index) <= cap) {
+            sync_cancel(&mem->sync, SYNC_EV_SPACE);
+            break;
+        }
+        if (sync_sleep(&mem->sync, SYNC_EV_SPACE, snap) == -1) return -1;
+    }
+
+    if (pad >= (unsigned long long)RECORD_HDR) {
+        RecordHeader *p = rec_at(mem, head);
+        p->len = (int)pad;
+        atomic_store_explicit(&p->state, REC_PAD, memory_order_relaxed);
+    }
+    RecordHeader *h = rec_at(mem, head + pad);
+    h->len = n;
+    h->seq = seq;
+    atomic_store_explicit(&h->state, REC_RESERVED, memory_order_relaxed);
+    atomic_store_explicit(&sh->write_index, head + pad + total, memory_order_release);
+    lease_claim(0, head + pad, seq, n);
+    claim_order_pass(mem, seq + n);
+
+    r->pos   = head + pad;
+    r->data  = (char *)(h + 1);
+    r->len   = n;
+    r->seq   = seq;
+    r->index = (long long)((head + pad) & sh->mask) + RECORD_HDR;
+    return 0;
+}
+
+void ring_commit(SharedMemory *mem, RingRecord *r, time_t ts, long long enq_ns) {
+    RecordHeader *h = rec_at(mem, r->pos);
+    h->timestamp = r->timestamp = ts;
+    h->enq_ns = r->enq_ns = enq_ns;
+    atomic_store_explicit(&h->state, REC_COMMITTED, memory_order_release);
+    lease_claim_done();
+    sync_notify(&mem->sync, SYNC_EV_DATA, 1);
+}
+
+int ring_peek(SharedMemory *mem, RingRecord *r) {
+    RingShard *sh = &mem->shard[0];
+    for (;;) {
+        if (sync_is_shutdown(&mem->sync)) { errno = EIDRM; return -1; }
+        unsigned long long tail = atomic_load_explicit(&sh->read_index, memory_order_acquire);
+        unsigned long long head = atomic_load_explicit(&sh->write_index, memory_order_acquire);
+
+        int state = 0;
+        RecordHeader *h = NULL;
+        if (tail != head) {
+            unsigned long long gap = rec_tail_gap(mem, tail);
+            if (gap) {
+                atomic_compare_exchange_strong(&sh->read_index, &tail, tail + gap);
+                continue;
+            }
+            h = rec_at(mem, tail);
+            state = atomic_load_explicit(&h->state, memory_order_acquire);
+            if (state == REC_PAD) {
+                atomic_compare_exchange_strong(&sh->read_index, &tail, tail + (unsigned long long)h->len);
+                continue;
+            }
+            if (state == REC_COMMITTED) {
+                int len = h->len;
+                if (!atomic_compare_exchange_strong(&sh->read_index, &tail, tail + rec_total(len))) continue;
+                r->pos       = tail;
+                r->data      = (char *)(h + 1);
+                r->len       = len;
+                r->seq       = h->seq;
+                r->timestamp = h->timestamp;
+                r->enq_ns    = h->enq_ns;
+                r->index     = (long long)(tail & sh->mask) + RECORD_HDR;
+                lease_chunks(&(RingChunk){ .seq = r->seq, .len = len }, 1);
+                lease_claim(0, tail, r->seq, len);
+                return 0;
+            }
+            if (state != REC_RESERVED) continue; // otro Receptor ya lo tomó
+        }
+
+        // Vacío, o el registro siguiente aún no se confirma
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_DATA);
+        if (atomic_load(&sh->read_index) != tail || atomic_load(&sh->write_index) != head ||
+            (h && atomic_load(&h->state) != state)) {
+            sync_cancel(&mem->sync, SYNC_EV_DATA);
+            continue;
+        }
+        if (sync_sleep(&mem->sync, SYNC_EV_DATA, snap) == -1) return -1;
+    }
+}
+
+static void rec_release(SharedMemory *mem, unsigned long long pos) {
+    RingShard *sh = &mem->shard[0];
+    atomic_store(&rec_at(mem, pos)->state, REC_RELEASED);
+
+    // Avanzar free_index sobre la corrida liberada. Quien marca y luego no
+    // logra avanzar (porque falta uno anterior) deja el avance al que
+    // libere ese anterior: ambos usan seq_cst, alguno ve la marca del otro.
+    int moved = 0;
+    for (;;) {
+        unsigned long long f = atomic_load(&sh->free_index);
+        if (f == atomic_load(&sh->read_index)) break;
+        unsigned long long step = rec_tail_gap(mem, f);
+        if (!step) {
+            RecordHeader *h = rec_at(mem, f);
+            int state = atomic_load(&h->state);
+            if (state == REC_RELEASED)  step = rec_total(h->len);
+            else if (state == REC_PAD)  step = (unsigned long long)h->len;
+            else break;
+        }
+        if (atomic_compare_exchange_strong(&sh->free_index, &f, f + step)) moved = 1;
+    }
+    if (moved) sync_notify(&mem->sync, SYNC_EV_SPACE, INT_MAX);
+}
+
+void ring_release(SharedMemory *mem, const RingRecord *r) {
+    rec_release(mem, r->pos);
+    lease_claim_done();
+}
+
+/* --------------------------------------------------------------------------
+   Recuperación de arriendos (recover.c)
+   Solo la llama quien ganó e->reaper, con el proceso dueño ya muerto: nadie
+   más toca esas posiciones. Una ranura reclamada y sin publicar sigue con
+   turn == p (nadie más la escribe); un registro reservado, en REC_RESERVED.
+   -------------------------------------------------------------------------- */
+int ring_repair(SharedMemory *mem, ProcEntry *dead, const char *data, const Codec *codec) {
+    unsigned long long lp = atomic_load_explicit(&dead->lease_pos, memory_order_acquire);
+    if (lp == 0 || dead->role != ROLE_EMITTER) return 0;
+    unsigned long long pos = lp - 1;
+    long long seq = dead->lease_pos_seq;
+    int n = dead->lease_pos_len;
+    time_t ts = time(NULL);
+    long long now = lat_now();
+
+    if (mem->layout == LAYOUT_RECORD) {
+        RecordHeader *h = rec_at(mem, pos);
+        if (atomic_load(&h->state) == REC_RESERVED && h->seq == seq) {
+            if (codec) codec_apply(codec, (char *)(h + 1), data, (size_t)n, seq);
+            else memcpy(h + 1, data, (size_t)n);
+            h->timestamp = ts;
+            h->enq_ns = now;
+            atomic_store_explicit(&h->state, REC_COMMITTED, memory_order_release);
+        }
+    } else {
+        RingShard *sh = &mem->shard[dead->lease_pos_shard];
+        for (int bytes = 0, i = 0; bytes < n; i++) {
+            unsigned long long p = pos + (unsigned long long)i;
+            long long s = slot_at(sh, p);
+            int len = (n - bytes < mem->slot_bytes) ? n - bytes : mem->slot_bytes;
+            _Atomic unsigned long long *t = slot_turn(mem, s);
+            // Aún ocupada por un Receptor de la vuelta anterior: reintentar luego
+            if (atomic_load_explicit(t, memory_order_acquire) < p) return 1;
+            if (atomic_load_explicit(t, memory_order_acquire) == p) {
+                slot_store(mem, s, data + bytes, len, seq + bytes, ts, now, codec);
+                atomic_store_explicit(t, p + 1, memory_order_release);
+            }
+            bytes += len;
+        }
+    }
+    atomic_store_explicit(&dead->lease_pos, 0, memory_order_release);
+    dead->lease_pos_seq = seq + n;
+    dead->lease_pos_len = 0;
+    sync_notify(&mem->sync, SYNC_EV_DATA, INT_MAX);
+    return 0;
+}
+
+void ring_release_dead(SharedMemory *mem, ProcEntry *dead) {
+    unsigned long long lp = atomic_load_explicit(&dead->lease_pos, memory_order_acquire);
+    if (lp == 0 || dead->role != ROLE_RECEIVER) return;
+    if (mem->layout == LAYOUT_RECORD) {
+        RecordHeader *h = rec_at(mem, lp - 1);
+        if (atomic_load(&h->state) == REC_COMMITTED && h->seq == dead->lease_pos_seq)
+            rec_release(mem, lp - 1);
+    }
+    atomic_store_explicit(&dead->lease_pos, 0, memory_order_release);
+}
+
+int ring_claim_skip(SharedMemory *mem, long long from, long long to) {
+    if (!atomic_compare_exchange_strong(&mem->next_claim, &from, to)) return 0;
+    sync_notify(&mem->sync, SYNC_EV_CLAIM, INT_MAX);
+    return 1;
+}
@@ -0,0 +1,199 @@
+#ifndef RING_H
+#define RING_H
+/*
+ =============================================================================
+  Archivo: ring.h
+  Propósito:
+    Operaciones sobre el buffer circular compartido, independientes del modo
+    de sincronización elegido por el Inicializador (campo ring_mode).
+
+  Modos:
+    - RING_MODE_SEM: el camino clásico (empty--, mutex--, celda, mutex++,
+      full++) sobre sync_wait/sync_post, con semop() o futex según
+      mem->sync.mode.
+    - RING_MODE_LOCKFREE: cola MPMC acotada con turnos por celda. Emisores y
+      receptores reclaman write_index/read_index con CAS; el camino rápido no
+      hace ninguna llamada al sistema. Los eventos SYNC_EV_SPACE/SYNC_EV_DATA
+      se usan solo para dormir cuando el anillo está lleno o vacío.
+
+  Distribución (campo layout):
+    - LAYOUT_COMPACT: cada ranura lleva un tramo de hasta slot_bytes bytes
+      con un solo seq/timestamp; los bytes de todas las ranuras quedan
+      contiguos y el índice de cada carácter se deriva de su posición.
+    - LAYOUT_TRACE: una celda SharedChar por carácter, con su índice,
+      timestamp, seq e is_full propios (trazabilidad completa).
+    - LAYOUT_RECORD: anillo de bytes con registros de largo variable (solo
+      lock-free y un fragmento). No usa ring_push_range/ring_pop_chunk
+      sino la API de reserva/confirmación más abajo.
+    write_index/read_index, empty/full y count cuentan ranuras.
+
+  Registros (LAYOUT_RECORD):
+    Cada registro es un RecordHeader de RECORD_HDR bytes seguido de su carga
+    útil, redondeada a 8 bytes, y siempre contiguo: si no cabe antes del
+    final del anillo, el Emisor deja un relleno (REC_PAD, o nada si quedan
+    menos de RECORD_HDR bytes) y empieza en el byte 0.
+      write_index : bytes reservados por Emisores (los reserva de a uno,
+                    en orden de seq, quien tiene el turno next_claim).
+      read_index  : bytes tomados por Receptores (CAS sobre el encabezado
+                    confirmado en esa posición).
+      free_index  : bytes liberados. Los Receptores liberan en cualquier
+                    orden marcando REC_RELEASED; free_index avanza sobre la
+                    corrida de registros liberados desde su posición.
+    Emisor : ring_reserve -> escribe en r.data -> ring_commit
+    Receptor: ring_peek -> procesa r.data en el lugar -> ring_release
+    Entre reserve y commit el Emisor es dueño de los bytes, y entre peek y
+    release el Receptor; nadie copia la carga útil fuera del anillo.
+
+  Fragmentos (campo shards, solo RING_MODE_LOCKFREE):
+    Las ranuras se reparten en K anillos independientes con sus propios
+    índices y evento de espacio. Un Emisor publica siempre en su fragmento
+    hogar (ProcEntry.shard); un Receptor extrae de su hogar y, si está
+    vacío, roba del fragmento más lleno, contando el robo en
+    shard[k].steals. Los receptores sin datos duermen en un único evento
+    SYNC_EV_DATA porque pueden servir a cualquier fragmento. En modo
+    semáforos hay un solo fragmento y el parámetro shard se ignora.
+
+  Convención de errores:
+    Las funciones devuelven 0 en éxito y -1 en error, dejando errno tal como
+    lo dejó semop() (o EIDRM si el Finalizador activó sync.shutdown).
+    EIDRM/EINVAL significan que el Finalizador retiró los recursos IPC y el
+    llamador debe terminar de forma ordenada.
+ =============================================================================
+*/
+#include "shared.h"
+#include "codec.h"
+
+/* -------------------------------
+   Tramo extraído del anillo
+   ------------------------------- */
+typedef struct {
+    char *data;          // Destino de al menos slot_bytes bytes (codificados)
+    int len;             // Bytes válidos en data
+    long long seq;       // seq del primer byte (el resto le sigue)
+    time_t timestamp;    // Hora de inserción del tramo
+    long long enq_ns;    // CLOCK_MONOTONIC al encolar (latency.h)
+    long long index;     // Posición física del primer byte en el buffer
+} RingChunk;
+
+// Ranuras de cada fragmento para size bytes de datos: la mayor potencia de
+// dos que entra en size / slot_bytes / shards (en LAYOUT_RECORD, bytes del
+// anillo de registros). Las posiciones se ubican con una máscara.
+long long ring_shard_slots(long long size, int layout, int slot_bytes, int shards);
+
+// Bytes de segmento (encabezado incluido) que ocupa un anillo de size
+// bytes de datos con la distribución layout
+size_t ring_bytes(long long size, int layout, int slot_bytes, int shards);
+
+// Deja el anillo vacío (índices, contadores y turnos de cada ranura).
+// En LAYOUT_COMPACT se crean ranuras de slot_bytes bytes, ring_shard_slots
+// en cada uno de los shards fragmentos.
+void ring_init(SharedMemory *mem, long long size, int ring_mode, int layout, int slot_bytes, int shards);
+
+// Inserta un carácter en el fragmento 0; completa sc->index con la posición
+// física usada. Bloquea solo si el anillo está lleno. No respeta el orden
+// de reclamo (next_claim): sc->seq puede ser cualquiera.
+int ring_push(SharedMemory *mem, int sem_id, SharedChar *sc);
+
+// Publica en el fragmento shard n caracteres con seq consecutivos
+// (seq, seq+1, ...), reservando sus ranuras de una sola vez (en tramos de
+// a lo sumo slots ranuras).
+// Cada tramo de data se codifica con codec (seq como desplazamiento) al
+// copiarse a su ranura, sin búfer intermedio; codec NULL lo copia tal cual.
+// *first_index recibe la posición física del primero; el resto le sigue
+// en orden circular (módulo slots * slot_bytes).
+// ts es la hora de pared para la consola y enq_ns la marca monotónica
+// para las latencias.
+// Las ranuras se reservan en orden de seq: seq debe ser el inicio de un
+// tramo repartido por next_pos, y el llamador espera a que next_claim lo
+// alcance.
+int ring_push_range(SharedMemory *mem, int sem_id, int shard, const char *data, int n, long long seq,
+                    time_t ts, long long enq_ns, const Codec *codec, long long *first_index);
+
+// Extrae la siguiente ranura en *out (out->data debe estar asignado), del
+// fragmento hogar shard o robada de otro. Bloquea solo si todos los
+// fragmentos están vacíos.
+int ring_pop_chunk(SharedMemory *mem, int sem_id, int shard, RingChunk *out);
+
+// Extrae de una vez hasta max ranuras consecutivas en out[0..], con un
+// solo reclamo (CAS sobre read_index, o full -= k y una sección crítica en
+// modo semáforos). Cada out[i].data debe tener slot_bytes bytes. Bloquea
+// solo hasta tener la primera: nunca espera a completar el lote, de modo
+// que con el anillo casi vacío devuelve 1. Devuelve las ranuras extraídas.
+int ring_pop_batch(SharedMemory *mem, int sem_id, int shard, RingChunk *out, int max);
+
+#define RECV_BATCH_DEFAULT 32    // lote máximo por defecto del Receptor (-b)
+#define RECV_BATCH_MAX     PROC_LEASES // un arriendo por tramo del lote
+
+// Extrae un solo carácter en *out; solo válido si slot_bytes == 1.
+int ring_pop(SharedMemory *mem, int sem_id, SharedChar *out);
+
+// Cantidad de ranuras ocupadas (aproximada si hay operaciones en curso), en
+// todo el anillo o en el fragmento k. En LAYOUT_RECORD, bytes ocupados
+// (encabezados y rellenos incluidos).
+long long ring_count(SharedMemory *mem);
+long long ring_shard_count(SharedMemory *mem, int k);
+
+/* -------------------------------
+   Registros (LAYOUT_RECORD)
+   ------------------------------- */
+#define REC_RESERVED 1   // reservado, el Emisor lo está escribiendo
+#define REC_COMMITTED 2  // confirmado, listo para un Receptor
+#define REC_RELEASED 3   // procesado; su espacio puede reutilizarse
+#define REC_PAD      4   // relleno hasta el final del anillo (len = bytes)
+
+typedef struct {
+    _Atomic int state;   // REC_*
+    int len;             // Bytes de carga útil (REC_PAD: bytes del relleno)
+    long long seq;       // seq del primer byte
+    long long enq_ns;    // CLOCK_MONOTONIC al confirmar
+    time_t timestamp;    // Hora de pared al confirmar
+} RecordHeader;
+
+#define RECORD_HDR ((int)sizeof(RecordHeader))
+
+// Registro reservado o tomado; data apunta dentro del anillo
+typedef struct {
+    char *data;
+    int len;
+    long long seq;
+    time_t timestamp;
+    long long enq_ns;
+    long long index;             // Desplazamiento de data en el anillo
+    unsigned long long pos;      // Posición (monotónica) del encabezado
+} RingRecord;
+
+// Carga útil máxima de un registro (un registro nunca ocupa más de medio
+// anillo, así siempre cabe con su relleno)
+int ring_record_max(const SharedMemory *mem);
+
+// Reserva n bytes (1..ring_record_max) para seq..seq+n-1: espera el turno
+// next_claim == seq y luego espacio. El llamador escribe r->data y llama a
+// ring_commit. -1 con errno (EMSGSIZE si n no es válido, EIDRM = cierre).
+int ring_reserve(SharedMemory *mem, int n, long long seq, RingRecord *r);
+void ring_commit(SharedMemory *mem, RingRecord *r, time_t ts, long long enq_ns);
+
+// Toma el siguiente registro confirmado (bloquea si no hay). El llamador
+// puede leerlo y modificarlo en r->data hasta ring_release.
+int ring_peek(SharedMemory *mem, RingRecord *r);
+void ring_release(SharedMemory *mem, const RingRecord *r);
+
+/* -------------------------------
+   Arriendos (recover.h)
+   ------------------------------- */
+// Entrada del proceso en la que el anillo anota lo reclamado y aún sin
+// publicar o persistir (NULL: no anotar, p. ej. en los benchmarks)
+void ring_set_owner(ProcEntry *self);
+
+// Completa la posición que el Emisor muerto dead reclamó sin publicar,
+// con data = los lease_pos_len bytes en claro desde lease_pos_seq.
+// 0 hecho (o nada pendiente), 1 si una ranura sigue ocupada (reintentar).
+int ring_repair(SharedMemory *mem, ProcEntry *dead, const char *data, const Codec *codec);
+
+// Libera el registro que el Receptor muerto dead tenía tomado
+void ring_release_dead(SharedMemory *mem, ProcEntry *dead);
+
+// Cede el turno de reclamo de from a to en nombre de un Emisor muerto;
+// 0 si next_claim ya no era from
+int ring_claim_skip(SharedMemory *mem, long long from, long long to);
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ ============================================================================
+ Archivo: segment.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Sello y verificación de la distribución del segmento (ver segment.h).
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "segment.h"
+
+void segment_stamp(SharedMemory *mem) {
+    mem->version = SHM_LAYOUT_VERSION;
+    mem->header_bytes = sizeof(SharedMemory);
+    atomic_thread_fence(memory_order_release);
+    mem->magic = SHM_MAGIC;
+}
+
+int segment_check(const SharedMemory *mem) {
+    if (mem->magic != SHM_MAGIC) {
+        fprintf(stderr, "Segmento no inicializado o de otra versión del proyecto\n");
+        return -1;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    if (mem->version != SHM_LAYOUT_VERSION || mem->header_bytes != sizeof(SharedMemory)) {
+        fprintf(stderr, "Distribución del segmento incompatible (versión %u, se esperaba %u)\n",
+                mem->version, SHM_LAYOUT_VERSION);
+        return -1;
+    }
+    return 0;
+}
+
+// Valor numérico de "<campo>: N" en /proc/meminfo; 0 si no está
+static size_t meminfo(const char *field) {
+    FILE *f = fopen("/proc/meminfo", "r");
+    if (!f) return 0;
+    char line[128];
+    size_t len = strlen(field), v = 0;
+    while (fgets(line, sizeof(line), f))
+        if (strncmp(line, field, len) == 0 && line[len] == ':') {
+            sscanf(line + len + 1, "%zu", &v);
+            break;
+        }
+    fclose(f);
+    return v;
+}
+
+// Un límite de /proc/sys/kernel; 0 si no se puede leer
+static unsigned long long kernel_limit(const char *name) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/sys/kernel/%s", name);
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    unsigned long long v = 0;
+    if (fscanf(f, "%llu", &v) != 1) v = 0;
+    fclose(f);
+    return v;
+}
+
+size_t segment_huge_page(void) {
+    return meminfo("Hugepagesize") * 1024;
+}
+
+int segment_fits(size_t bytes, int flags) {
+    unsigned long long shmmax = kernel_limit("shmmax");
+    if (shmmax && bytes > shmmax) {
+        fprintf(stderr, "El segmento (%zu bytes) supera kernel.shmmax (%llu); reduzca el buffer o la "
+                        "ventana (-w), o suba el límite (sysctl kernel.shmmax)\n", bytes, shmmax);
+        return -1;
+    }
+    unsigned long long shmall = kernel_limit("shmall"); // en páginas
+    unsigned long long page = (unsigned long long)sysconf(_SC_PAGESIZE);
+    if (shmall && shmall < ~0ULL / page && bytes > shmall * page) {
+        fprintf(stderr, "El segmento (%zu bytes) supera kernel.shmall (%llu páginas de %llu bytes); "
+                        "suba el límite (sysctl kernel.shmall)\n", bytes, shmall, page);
+        return -1;
+    }
+    size_t huge = segment_huge_page();
+    if ((flags & SEG_HUGETLB) && huge) {
+        size_t free_pages = meminfo("HugePages_Free");
+        if (bytes / huge > free_pages) {
+            fprintf(stderr, "Con -H hacen falta %zu páginas enormes libres y hay %zu (vm.nr_hugepages)\n",
+                    bytes / huge, free_pages);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void segment_prefault(void *addr, size_t bytes, int write) {
+    volatile char *p = addr;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < bytes; off += page) {
+        char c = p[off];
+        if (write) p[off] = c;
+    }
+}
+
+void segment_warm(const SharedMemory *mem) {
+    if (mem->seg_flags & SEG_PREFAULT) segment_prefault((void *)mem, mem->segment_bytes, 0);
+}
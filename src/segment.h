@@ -0,0 +1,44 @@
+#ifndef SEGMENT_H
+#define SEGMENT_H
+/*
+ =============================================================================
+  Archivo: segment.h
+  Propósito:
+    Verificación de la distribución del segmento al anexarse. Un binario
+    compilado con otra versión de SharedMemory leería campos corridos, así
+    que Emisor, Receptor y Finalizador se niegan a continuar.
+
+    También el manejo de sus páginas: el segmento puede crearse con páginas
+    enormes (menos entradas de TLB) y tocarse entero de antemano (prefault)
+    para que ningún fallo de página caiga en el camino de datos. Las páginas
+    físicas las pone el Inicializador; cada proceso que se anexa debe
+    además poblar sus propias tablas de páginas (segment_warm).
+ =============================================================================
+*/
+#include "shared.h"
+
+// Marca el segmento como inicializado con la distribución actual. El
+// Inicializador la llama al final, después de dejar todo en su lugar.
+void segment_stamp(SharedMemory *mem);
+
+// 0 si el segmento tiene la distribución de este binario; si no, informa
+// por stderr y devuelve -1
+int segment_check(const SharedMemory *mem);
+
+// Tamaño de la página enorme por defecto (Hugepagesize de /proc/meminfo);
+// 0 si el sistema no la informa
+size_t segment_huge_page(void);
+
+// 0 si un segmento de bytes (con flags SEG_*) entra en los límites del
+// sistema: kernel.shmmax, kernel.shmall y, con SEG_HUGETLB, las páginas
+// enormes libres. Si no, informa por stderr y devuelve -1.
+int segment_fits(size_t bytes, int flags);
+
+// Toca cada página de [addr, addr + bytes): con write la reescribe (asigna
+// la página física), si no solo la lee (la mapea en este proceso)
+void segment_prefault(void *addr, size_t bytes, int write);
+
+// Prefault de lectura del segmento completo si se creó con SEG_PREFAULT
+void segment_warm(const SharedMemory *mem);
+
+#endif
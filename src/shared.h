@@ -8,33 +8,72 @@
     de Comunicación de Procesos Sincronizada (buffer circular con metadatos).
 
   Resumen funcional:
-    - SharedChar: entrada del buffer con (ascii codificado), índice local,
-      timestamp y número de orden global (seq) para reconstrucción.
+    - SharedChar: entrada del buffer en modo traza con (ascii codificado),
+      índice local, timestamp y número de orden global (seq).
     - SharedMemory: control del buffer circular + contadores globales + ruta
       del archivo fuente + “struct flexible” buffer[].
 
   Relación con el enunciado:
     • Cada carácter almacenado debe incluir: valor ASCII, índice, hora de
-      inserción y cualquier otro dato necesario (usamos seq).
+      inserción y cualquier otro dato necesario (usamos seq). En
+      LAYOUT_COMPACT el índice se deriva de la posición y la hora y el seq
+      se guardan una vez por tramo.
     • Memoria circular, sin sobrescritura de datos no leídos.
     • Soporte para n emisores y n receptores concurrentes.
 
   Notas de portabilidad:
-    - Definir _XOPEN_SOURCE 700 en los .c antes de <unistd.h> para fseeko/ftello/nanosleep.
+    - Definir _XOPEN_SOURCE 700 en los .c antes de <unistd.h> para pread/nanosleep.
     - PATH_MAX podría no estar definido; se define una reserva prudente (4096).
 
-  Invariantes esperados (mantenidos por Emisor/Receptor con semáforos):
-    1) 0 <= count <= size
-    2) write_index y read_index en [0, size-1], avanzan módulo size
-    3) empty == size - count, full == count (en términos lógicos)
-    4) No se sobrescriben entradas con is_full=1
+  Modos del buffer (elegidos por el Inicializador, campo ring_mode):
+    - RING_MODE_SEM     : compatibilidad; triple mutex/empty/full con semop().
+    - RING_MODE_LOCKFREE: anillo MPMC sin candados. Cada ranura tiene un
+      número de turno (turn) y las posiciones se reclaman con CAS; solo se
+      entra al kernel cuando el anillo está realmente lleno o vacío.
+  Modos de sincronización (campo sync.mode, ver sync.h):
+    - SYNC_FUTEX: mutex/empty/full y timbres como palabras futex dentro
+      del segmento; solo hay syscall si alguien debe dormir o despertar.
+    - SYNC_SEMOP: mutex/empty/full con el conjunto de semáforos System V.
+
+  Fragmentos (campo shards, solo modo lock-free si shards > 1):
+    El anillo se divide en K fragmentos independientes, cada uno con sus
+    propias ranuras, índices y evento de espacio. Cada Emisor publica en
+    su fragmento "hogar"; cada Receptor drena el suyo y, si se vacía, roba
+    del fragmento más lleno (ver ring.h).
+
+  Invariantes esperados (mantenidos por Emisor/Receptor, por fragmento):
+    1) 0 <= write_index - read_index <= slots del fragmento
+    2) write_index y read_index son contadores monotónicos de 64 bits;
+       la ranura física es base + (contador & mask): cada fragmento tiene
+       una potencia de dos de ranuras (mask = slots - 1)
+    3) Modo semáforos: empty == slots - count, full == count
+    4) No se sobrescriben entradas con is_full=1 (en modo lock-free lo
+       garantiza turn: la ranura i está libre para la posición p si
+       turn == p y lista para leerse si turn == p + 1)
     5) seq es estricto creciente por carácter leído del archivo,
        y next_to_flush indica el siguiente seq que debe persistirse
        (escritura colaborativa ordenada en Receptor).
+    6) Todo seq depositado en la ventana de reordenamiento cumple
+       next_to_flush <= seq < next_to_flush + reorder_size.
+
+  Distribución del segmento:
+    LAYOUT_TRACE  : [SharedMemory][buffer[size]][ventana (reorder.h)]
+    LAYOUT_COMPACT: [SharedMemory][turn|seq|ts|len de cada ranura]
+                    [bytes de las ranuras][ventana (reorder.h)]
+    LAYOUT_RECORD : [SharedMemory][anillo de bytes con registros de largo
+                    variable (ring.h)][ventana (reorder.h)]; "ranuras"
+                    pasan a ser bytes y los índices cuentan bytes.
+    Con trabajos (jobs_max > 0) le sigue a la ventana la tabla de
+    trabajos: jobs_max entradas StreamJob (stream.h). Con ingesta
+    (ingest_bytes > 0) sigue el área de ingesta: ingest_bytes bytes en
+    claro de la fuente en flujo (ingest.h).
  =============================================================================
 */
 #include <time.h>
 #include <limits.h>
+#include <stdatomic.h>
+#include "sync.h"
+#include "latency.h"
 
 /* -------------------------------
    PATH_MAX de respaldo (portátil)
@@ -43,6 +82,53 @@
 #define PATH_MAX 4096
 #endif
 
+/* -------------------------------
+   Modos del buffer circular
+   ------------------------------- */
+#define RING_MODE_SEM       0   // mutex/empty/full con semáforos System V
+#define RING_MODE_LOCKFREE  1   // anillo MPMC con turnos atómicos (C11)
+
+/* -------------------------------
+   Distribución de las ranuras del buffer
+   ------------------------------- */
+#define LAYOUT_COMPACT 0  // tramos en arreglos separados, un seq/timestamp por tramo
+#define LAYOUT_TRACE   1  // una celda SharedChar con metadatos por carácter
+#define LAYOUT_RECORD  2  // registros de largo variable con prefijo (ring.h)
+
+/* -------------------------------
+   Lectura del archivo fuente (Emisor)
+   ------------------------------- */
+#define SOURCE_PREAD 0   // un pread por tramo reclamado
+#define SOURCE_MMAP  1   // mapeo del archivo, codificación directa a ranuras
+
+/* -------------------------------
+   Escritura del archivo de salida (Receptor)
+   ------------------------------- */
+#define OUTPUT_APPEND 0  // en orden, a través de la ventana de reordenamiento
+#define OUTPUT_PWRITE 1  // pwrite en el desplazamiento seq (archivo preasignado)
+#define OUTPUT_MMAP   2  // mapeo compartido del archivo preasignado
+
+/* -------------------------------
+   Páginas del segmento (bits de seg_flags)
+   ------------------------------- */
+#define SEG_HUGETLB   0x1  // creado con SHM_HUGETLB (páginas enormes)
+#define SEG_PREFAULT  0x2  // prefault al inicializar y al anexarse
+#define SEG_LOCKED    0x4  // fijado en RAM con SHM_LOCK
+
+/* -------------------------------
+   Modo de ejecución de Emisor/Receptor (argumento <modo>)
+   ------------------------------- */
+#define RUN_MANUAL     0  // ENTER entre tramos, tabla por carácter
+#define RUN_AUTO       1  // 0.4 s entre tramos, tabla por carácter
+#define RUN_CONTINUOUS 2  // sin pausas ni consola (benchmarks)
+
+/* -------------------------------
+   Índices del conjunto de semáforos
+   ------------------------------- */
+#define SEM_MUTEX 0
+#define SEM_EMPTY 1
+#define SEM_FULL  2
+
 
 /* =========================================================
    Entrada del buffer circular
@@ -56,56 +142,334 @@
    seq       : número de orden global asignado desde archivo;
                Receptor usa (seq == next_to_flush) para escribir
                en orden en el archivo de salida.
+   turn      : turno de la celda en modo lock-free (ver invariante 4).
+   enq_ns    : CLOCK_MONOTONIC (ns) al encolar; base de las
+               latencias (latency.h).
    ========================================================= */
 typedef struct {
     char ascii;          // Valor ASCII (codificado con XOR)
-    int index;           // Índice dentro del buffer circular
+    long long index;     // Índice dentro del buffer circular
     time_t timestamp;    // Hora en la que se insertó
     int is_full;         // Indicador: 1 = lleno, 0 = vacío
     long long seq;       // Número de orden global (para reensamblar)
+    _Atomic unsigned long long turn; // Turno de la celda (modo lock-free)
+    long long enq_ns;    // Marca monotónica de encolado (ns)
 } SharedChar;
 
+/* =========================================================
+   Tabla de procesos (estadísticas por proceso)
+   ---------------------------------------------------------
+   Cada Emisor/Receptor se registra en una entrada propia y
+   solo él escribe su contador chars, así que el camino de
+   datos no comparte líneas de caché con otros procesos.
+   Los totales se agregan al leer (ver proc.h).
+   state : PROC_FREE, PROC_ACTIVE o PROC_DEAD (el proceso murió,
+           o salió por un error, y otro está completando lo que
+           tenía en mano).
+   role  : ROLE_EMITTER o ROLE_RECEIVER.
+   pid   : proceso dueño de la entrada.
+   shard : fragmento hogar del anillo (reparto rotativo por rol).
+   chars : caracteres publicados (emisor) o extraídos (receptor).
+
+   Arriendo (lease, ver recover.h): lo que el proceso tiene en
+   mano y otro debe completar si muere. Lo escribe el dueño.
+   lease[]      : emisor: lease[0] es el tramo [seq, seq+len) de
+                  next_pos aún no publicado; receptor: los tramos
+                  extraídos del anillo aún sin persistir (len = 0
+                  una vez persistido).
+   lease_n      : entradas válidas de lease[].
+   lease_tokens : unidades de empty (emisor) o full (receptor)
+                  tomadas y aún no usadas (modo semáforos).
+   lease_pos    : 1 + posición del anillo reclamada sin publicar
+                  (emisor: ranuras o registro reservado) o del
+                  registro en mano (receptor); 0 = ninguna.
+                  lease_pos_shard/seq/len la describen.
+   reaper       : pid de quien recupera la entrada (PROC_DEAD).
+   lease_direct : recuperación en curso: lease[] ya son los tramos
+                  que faltan entregar directo a la salida.
+   inflight[]   : receptor: pedidos de su escritor de salida
+                  (writer.h) aún sin marcar en la ventana, escritos
+                  o no (len = 0 = libre).
+   ========================================================= */
+#define CACHE_LINE 64
+#define PROC_MAX   128
+
+#define PROC_FREE   0
+#define PROC_ACTIVE 1
+#define PROC_DEAD   2
+
+#define PROC_LEASES 64   // tramos en mano por proceso (lote máximo del Receptor)
+#define PROC_INFLIGHT 64 // pedidos del escritor de salida sin marcar (writer.h)
+
+#define ROLE_EMITTER  0
+#define ROLE_RECEIVER 1
+
+// Rango de seq [seq, seq + len)
+typedef struct {
+    long long seq;
+    int len;
+} SeqRange;
+
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic int state; // PROC_FREE | PROC_ACTIVE | PROC_DEAD
+    int role;                               // ROLE_EMITTER | ROLE_RECEIVER
+    int pid;                                // Proceso dueño
+    int shard;                              // Fragmento hogar (ring.h)
+    _Atomic long long chars;                // Solo lo escribe el dueño
+    _Atomic long long blocked_ns[SYNC_WAIT_COUNT]; // Tiempo bloqueado por clase (dueño)
+
+    // Arriendo (recover.h)
+    _Atomic int lease_n;                    // Entradas válidas de lease[]
+    _Atomic int lease_tokens;               // empty/full tomados sin usar
+    _Atomic unsigned long long lease_pos;   // 1 + posición reclamada (0 = ninguna)
+    int lease_pos_shard;                    // Fragmento de lease_pos
+    long long lease_pos_seq;                // seq del primer byte en lease_pos
+    int lease_pos_len;                      // Bytes desde lease_pos
+    _Atomic int reaper;                     // pid que la recupera (PROC_DEAD)
+    int lease_direct;                       // lease[] quedó listo para entregar
+    SeqRange lease[PROC_LEASES];            // Tramos en mano
+    SeqRange inflight[PROC_INFLIGHT];       // Pedidos de salida sin marcar
+} ProcEntry;
+
+/* =========================================================
+   Trabajo de la cola de flujos (stream.h)
+   ---------------------------------------------------------
+   Un par (fuente, destino) que ocupa los seq [base, base +
+   bytes) del espacio global. La tabla es circular: el
+   trabajo id vive en jobs[id % jobs_max] y su entrada se
+   reutiliza cuando next_to_flush pasó su último byte.
+   ========================================================= */
+typedef struct {
+    long long id;                      // Número de trabajo (orden de llegada)
+    long long base;                    // seq de su primer byte
+    long long bytes;                   // Tamaño de la fuente al encolar
+    char src[PATH_MAX];                // Archivo fuente
+    char dst[PATH_MAX];                // Archivo destino (creado al encolar)
+} StreamJob;
+
+/* =========================================================
+   Fragmento del anillo
+   ---------------------------------------------------------
+   base / slots : primera ranura física y cantidad de ranuras
+                  del fragmento (solo lectura tras inicializar);
+                  slots es potencia de dos y mask = slots - 1.
+   write_index  : ranuras escritas/reclamadas (Emisores).
+   read_index   : ranuras leídas/reclamadas (Receptores).
+   count        : ranuras ocupadas (solo modo semáforos, bajo el
+                  mutex; en lock-free es write_index - read_index).
+   steals       : ranuras extraídas por Receptores de otro hogar.
+   free_index   : bytes ya liberados por los Receptores (solo
+                  LAYOUT_RECORD: write_index - free_index es lo ocupado).
+   Cada grupo en su línea: los Emisores de un fragmento no
+   invalidan la línea de sus Receptores ni la de otro fragmento.
+   ========================================================= */
+typedef struct {
+    _Alignas(CACHE_LINE) long long base;           // Primera ranura física
+    long long slots;                               // Ranuras del fragmento (potencia de dos)
+    unsigned long long mask;                       // slots - 1
+    _Alignas(CACHE_LINE) _Atomic unsigned long long write_index; // Posiciones escritas (monotónico)
+    _Alignas(CACHE_LINE) _Atomic unsigned long long read_index;  // Posiciones leídas (monotónico)
+    long long count;                               // Ranuras ocupadas (modo semáforos)
+    _Atomic long long steals;                      // Robos de Receptores ajenos
+    _Alignas(CACHE_LINE) _Atomic unsigned long long free_index;  // Bytes liberados (LAYOUT_RECORD)
+} RingShard;
+
+/* =========================================================
+   Cubeta de ritmo compartida (pacing.h, modo "global")
+   ---------------------------------------------------------
+   tat: instante teórico de llegada (CLOCK_MONOTONIC, ns) de
+   la cubeta GCRA de un rol; una por línea de caché.
+   ========================================================= */
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic long long tat;
+} PaceBucket;
+
+/* =========================================================
+   Versión de la distribución del segmento
+   ---------------------------------------------------------
+   Se incrementa cada vez que cambia SharedMemory o la forma
+   de las regiones que le siguen; los procesos se niegan a
+   anexarse a un segmento de otra versión (segment.h).
+   ========================================================= */
+#define SHM_MAGIC          0x4F505331u  // "1SPO"
+#define SHM_LAYOUT_VERSION 24
+
 /* =========================================================
    Memoria compartida principal (segmento IPC)
    ---------------------------------------------------------
-   size         : capacidad (n° de celdas) del buffer circular.
-   write_index  : índice donde el Emisor escribirá el próximo dato.
-   read_index   : índice donde el Receptor leerá el próximo dato.
-   count        : cantidad de elementos actualmente en el buffer.
+   El encabezado está dividido en regiones alineadas a línea de caché
+   según quién las escribe, para que emisores y receptores no se roben
+   la misma línea en cada operación:
+
+   Configuración (solo lectura tras el Inicializador):
+   magic / version / header_bytes:
+                  identifican la distribución (segment_check()).
+   size         : capacidad (bytes de datos) pedida para el buffer; el
+                  anillo usa la mayor potencia de dos de ranuras por
+                  fragmento que entra en ella.
+   ring_mode    : RING_MODE_SEM o RING_MODE_LOCKFREE.
+   layout       : LAYOUT_COMPACT o LAYOUT_TRACE.
+   slots        : ranuras del anillo sumando todos los fragmentos (en
+                  LAYOUT_RECORD, bytes del anillo de registros).
+   shards       : fragmentos del anillo (1..SHARD_MAX).
+   slot_bytes   : bytes por ranura (1 en modo traza).
+   slots_offset : desplazamiento de los arreglos de ranuras (compacto).
+   chunk_size   : bytes de next_pos que un Emisor reclama de una vez
+                  (leídos con un solo pread y publicados juntos).
+   source_mode  : SOURCE_PREAD o SOURCE_MMAP.
+   source_bytes : tamaño del archivo fuente al inicializar (-1 si no se
+                  pudo consultar); define la preasignación de la salida.
+   source_fp    : huella de la fuente (checkpoint.h).
+   ckpt_every   : bytes de next_to_flush entre puntos de control de la
+                  salida (0 = sin puntos de control).
+   output_mode  : OUTPUT_APPEND, OUTPUT_PWRITE u OUTPUT_MMAP.
+   codec / codec_key_len:
+                  códec de los datos y largo de su clave (codec.h);
+                  Emisores y Receptores lo leen de aquí, nunca lo eligen.
+   reorder_size / reorder_offset:
+                  posiciones de la ventana de reordenamiento y su
+                  desplazamiento desde el inicio del segmento.
+   frame_lines  : con LAYOUT_RECORD, 1 si los Emisores publican un
+                  registro por línea de la fuente (0 = uno por tramo).
+   segment_bytes: tamaño total del segmento creado por el Inicializador
+                  (múltiplo de la página enorme con SEG_HUGETLB).
+   seg_flags    : SEG_* con que se creó el segmento (segment.h).
+   pace_rate    : bytes/s de la cubeta global de cada rol (0 = sin cubeta).
+   jobs_max / jobs_offset:
+                  entradas de la tabla de trabajos y su desplazamiento
+                  (0 = un solo flujo, el de fuente_path).
+   ingest_bytes / ingest_offset:
+                  capacidad del área de ingesta (potencia de dos) y su
+                  desplazamiento (0 = fuente en archivo, sin ingesta).
+   fuente_path  : ruta del archivo fuente a transmitir (con ingesta, la
+                  que lee el ingestor por defecto; "-" = entrada estándar).
+
+   Sincronización:
+   sync         : semáforos futex, timbres del anillo lock-free
+                  (SYNC_EV_SPACE + k / SYNC_EV_DATA) y palabra de
+                  cierre; cada evento ocupa su propia línea.
+
+   Productores (Emisores):
    next_pos     : desplazamiento global de lectura en archivo fuente
                   (asignado atómicamente por Emisores).
-   total_written: total de caracteres insertados al buffer.
-   total_consumed: total de caracteres extraídos del buffer.
-   emitters_active / receivers_active:
-                  contadores vivos (para estadísticas de cierre).
-   emitters_total / receivers_total:
-                  contadores acumulados (cuántos han iniciado alguna vez).
-   next_to_flush: siguiente seq que debe persistirse (archivo destino).
-   fuente_path  : ruta del archivo fuente a transmitir.
-   buffer[]     : arreglo flexible de SharedChar (tamaño = size).
+   next_claim   : seq del próximo tramo que puede reclamar ranuras. Los
+                  Emisores leen en paralelo, pero reservan sus ranuras en
+                  orden de seq; así el anillo nunca retiene un seq posterior
+                  mientras falta uno anterior (ver reorder.h).
+
+   Trabajos (solo con jobs_max > 0, ver stream.h):
+   jobs_added   : trabajos encolados desde el inicio (próximo id).
+   jobs_end     : seq siguiente al último byte encolado; los Emisores
+                  no reclaman más allá.
+   jobs_lock    : candado de quien encola (pid; 0 = libre).
+
+   Ingesta (solo con ingest_bytes > 0, ver ingest.h):
+   ingest_end   : seq siguiente al último byte ingerido; los Emisores
+                  no reclaman más allá.
+   ingest_eof   : 1 cuando el flujo terminó (ingest_end ya es final).
+   ingest_lock  : pid del ingestor (0 = ninguno).
+
+   Anillo:
+   shard[k]     : índices y contadores del fragmento k (ver RingShard).
+
+   Volcado de la salida (Receptores):
+   next_to_flush: siguiente seq que debe persistirse (archivo destino); en
+                  salida posicional, marca de completitud (todo seq menor
+                  ya fue escrito).
+   flush_lock   : candado de volcado (solo se intenta, nunca se espera);
+                  guarda el pid de quien lo tiene, para soltarlo si muere.
+   ckpt_next    : next_to_flush que dispara el próximo punto de control;
+                  quien lo avanza con CAS escribe el punto.
+   out_base     : bytes que la salida tenía antes del seq 0 (el primer
+                  Receptor en abrirla en modo append la fija; -1 = nadie
+                  aún); el largo durable es out_base + next_to_flush.
+
+   Estadísticas (se escriben al registrarse o salir un proceso):
+   registered[r]: procesos de rol r que se registraron alguna vez.
+   retired_chars[r]: caracteres de los procesos de rol r ya retirados.
+   procs[]      : tabla de procesos (ver ProcEntry); caracteres y tiempo
+                  bloqueado de cada proceso vivo, que lee el monitor.
+
+   Ritmo (procesos con -p global):
+   pace[r]      : cubeta compartida del rol r (ver PaceBucket).
+
+   Latencias (Receptores, contadores relajados):
+   lat[k]       : histogramas enq→deq (LAT_DEQUEUE) y enq→disco
+                  (LAT_DISK) en ns, por carácter (latency.h).
+
+   buffer[]     : arreglo flexible de SharedChar (tamaño = size; solo en
+                  modo traza).
    ========================================================= */
 typedef struct {
-    // Control del buffer
-    int size;            // Tamaño total del buffer
-    int write_index;     // Índice actual de escritura
-    int read_index;      // Índice actual de lectura
-    int count;           // Cantidad de caracteres almacenados actualmente
+    // Configuración (solo lectura tras inicializar)
+    unsigned int magic;                // SHM_MAGIC (se escribe al final del init)
+    unsigned int version;              // SHM_LAYOUT_VERSION
+    size_t header_bytes;               // sizeof(SharedMemory) del Inicializador
+    long long size;                    // Tamaño pedido del buffer (bytes)
+    int ring_mode;                     // RING_MODE_SEM | RING_MODE_LOCKFREE
+    int layout;                        // LAYOUT_COMPACT | LAYOUT_TRACE
+    long long slots;                   // Ranuras del anillo (todos los fragmentos)
+    int shards;                        // Fragmentos del anillo
+    int slot_bytes;                    // Bytes por ranura
+    size_t slots_offset;               // Arreglos de ranuras (LAYOUT_COMPACT)
+    int chunk_size;                    // Bytes reclamados por Emisor en cada vuelta
+    int source_mode;                   // SOURCE_PREAD | SOURCE_MMAP
+    long long source_bytes;            // Tamaño de la fuente (preasignación de salida)
+    unsigned long long source_fp;      // Huella de la fuente (checkpoint.h)
+    long long ckpt_every;              // Bytes entre puntos de control (0 = ninguno)
+    int output_mode;                   // OUTPUT_APPEND | OUTPUT_PWRITE | OUTPUT_MMAP
+    int codec;                         // CODEC_XOR | CODEC_ROLL (codec.h)
+    int codec_key_len;                 // Bytes de la clave rodante
+    long long reorder_size;            // Posiciones de la ventana de reordenamiento
+    size_t reorder_offset;             // Desplazamiento de la ventana en el segmento
+    int frame_lines;                   // LAYOUT_RECORD: un registro por línea de la fuente
+    size_t segment_bytes;              // Tamaño total del segmento
+    int seg_flags;                     // SEG_HUGETLB | SEG_PREFAULT | SEG_LOCKED
+    long long pace_rate;               // Cubeta global de ritmo (bytes/s por rol)
+    int jobs_max;                      // Entradas de la tabla de trabajos (0 = sin trabajos)
+    size_t jobs_offset;                // Desplazamiento de la tabla en el segmento
+    long long ingest_bytes;            // Área de ingesta (0 = fuente en archivo)
+    size_t ingest_offset;              // Desplazamiento del área en el segmento
+    char fuente_path[PATH_MAX];        // Ruta del archivo fuente
+
+    // Sincronización
+    _Alignas(CACHE_LINE) ShmSync sync; // Primitivas futex y palabra de cierre
+
+    // Productores
+    _Alignas(CACHE_LINE) _Atomic long long next_pos; // Próxima posición global a leer del archivo (emisor)
+    _Alignas(CACHE_LINE) _Atomic long long next_claim; // Próximo seq que puede reservar ranuras
+
+    // Trabajos
+    _Alignas(CACHE_LINE) _Atomic long long jobs_added; // Trabajos encolados (próximo id)
+    _Atomic long long jobs_end;        // Fin del espacio de seq encolado
+    _Atomic int jobs_lock;             // pid de quien encola (0 = libre)
+
+    // Ingesta
+    _Alignas(CACHE_LINE) _Atomic long long ingest_end; // Fin de lo ingerido (seq)
+    _Atomic int ingest_eof;            // Flujo terminado
+    _Atomic int ingest_lock;           // pid del ingestor (0 = ninguno)
+
+    // Anillo
+    RingShard shard[SHARD_MAX];        // Fragmentos (solo los primeros shards en uso)
 
-    // Configuración y estado compartido
-    long long next_pos;        // Próxima posición global a leer del archivo (emisor)
-    long long total_written;   // Caracteres escritos al buffer
-    long long total_consumed;  // Caracteres consumidos por receptores
+    // Volcado de la salida
+    _Alignas(CACHE_LINE) _Atomic long long next_to_flush; // próximo seq que debe escribirse en el archivo
+    _Atomic int flush_lock;            // Candado de volcado (try-lock)
+    _Atomic long long ckpt_next;       // Marca del próximo punto de control
+    _Atomic long long out_base;        // Largo previo de la salida (-1 = sin fijar)
 
-    int emitters_active;       // Emisores activos
-    int receivers_active;      // Receptores activos
-    int emitters_total;        // Emisores que han iniciado alguna vez
-    int receivers_total;       // Receptores que han iniciado alguna vez
+    // Estadísticas
+    _Alignas(CACHE_LINE) _Atomic int registered[2]; // Procesos registrados por rol
+    _Atomic long long retired_chars[2];             // Caracteres de procesos retirados
+    ProcEntry procs[PROC_MAX];                      // Contadores por proceso
 
-    long long next_to_flush;   // próximo seq que debe escribirse en el archivo
+    // Ritmo
+    PaceBucket pace[2];                             // Cubetas globales por rol
 
-    char fuente_path[PATH_MAX]; // Ruta del archivo fuente
+    // Latencias
+    _Alignas(CACHE_LINE) LatHist lat[LAT_COUNT];    // Histogramas (latency.h)
 
-    // Buffer flexible (tamaño variable)
+    // Buffer flexible (tamaño variable, solo LAYOUT_TRACE)
     SharedChar buffer[];
 } SharedMemory;
 
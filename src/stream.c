@@ -0,0 +1,302 @@
+/*
+ ============================================================================
+ Archivo: stream.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Cola de flujos sobre el espacio global de seq (ver stream.h).
+
+    Entradas de la tabla: los ids [added - jobs_max, added). La del id
+    added - jobs_max es la única que quien encola puede estar reescribiendo,
+    y solo si su trabajo ya se persistió entero: nadie busca en ella un seq
+    que todavía haga falta, y quien la lee verifica su id al terminar. Las bases crecen con el id,
+    así que un seq se ubica con búsqueda binaria; cada proceso además
+    recuerda el último trabajo que abrió.
+ ============================================================================
+*/
+#define _XOPEN_SOURCE 700
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include "stream.h"
+
+/* --------------------------------------------------------------------------
+   Tabla
+   -------------------------------------------------------------------------- */
+static StreamJob *job_at(SharedMemory *mem, long long id) {
+    return (StreamJob *)((char *)mem + mem->jobs_offset) + id % mem->jobs_max;
+}
+
+size_t stream_bytes(int jobs_max) {
+    return ((size_t)jobs_max * sizeof(StreamJob) + 63) & ~(size_t)63;
+}
+
+void stream_init(SharedMemory *mem, size_t offset, int jobs_max) {
+    mem->jobs_offset = offset;
+    mem->jobs_max = jobs_max;
+    atomic_store(&mem->jobs_added, 0);
+    atomic_store(&mem->jobs_end, 0);
+    atomic_store(&mem->jobs_lock, 0);
+    for (int i = 0; i < jobs_max; i++) job_at(mem, i)->id = -1;
+}
+
+// Candidato a trabajo que contiene seq: el último id con base <= seq, o el
+// más viejo si seq es anterior. -1 si no hay trabajos; quien lo use
+// verifica id y tramo tras copiar la entrada.
+static long long job_find(SharedMemory *mem, long long seq) {
+    long long hi = atomic_load(&mem->jobs_added) - 1;
+    long long lo = hi - mem->jobs_max + 1; // su entrada puede estar reciclándose
+    if (lo < 0) lo = 0;
+    if (hi < 0) return -1;
+
+    // Búsqueda binaria entre las entradas estables (los vacíos comparten
+    // base con el siguiente)
+    long long first = (hi + 1 >= mem->jobs_max) ? lo + 1 : lo;
+    if (first > hi || job_at(mem, first)->base > seq) return lo;
+    lo = first;
+    while (lo < hi) {
+        long long mid = lo + (hi - lo + 1) / 2;
+        if (job_at(mem, mid)->base <= seq) lo = mid; else hi = mid - 1;
+    }
+    return lo;
+}
+
+/* --------------------------------------------------------------------------
+   Encolado
+   -------------------------------------------------------------------------- */
+
+// Candado de quien encola; se hereda si su dueño murió
+static void jobs_lock(SharedMemory *mem) {
+    int self = (int)getpid();
+    for (;;) {
+        int owner = 0;
+        if (atomic_compare_exchange_strong(&mem->jobs_lock, &owner, self)) return;
+        if (kill(owner, 0) == -1 && errno == ESRCH &&
+            atomic_compare_exchange_strong(&mem->jobs_lock, &owner, self)) return;
+        struct timespec t = {0, 1000000};
+        nanosleep(&t, NULL);
+    }
+}
+
+static void jobs_unlock(SharedMemory *mem) {
+    atomic_store(&mem->jobs_lock, 0);
+}
+
+// 1 si la entrada del próximo id está libre (su trabajo anterior persistido)
+static int slot_free(SharedMemory *mem, long long id) {
+    if (id < mem->jobs_max) return 1;
+    StreamJob *old = job_at(mem, id);
+    return old->base + old->bytes <= atomic_load(&mem->next_to_flush);
+}
+
+long long stream_enqueue(SharedMemory *mem, const char *src, const char *dst, int wait) {
+    if (strlen(src) >= PATH_MAX || strlen(dst) >= PATH_MAX) {
+        fprintf(stderr, "Ruta demasiado larga: %s\n", (strlen(src) >= PATH_MAX) ? src : dst);
+        return -1;
+    }
+    struct stat st;
+    if (stat(src, &st) == -1) { perror(src); return -1; }
+    if (!S_ISREG(st.st_mode)) { fprintf(stderr, "%s: no es un archivo regular\n", src); return -1; }
+
+    // El destino existe desde ya, al tamaño final: un trabajo vacío no
+    // pasa por ningún Receptor
+    int fd = open(dst, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) { perror(dst); return -1; }
+    if (ftruncate(fd, st.st_size) == -1) { perror(dst); close(fd); return -1; }
+    close(fd);
+
+    for (;;) {
+        jobs_lock(mem);
+        long long id = atomic_load(&mem->jobs_added);
+        if (slot_free(mem, id)) {
+            StreamJob *j = job_at(mem, id);
+            j->id = -1;
+            atomic_thread_fence(memory_order_release);
+            j->base = atomic_load(&mem->jobs_end);
+            j->bytes = (long long)st.st_size;
+            strcpy(j->src, src);
+            strcpy(j->dst, dst);
+            atomic_thread_fence(memory_order_release);
+            j->id = id;
+            atomic_store(&mem->jobs_added, id + 1); // antes que jobs_end: todo
+            atomic_store(&mem->jobs_end, j->base + j->bytes); // seq reclamable ya tiene trabajo
+            jobs_unlock(mem);
+            sync_notify(&mem->sync, SYNC_EV_JOBS, INT_MAX);
+            return id;
+        }
+        jobs_unlock(mem);
+        if (!wait) {
+            errno = ENOSPC;
+            fprintf(stderr, "Tabla de trabajos llena (%d sin persistir)\n", mem->jobs_max);
+            return -1;
+        }
+
+        // Esperar a que next_to_flush libere la entrada más vieja
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_WINDOW);
+        if (slot_free(mem, id)) { sync_cancel(&mem->sync, SYNC_EV_WINDOW); continue; }
+        if (sync_sleep(&mem->sync, SYNC_EV_WINDOW, snap) == -1) { perror("esperando lugar en la tabla"); return -1; }
+    }
+}
+
+long long stream_enqueue_list(SharedMemory *mem, FILE *list, const char *name, int wait) {
+    char line[2 * PATH_MAX + 16];
+    long long count = 0;
+    for (int n = 1; fgets(line, sizeof(line), list); n++) {
+        char *save, *src = strtok_r(line, " \t\r\n", &save);
+        if (!src || *src == '#') continue;
+        char *dst = strtok_r(NULL, " \t\r\n", &save);
+        if (!dst || strtok_r(NULL, " \t\r\n", &save)) {
+            fprintf(stderr, "%s:%d: se esperaba \"<fuente> <destino>\"\n", name, n);
+            return -1;
+        }
+        if (stream_enqueue(mem, src, dst, wait) == -1) return -1;
+        count++;
+    }
+    return count;
+}
+
+/* --------------------------------------------------------------------------
+   Emisores
+   -------------------------------------------------------------------------- */
+long long stream_claim(SharedMemory *mem, int chunk, long long *pos) {
+    long long p = atomic_load(&mem->next_pos);
+    for (;;) {
+        long long end = atomic_load(&mem->jobs_end);
+        if (p >= end) return 0;
+        long long n = (end - p < chunk) ? end - p : chunk;
+        if (atomic_compare_exchange_weak(&mem->next_pos, &p, p + n)) {
+            *pos = p;
+            return n;
+        }
+    }
+}
+
+static int nothing_queued(SharedMemory *mem) {
+    return !sync_is_draining(&mem->sync) &&
+           atomic_load(&mem->next_pos) >= atomic_load(&mem->jobs_end);
+}
+
+int stream_wait(SharedMemory *mem) {
+    while (nothing_queued(mem)) {
+        unsigned snap = sync_prepare(&mem->sync, SYNC_EV_JOBS);
+        if (!nothing_queued(mem)) { sync_cancel(&mem->sync, SYNC_EV_JOBS); break; }
+        if (sync_sleep(&mem->sync, SYNC_EV_JOBS, snap) == -1) return -1;
+    }
+    return 0;
+}
+
+long long stream_done(SharedMemory *mem) {
+    long long flushed = atomic_load(&mem->next_to_flush);
+    long long added = atomic_load(&mem->jobs_added);
+    long long id = added - mem->jobs_max;
+    if (id < 0) id = 0;
+    for (; id < added; id++) {
+        StreamJob *j = job_at(mem, id);
+        if (j->id == id && j->base + j->bytes > flushed) break;
+    }
+    return id;
+}
+
+/* --------------------------------------------------------------------------
+   Archivos por trabajo
+   -------------------------------------------------------------------------- */
+void stream_file_init(StreamFile *f, int write) {
+    memset(f, 0, sizeof(*f));
+    f->id = -1;
+    f->fd = -1;
+    f->write = write;
+}
+
+void stream_file_close(StreamFile *f) {
+    if (f->fd != -1) close(f->fd);
+    f->fd = -1;
+    f->id = -1;
+}
+
+// Deja abierto el trabajo que contiene seq. 0, 1 si no hay trabajo (pasó
+// jobs_end o se recicló), -1 con errno (también si la fuente no se puede
+// abrir: el tramo sigue en arriendo y se reintenta).
+static int file_seek_job(StreamFile *f, SharedMemory *mem, long long seq) {
+    if (f->id >= 0 && seq >= f->base && seq < f->base + f->bytes) return 0;
+    stream_file_close(f);
+    long long id = job_find(mem, seq);
+    if (id == -1) return 1;
+
+    StreamJob *j = job_at(mem, id);
+    char path[PATH_MAX];
+    long long base = j->base, bytes = j->bytes;
+    strcpy(path, f->write ? j->dst : j->src);
+    atomic_thread_fence(memory_order_acquire);
+    if (j->id != id) return 1; // se recicló mientras se copiaba
+    if (seq < base || seq >= base + bytes) return 1;
+
+    int fd = open(path, f->write ? O_WRONLY : O_RDONLY);
+    if (fd == -1) return -1;
+    f->fd = fd;
+    f->id = id;
+    f->base = base;
+    f->bytes = bytes;
+    return 0;
+}
+
+ssize_t stream_read(StreamFile *f, SharedMemory *mem, long long seq, char *buf, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        long long s = seq + (long long)done;
+        int rc = file_seek_job(f, mem, s);
+        if (rc == -1) return -1;
+        if (rc == 1) {
+            if (s >= atomic_load(&mem->jobs_end)) break;
+            errno = ESTALE;
+            return -1;
+        }
+        size_t want = n - done;
+        if ((long long)want > f->base + f->bytes - s) want = (size_t)(f->base + f->bytes - s);
+        size_t got = 0;
+        while (got < want) {
+            ssize_t r = pread(f->fd, buf + done + got, want - got, (off_t)(s - f->base + (long long)got));
+            if (r == 0) break;
+            if (r == -1) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            got += (size_t)r;
+        }
+        memset(buf + done + got, 0, want - got); // fuente acortada
+        done += want;
+    }
+    return (ssize_t)done;
+}
+
+int stream_write(StreamFile *f, SharedMemory *mem, const char *data, int n, long long seq) {
+    // Lo ya persistido (entrega repetida) puede ser de un trabajo reciclado
+    long long skip = atomic_load(&mem->next_to_flush) - seq;
+    if (skip >= n) return 0;
+    if (skip > 0) { data += skip; seq += skip; n -= (int)skip; }
+
+    int done = 0;
+    while (done < n) {
+        long long s = seq + done;
+        int rc = file_seek_job(f, mem, s);
+        if (rc == -1) return -1;
+        if (rc == 1) { errno = ESTALE; return -1; }
+        int want = n - done;
+        if (want > f->base + f->bytes - s) want = (int)(f->base + f->bytes - s);
+        for (int put = 0; put < want;) {
+            ssize_t w = pwrite(f->fd, data + done + put, (size_t)(want - put), (off_t)(s - f->base + put));
+            if (w == -1) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            put += (int)w;
+        }
+        done += want;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#ifndef STREAM_H
+#define STREAM_H
+/*
+ =============================================================================
+  Archivo: stream.h
+  Propósito:
+    Cola de flujos: un segmento de larga vida transporta muchos pares
+    (fuente, destino) a la vez, sin volver a correr Inicializador y
+    Finalizador por archivo.
+
+  Resumen funcional:
+    - La tabla de trabajos (StreamJob, en el segmento tras la ventana)
+      asigna a cada trabajo un tramo contiguo del espacio global de seq:
+      [base, base + bytes), en orden de llegada. El seq de cada ranura o
+      registro identifica así su flujo sin campos extra, y el anillo, el
+      orden de reclamo, la ventana y la recuperación siguen iguales.
+    - Progreso por flujo: lo reclamado es next_pos - base y lo persistido
+      next_to_flush - base (acotados a [0, bytes]).
+    - Quien encola (Inicializador con -J, o el encolador) crea el destino
+      al tamaño de la fuente, llena la entrada y recién entonces avanza
+      jobs_end y avisa SYNC_EV_JOBS.
+    - Los Emisores reclaman hasta jobs_end y duermen en SYNC_EV_JOBS si
+      no queda nada; un tramo puede cruzar de un archivo al siguiente.
+    - Los Receptores escriben cada tramo con pwrite en el destino de su
+      trabajo (desplazamiento seq - base); la ventana solo lleva la marca
+      de completitud, como en OUTPUT_PWRITE.
+    - Cada proceso mantiene abierto un solo archivo por dirección
+      (StreamFile) y lo cambia al pasar de un trabajo a otro: con miles de
+      archivos chicos no se agotan los descriptores.
+
+  Restricciones:
+    - Salida posicional (pwrite) y fuente por pread; sin registros por
+      línea (una línea no puede cruzar de un archivo a otro) ni puntos de
+      control (cada destino queda completo o se vuelve a encolar).
+    - Una fuente que se acorta después de encolada se completa con ceros.
+      Una que se borra o no se puede leer no se entrega: el Emisor sale
+      con error y el tramo queda en arriendo hasta que recover.c lo pueda
+      leer.
+ =============================================================================
+*/
+#include <stdio.h>
+#include <sys/types.h>
+#include "shared.h"
+
+// Archivo abierto de un trabajo (fuente o destino) dentro de un proceso
+typedef struct {
+    long long id;        // trabajo abierto (-1 = ninguno)
+    long long base;      // su primer seq
+    long long bytes;     // su tamaño
+    int fd;
+    int write;           // 1 = destino, 0 = fuente
+} StreamFile;
+
+// Bytes de segmento de una tabla de jobs_max trabajos
+size_t stream_bytes(int jobs_max);
+
+// Ubica la tabla en el desplazamiento offset del segmento, vacía
+void stream_init(SharedMemory *mem, size_t offset, int jobs_max);
+
+// Encola (src, dst): crea dst al tamaño de src y publica el trabajo.
+// Con wait espera (SYNC_EV_WINDOW) si la tabla está llena; sin wait
+// falla con errno = ENOSPC. Devuelve el id, o -1 con un mensaje en stderr.
+long long stream_enqueue(SharedMemory *mem, const char *src, const char *dst, int wait);
+
+// Encola los pares "fuente destino" de list (uno por línea, '#' comenta).
+// Cantidad encolada, o -1 al primer error.
+long long stream_enqueue_list(SharedMemory *mem, FILE *list, const char *name, int wait);
+
+// Reclama hasta chunk bytes desde next_pos sin pasar jobs_end. Devuelve los
+// bytes reclamados (posición en *pos) o 0 si no hay nada encolado.
+long long stream_claim(SharedMemory *mem, int chunk, long long *pos);
+
+// Espera a que haya algo por reclamar o empiece el drenaje. 0, o -1 con
+// errno = EIDRM si se retiraron los IPC.
+int stream_wait(SharedMemory *mem);
+
+// Trabajos encolados y los ya persistidos por completo
+long long stream_done(SharedMemory *mem);
+
+// Apertura perezosa por trabajo (write: destinos)
+void stream_file_init(StreamFile *f, int write);
+void stream_file_close(StreamFile *f);
+
+// Lee n bytes de los seq [seq, seq + n) cruzando trabajos; lo que falte de
+// una fuente acortada se completa con ceros. Bytes leídos (menos si se
+// llega a jobs_end), o -1 con errno si una fuente no se puede abrir o leer.
+ssize_t stream_read(StreamFile *f, SharedMemory *mem, long long seq, char *buf, size_t n);
+
+// Escribe n bytes de los seq [seq, seq + n) en los destinos. Lo que cae en
+// trabajos ya persistidos y reciclados se descarta. 0, o -1 con errno.
+int stream_write(StreamFile *f, SharedMemory *mem, const char *data, int n, long long seq);
+
+#endif
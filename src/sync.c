@@ -0,0 +1,266 @@
+/*
+ ============================================================================
+ Archivo: sync.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Primitivas de sincronización en memoria compartida (ver sync.h).
+
+    Protocolo de un ShmEvent (sin avisos perdidos):
+      Quien espera:  waiters++  ->  snap = seq  ->  revisa condición
+                     ->  FUTEX_WAIT(seq, snap)  ->  waiters--
+      Quien avisa:   cambia estado  ->  (fence)  ->  si waiters > 0:
+                     seq++ y FUTEX_WAKE(seq)
+    Si el aviso ocurre entre la revisión y el FUTEX_WAIT, seq ya cambió y
+    el kernel devuelve EAGAIN de inmediato. Las esperas futex no usan
+    FUTEX_PRIVATE_FLAG porque las palabras viven en un segmento System V
+    compartido entre procesos.
+ ============================================================================
+*/
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <sys/ipc.h>
+#include <sys/sem.h>
+#include <limits.h>
+#include <errno.h>
+#include "sync.h"
+#include "latency.h"
+
+/* --------------------------------------------------------------------------
+   Envolturas de futex y semop
+   -------------------------------------------------------------------------- */
+static int futex_wait(_Atomic unsigned int *addr, unsigned int expected, const struct timespec *timeout) {
+    // EAGAIN (valor ya cambió), EINTR y ETIMEDOUT se resuelven reintentando arriba
+    return (int)syscall(SYS_futex, (unsigned int *)addr, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static void futex_wake(_Atomic unsigned int *addr, int n) {
+    syscall(SYS_futex, (unsigned int *)addr, FUTEX_WAKE, n, NULL, NULL, 0);
+}
+
+/* --------------------------------------------------------------------------
+   Gancho de espera prolongada (sync_on_stall)
+   -------------------------------------------------------------------------- */
+static void (*stall_hook)(void *);
+static void *stall_arg;
+static int in_stall;
+
+void sync_on_stall(void (*hook)(void *), void *arg) {
+    stall_hook = hook;
+    stall_arg = arg;
+}
+
+static int stall_armed(void) {
+    return stall_hook && !in_stall;
+}
+
+static void run_stall_hook(void) {
+    in_stall = 1;
+    stall_hook(stall_arg);
+    in_stall = 0;
+}
+
+// pid propio (getpid() no se cachea en glibc y el mutex lo usa en cada toma)
+static int self_pid(void) {
+    static int pid;
+    if (!pid) pid = (int)getpid();
+    return pid;
+}
+
+// El mutex deshace su operación si el proceso muere con él tomado
+static short sem_flags(int sem_num) {
+    return (sem_num == SYNC_EV_MUTEX) ? SEM_UNDO : 0;
+}
+
+// Disminuye el valor del semáforo en n (wait)
+static int sem_wait_raw(int sem_id, int sem_num, int n) {
+    struct sembuf op = {sem_num, -n, sem_flags(sem_num)};
+    if (!stall_armed()) return semop(sem_id, &op, 1);
+    struct timespec t = {SYNC_STALL_NS / 1000000000LL, SYNC_STALL_NS % 1000000000LL};
+    for (;;) {
+        if (semtimedop(sem_id, &op, 1, &t) == 0) return 0;
+        if (errno != EAGAIN) return -1;
+        run_stall_hook();
+    }
+}
+// Incrementa el valor del semáforo en n (signal)
+static int sem_signal_raw(int sem_id, int sem_num, int n) {
+    struct sembuf op = {sem_num, n, sem_flags(sem_num)};
+    return semop(sem_id, &op, 1);
+}
+
+/* --------------------------------------------------------------------------
+   Tiempo bloqueado del proceso (sync_account)
+   -------------------------------------------------------------------------- */
+static _Atomic long long *blocked_ns;
+
+// Clase de espera de cada evento (los semáforos coinciden con sus eventos)
+static int ev_wait_class(int ev) {
+    switch (ev) {
+    case SYNC_EV_MUTEX:  return SYNC_WAIT_MUTEX;
+    case SYNC_EV_EMPTY:  return SYNC_WAIT_EMPTY;
+    case SYNC_EV_FULL:   return SYNC_WAIT_FULL;
+    case SYNC_EV_DATA:   return SYNC_WAIT_FULL;
+    case SYNC_EV_WINDOW: return SYNC_WAIT_WINDOW;
+    default:             return SYNC_WAIT_EMPTY; // SYNC_EV_SPACE + k
+    }
+}
+
+void sync_account(_Atomic long long *counters) {
+    blocked_ns = counters;
+}
+
+static void account_blocked(int ev, long long since) {
+    if (!blocked_ns) return;
+    _Atomic long long *c = &blocked_ns[ev_wait_class(ev)];
+    long long cur = atomic_load_explicit(c, memory_order_relaxed);
+    atomic_store_explicit(c, cur + (lat_now() - since), memory_order_relaxed);
+}
+
+/* --------------------------------------------------------------------------
+   Inicialización y cierre
+   -------------------------------------------------------------------------- */
+void sync_init(ShmSync *s, int mode, int empty) {
+    s->mode = mode;
+    atomic_store(&s->shutdown, 0);
+    atomic_store(&s->draining, 0);
+    atomic_store(&s->mutex_owner, 0);
+    atomic_store(&s->sem_value[0], 1);      // mutex
+    atomic_store(&s->sem_value[1], empty);  // empty
+    atomic_store(&s->sem_value[2], 0);      // full
+    for (int i = 0; i < SYNC_EV_COUNT; i++) {
+        atomic_store(&s->ev[i].seq, 0);
+        atomic_store(&s->ev[i].waiters, 0);
+    }
+}
+
+int sync_is_shutdown(ShmSync *s) {
+    return atomic_load_explicit(&s->shutdown, memory_order_relaxed) != 0;
+}
+
+int sync_is_draining(ShmSync *s) {
+    return atomic_load_explicit(&s->draining, memory_order_relaxed) != 0;
+}
+
+void sync_drain(ShmSync *s) {
+    atomic_store(&s->draining, 1);
+    sync_notify(s, SYNC_EV_JOBS, INT_MAX);
+}
+
+void sync_shutdown(ShmSync *s) {
+    atomic_store(&s->shutdown, 1);
+    for (int i = 0; i < SYNC_EV_COUNT; i++) {
+        atomic_fetch_add(&s->ev[i].seq, 1);
+        futex_wake(&s->ev[i].seq, INT_MAX);
+    }
+}
+
+/* --------------------------------------------------------------------------
+   Eventos
+   -------------------------------------------------------------------------- */
+unsigned sync_prepare(ShmSync *s, int ev) {
+    atomic_fetch_add(&s->ev[ev].waiters, 1);
+    return atomic_load(&s->ev[ev].seq);
+}
+
+void sync_cancel(ShmSync *s, int ev) {
+    atomic_fetch_sub(&s->ev[ev].waiters, 1);
+}
+
+int sync_sleep(ShmSync *s, int ev, unsigned snap) {
+    return sync_sleep_for(s, ev, snap, -1);
+}
+
+int sync_sleep_for(ShmSync *s, int ev, unsigned snap, long long ns) {
+    int hook = (ns < 0 && stall_armed());
+    int timed_out = 0;
+    if (hook) ns = SYNC_STALL_NS;
+    if (!sync_is_shutdown(s)) {
+        long long since = blocked_ns ? lat_now() : 0;
+        struct timespec t = {ns / 1000000000LL, ns % 1000000000LL};
+        timed_out = futex_wait(&s->ev[ev].seq, snap, ns >= 0 ? &t : NULL) == -1 && errno == ETIMEDOUT;
+        account_blocked(ev, since);
+    }
+    atomic_fetch_sub(&s->ev[ev].waiters, 1);
+    if (sync_is_shutdown(s)) { errno = EIDRM; return -1; }
+    if (hook && timed_out) run_stall_hook();
+    return 0;
+}
+
+void sync_notify(ShmSync *s, int ev, int n) {
+    atomic_thread_fence(memory_order_seq_cst); // publica el estado antes de leer waiters
+    if (atomic_load_explicit(&s->ev[ev].waiters, memory_order_relaxed) <= 0) return;
+    atomic_fetch_add(&s->ev[ev].seq, 1);
+    futex_wake(&s->ev[ev].seq, n);
+}
+
+/* --------------------------------------------------------------------------
+   Semáforos clásicos
+   -------------------------------------------------------------------------- */
+
+// Intenta restar n sin bloquear (todo o nada); 1 si lo logró
+static int fsem_trydown(_Atomic int *v, int n) {
+    int cur = atomic_load_explicit(v, memory_order_relaxed);
+    while (cur >= n) {
+        if (atomic_compare_exchange_weak(v, &cur, cur - n)) return 1;
+    }
+    return 0;
+}
+
+int sync_wait(ShmSync *s, int sem_id, int sem_num, int n) {
+    if (s->mode == SYNC_SEMOP) {
+        if (!blocked_ns) return sem_wait_raw(sem_id, sem_num, n);
+        // Se mide solo si el intento sin espera no alcanza
+        struct sembuf op = {sem_num, -n, IPC_NOWAIT | sem_flags(sem_num)};
+        if (semop(sem_id, &op, 1) == 0) return 0;
+        if (errno != EAGAIN) return -1;
+        long long since = lat_now();
+        int rc = sem_wait_raw(sem_id, sem_num, n);
+        account_blocked(sem_num, since);
+        return rc;
+    }
+
+    if (sync_is_shutdown(s)) { errno = EIDRM; return -1; }
+    _Atomic int *v = &s->sem_value[sem_num];
+    while (!fsem_trydown(v, n)) {
+        unsigned snap = sync_prepare(s, sem_num);
+        if (fsem_trydown(v, n)) { sync_cancel(s, sem_num); break; }
+        if (sync_sleep(s, sem_num, snap) == -1) return -1;
+    }
+    if (sem_num == SYNC_EV_MUTEX) atomic_store_explicit(&s->mutex_owner, self_pid(), memory_order_relaxed);
+    return 0;
+}
+
+int sync_trywait(ShmSync *s, int sem_id, int sem_num, int n) {
+    if (s->mode == SYNC_SEMOP) {
+        struct sembuf op = {sem_num, -n, IPC_NOWAIT | sem_flags(sem_num)};
+        if (semop(sem_id, &op, 1) == 0) return 1;
+        return (errno == EAGAIN) ? 0 : -1;
+    }
+    if (sync_is_shutdown(s)) { errno = EIDRM; return -1; }
+    return fsem_trydown(&s->sem_value[sem_num], n);
+}
+
+int sync_post(ShmSync *s, int sem_id, int sem_num, int n) {
+    if (s->mode == SYNC_SEMOP) return sem_signal_raw(sem_id, sem_num, n);
+
+    if (sync_is_shutdown(s)) { errno = EIDRM; return -1; }
+    if (sem_num == SYNC_EV_MUTEX) atomic_store_explicit(&s->mutex_owner, 0, memory_order_relaxed);
+    atomic_fetch_add(&s->sem_value[sem_num], n);
+    // empty/full admiten esperas de distinto tamaño (rangos): se despierta a
+    // todos para que quien pueda avanzar no se pierda el aviso. El mutex
+    // siempre se toma de a 1, así que basta con despertar a uno.
+    sync_notify(s, sem_num, sem_num == SYNC_EV_MUTEX ? 1 : INT_MAX);
+    return 0;
+}
+
+int sync_release_dead(ShmSync *s, int pid) {
+    if (s->mode != SYNC_FUTEX) return 0; // SEM_UNDO
+    int owner = pid;
+    if (!atomic_compare_exchange_strong(&s->mutex_owner, &owner, 0)) return 0;
+    atomic_fetch_add(&s->sem_value[SYNC_EV_MUTEX], 1);
+    sync_notify(s, SYNC_EV_MUTEX, 1);
+    return 1;
+}
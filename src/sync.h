@@ -0,0 +1,148 @@
+#ifndef SYNC_H
+#define SYNC_H
+/*
+ =============================================================================
+  Archivo: sync.h
+  Propósito:
+    Primitivas de sincronización compartidas por Emisor, Receptor,
+    Finalizador y el buffer circular. Reemplaza las copias de
+    sem_wait_raw/sem_signal_raw que vivían en cada proceso.
+
+  Resumen funcional:
+    - ShmEvent: contador de eventos (eventcount) sobre una palabra futex
+      dentro del segmento. Quien espera se anota en waiters y duerme con
+      FUTEX_WAIT; quien avisa solo hace FUTEX_WAKE si ve a alguien anotado.
+      Sin contención ninguna de las dos partes entra al kernel.
+    - Semáforos clásicos (mutex/empty/full): según sync_mode se implementan
+      con semop() (SYNC_SEMOP, compatibilidad) o con un contador atómico más
+      un ShmEvent (SYNC_FUTEX).
+    - draining: palabra que el Finalizador activa al pedir el cierre. Los
+      Emisores dejan de reclamar tramos nuevos (terminan el que tienen) y
+      el Finalizador duerme en SYNC_EV_DRAIN hasta que todo lo reclamado
+      se haya persistido, con un plazo máximo.
+    - shutdown: palabra que el Finalizador activa antes de retirar los IPC.
+      Toda espera que la observe devuelve -1 con errno = EIDRM, igual que
+      semop() cuando el conjunto de semáforos fue removido, para que los
+      procesos sigan terminando "en forma normal".
+    - Procesos caídos: el mutex en modo semop usa SEM_UNDO (el kernel lo
+      devuelve si el dueño muere) y en modo futex guarda el pid del dueño
+      en mutex_owner para que otro lo suelte (sync_release_dead). Si el
+      proceso registró un gancho con sync_on_stall(), toda espera sin
+      plazo se corta cada SYNC_STALL_NS y llama al gancho, que revisa si
+      algún proceso murió con algo en mano (recover.h).
+    - Tiempo bloqueado: si el proceso registró sus contadores con
+      sync_account(), cada espera que de verdad duerme (futex o semop sin
+      IPC_NOWAIT) suma su duración según la clase SYNC_WAIT_*.
+ =============================================================================
+*/
+#include <stdatomic.h>
+
+/* -------------------------------
+   Modos de sincronización
+   ------------------------------- */
+#define SYNC_SEMOP  0   // semáforos System V (semop)
+#define SYNC_FUTEX  1   // palabras futex en la memoria compartida
+
+/* -------------------------------
+   Eventos disponibles en el segmento
+   (los tres primeros coinciden con SEM_MUTEX/SEM_EMPTY/SEM_FULL)
+   ------------------------------- */
+#define SHARD_MAX 64    // fragmentos máximos del anillo (ring.h)
+
+enum {
+    SYNC_EV_MUTEX = 0,  // semáforo mutex (modo futex)
+    SYNC_EV_EMPTY,      // semáforo empty (modo futex)
+    SYNC_EV_FULL,       // semáforo full  (modo futex)
+    SYNC_EV_DATA,       // anillo lock-free: se publicó una celda (cualquier fragmento)
+    SYNC_EV_WINDOW,     // ventana de reordenamiento: avanzó next_to_flush
+    SYNC_EV_CLAIM,      // orden de reclamo: avanzó next_claim
+    SYNC_EV_DRAIN,      // drenaje: salió un proceso o avanzó next_to_flush
+    SYNC_EV_JOBS,       // cola de flujos o ingesta: hay más por reclamar o empezó el drenaje
+    SYNC_EV_SPACE,      // anillo lock-free: se liberó una celda del fragmento
+                        // k (evento SYNC_EV_SPACE + k, uno por fragmento)
+    SYNC_EV_COUNT = SYNC_EV_SPACE + SHARD_MAX
+};
+
+/* -------------------------------
+   Clases de espera (tiempo bloqueado)
+   ------------------------------- */
+#define SYNC_WAIT_MUTEX   0   // mutex del anillo (modo semáforos)
+#define SYNC_WAIT_EMPTY   1   // sin espacio: semáforo empty / SYNC_EV_SPACE
+#define SYNC_WAIT_FULL    2   // sin datos: semáforo full / SYNC_EV_DATA
+#define SYNC_WAIT_WINDOW  3   // ventana de reordenamiento llena
+#define SYNC_WAIT_COUNT   4
+
+#define SYNC_STALL_NS  200000000LL // espera máxima entre revisiones del gancho (0.2 s)
+
+// Cada evento ocupa su propia línea de caché: los de emisores y los de
+// receptores no se invalidan entre sí.
+typedef struct {
+    _Alignas(64) _Atomic unsigned int seq; // palabra futex: cambia en cada aviso
+    _Atomic int waiters;        // procesos anotados para dormir
+} ShmEvent;
+
+typedef struct {
+    int mode;                        // SYNC_SEMOP | SYNC_FUTEX
+    _Atomic int shutdown;            // 1 = el Finalizador retiró los IPC
+    _Atomic int draining;            // 1 = cierre pedido: no hay tramos nuevos
+    _Atomic int mutex_owner;         // pid que tiene el mutex (modo futex; 0 = libre)
+    _Atomic int sem_value[3];        // valores de mutex/empty/full (modo futex)
+    ShmEvent ev[SYNC_EV_COUNT];
+} ShmSync;
+
+// Deja los semáforos en {1, empty, 0} y todos los eventos en reposo
+void sync_init(ShmSync *s, int mode, int empty);
+
+/* ---- Semáforos clásicos (P/V) sobre semop o futex ----
+   n es la cantidad a restar/sumar en una sola operación (semop con
+   sem_op = -n / +n). Devuelven 0 en éxito, -1 con errno (EIDRM/EINVAL =
+   IPC retirados). */
+int sync_wait(ShmSync *s, int sem_id, int sem_num, int n);
+int sync_post(ShmSync *s, int sem_id, int sem_num, int n);
+// Resta n solo si puede hacerlo sin bloquear (semop con IPC_NOWAIT):
+// 1 si lo logró, 0 si no alcanzaba, -1 con errno.
+int sync_trywait(ShmSync *s, int sem_id, int sem_num, int n);
+
+/* ---- Eventos ----
+   Patrón de espera (cond = condición que se espera):
+       while (!cond()) {
+           unsigned snap = sync_prepare(s, ev);
+           if (cond()) { sync_cancel(s, ev); break; }
+           if (sync_sleep(s, ev, snap) == -1) return -1;
+       }
+   El lado que cambia el estado llama a sync_notify() después. */
+unsigned sync_prepare(ShmSync *s, int ev);
+void     sync_cancel(ShmSync *s, int ev);
+int      sync_sleep(ShmSync *s, int ev, unsigned snap);
+// Como sync_sleep, pero duerme a lo sumo ns nanosegundos (el llamador
+// vuelve a evaluar la condición y su plazo)
+int      sync_sleep_for(ShmSync *s, int ev, unsigned snap, long long ns);
+void     sync_notify(ShmSync *s, int ev, int n);
+
+// Contadores del proceso actual (SYNC_WAIT_COUNT posiciones, en ns) donde
+// se acumula el tiempo bloqueado; NULL deja de medir. Solo este proceso
+// los escribe.
+void sync_account(_Atomic long long *blocked_ns);
+
+// Gancho de espera prolongada del proceso actual (NULL lo quita). Con él
+// registrado, las esperas sin plazo (sync_wait, sync_sleep) despiertan cada
+// SYNC_STALL_NS sin aviso y llaman a hook(arg); el llamador vuelve a evaluar
+// su condición como en cualquier despertar. El gancho no se anida: dentro
+// de él las esperas son las normales.
+void sync_on_stall(void (*hook)(void *), void *arg);
+
+// Suelta el mutex si lo tiene el proceso pid (modo futex; en modo semop lo
+// devuelve SEM_UNDO). 1 si lo soltó.
+int  sync_release_dead(ShmSync *s, int pid);
+
+// 1 si el Finalizador ya pidió el cierre
+int  sync_is_shutdown(ShmSync *s);
+// Activa shutdown y despierta a todos los que duermen en cualquier evento
+void sync_shutdown(ShmSync *s);
+
+// Drenaje: 1 si el Finalizador ya lo pidió / lo activa (y despierta a
+// quien espera trabajos: no llegarán más)
+int  sync_is_draining(ShmSync *s);
+void sync_drain(ShmSync *s);
+
+#endif
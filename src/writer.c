@@ -0,0 +1,635 @@
+/*
+ ============================================================================
+ Archivo: writer.c
+ Proyecto: Comunicación de Procesos Sincronizada
+ Curso: CE4303 - Principios de Sistemas Operativos
+ Descripción:
+    Escritor de la salida posicional (ver writer.h).
+
+    Ciclo de un pedido (reqs[i], arriendo en self->inflight[i]):
+      FREE -> FLIGHT (uring: escrituras enviadas) -> WRITTEN (en el archivo;
+      en group espera fdatasync) -> READY -> marcado en la ventana -> FREE.
+    Los motores síncronos pasan directo de FREE a WRITTEN. Se marca siempre
+    el pedido de seq más bajo primero: si no está READY, los demás esperan.
+    Si su escritura o su fdatasync falla pasa a FAILED: no se marca nunca,
+    sigue en arriendo y el escritor falla desde ahí (w->err) para que el
+    Receptor salga y recover.c lo vuelva a entregar.
+
+    io_uring sin liburing: io_uring_setup/io_uring_enter por syscall y los
+    anillos SQ/CQ mapeados del descriptor. Cada escritura lleva en
+    user_data el pedido y la pieza (cabeza, bloques alineados, cola).
+ ============================================================================
+*/
+#define _GNU_SOURCE
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "writer.h"
+#include "reorder.h"
+#include "latency.h"
+
+#define REQ_FREE     0
+#define REQ_FLIGHT   1   // escrituras en vuelo (uring)
+#define REQ_WRITTEN  2   // en el archivo, esperando fdatasync (group)
+#define REQ_READY    3   // listo para marcar
+#define REQ_FAILED   4   // escritura o fdatasync fallido: nunca se marca
+
+#define URING_ENTRIES 256 // >= 3 piezas por pedido en vuelo (PROC_INFLIGHT)
+
+/* --------------------------------------------------------------------------
+   Opciones
+   -------------------------------------------------------------------------- */
+int writer_backend(const char *name) {
+    if (strcmp(name, "auto") == 0)    return WRITER_AUTO;
+    if (strcmp(name, "pwrite") == 0)  return WRITER_PWRITE;
+    if (strcmp(name, "pwritev") == 0) return WRITER_PWRITEV;
+    if (strcmp(name, "uring") == 0)   return WRITER_URING;
+    return -1;
+}
+
+const char *writer_name(int backend) {
+    switch (backend) {
+    case WRITER_PWRITE:  return "pwrite";
+    case WRITER_PWRITEV: return "pwritev";
+    case WRITER_URING:   return "io_uring";
+    default:             return "auto";
+    }
+}
+
+// "4096", "64K" o "8M"; -1 si no es válido
+static long long parse_bytes(const char *txt) {
+    char *end;
+    long long v = strtoll(txt, &end, 10);
+    if (end == txt || v <= 0) return -1;
+    switch (*end) {
+    case 'k': case 'K': v <<= 10; end++; break;
+    case 'm': case 'M': v <<= 20; end++; break;
+    case 'g': case 'G': v <<= 30; end++; break;
+    default: break;
+    }
+    return (*end == '\0') ? v : -1;
+}
+
+int writer_durability(const char *spec, int *mode, long long *arg) {
+    if (strcmp(spec, "none") == 0) {
+        *mode = DURABLE_NONE;
+        *arg = 0;
+        return 0;
+    }
+    if (strncmp(spec, "periodic:", 9) == 0) {
+        char *end;
+        long long ms = strtoll(spec + 9, &end, 10);
+        if (end == spec + 9 || *end != '\0' || ms < 1) {
+            fprintf(stderr, "Período inválido: %s (milisegundos)\n", spec + 9);
+            return -1;
+        }
+        *mode = DURABLE_PERIODIC;
+        *arg = ms;
+        return 0;
+    }
+    if (strncmp(spec, "group:", 6) == 0) {
+        long long bytes = parse_bytes(spec + 6);
+        if (bytes < 1) { fprintf(stderr, "Grupo inválido: %s (bytes, admite K/M/G)\n", spec + 6); return -1; }
+        *mode = DURABLE_GROUP;
+        *arg = bytes;
+        return 0;
+    }
+    fprintf(stderr, "Durabilidad desconocida: %s (use none|periodic:MS|group:BYTES)\n", spec);
+    return -1;
+}
+
+/* --------------------------------------------------------------------------
+   Escrituras síncronas
+   -------------------------------------------------------------------------- */
+static int write_all(int fd, const char *p, size_t n, long long off) {
+    while (n > 0) {
+        ssize_t w = pwrite(fd, p, n, (off_t)off);
+        if (w == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += w;
+        n -= (size_t)w;
+        off += w;
+    }
+    return 0;
+}
+
+static int writev_all(int fd, struct iovec *iov, int cnt, long long off) {
+    while (cnt > 0) {
+        ssize_t w = pwritev(fd, iov, cnt, (off_t)off);
+        if (w == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        off += w;
+        while (cnt > 0 && (size_t)w >= iov->iov_len) { w -= (ssize_t)iov->iov_len; iov++; cnt--; }
+        if (cnt > 0) { iov->iov_base = (char *)iov->iov_base + w; iov->iov_len -= (size_t)w; }
+    }
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+   io_uring
+   -------------------------------------------------------------------------- */
+static int uring_setup(WriterUring *u) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(u, 0, sizeof(*u));
+    u->fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+    if (u->fd == -1) return -1;
+
+    u->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+        if (u->cq_len > u->sq_len) u->sq_len = u->cq_len;
+        u->cq_len = u->sq_len;
+    }
+    u->sq_ring = mmap(NULL, u->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      u->fd, IORING_OFF_SQ_RING);
+    if (u->sq_ring == MAP_FAILED) goto fail;
+    u->cq_ring = single ? u->sq_ring
+                        : mmap(NULL, u->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                               u->fd, IORING_OFF_CQ_RING);
+    if (u->cq_ring == MAP_FAILED) goto fail;
+    u->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   u->fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) goto fail;
+
+    char *sq = u->sq_ring, *cq = u->cq_ring;
+    u->sq_head  = (_Atomic unsigned *)(sq + p.sq_off.head);
+    u->sq_tail  = (_Atomic unsigned *)(sq + p.sq_off.tail);
+    u->sq_mask  = *(unsigned *)(sq + p.sq_off.ring_mask);
+    u->sq_array = (unsigned *)(sq + p.sq_off.array);
+    u->cq_head  = (_Atomic unsigned *)(cq + p.cq_off.head);
+    u->cq_tail  = (_Atomic unsigned *)(cq + p.cq_off.tail);
+    u->cq_mask  = *(unsigned *)(cq + p.cq_off.ring_mask);
+    u->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+
+fail: {
+        int err = errno;
+        if (u->sqes && u->sqes != MAP_FAILED) munmap(u->sqes, u->sqes_len);
+        if (u->cq_ring && u->cq_ring != MAP_FAILED && !single) munmap(u->cq_ring, u->cq_len);
+        if (u->sq_ring && u->sq_ring != MAP_FAILED) munmap(u->sq_ring, u->sq_len);
+        close(u->fd);
+        memset(u, 0, sizeof(*u));
+        u->fd = -1;
+        errno = err;
+        return -1;
+    }
+}
+
+static void uring_free(WriterUring *u) {
+    if (u->fd == -1) return;
+    munmap(u->sqes, u->sqes_len);
+    if (u->cq_ring != u->sq_ring) munmap(u->cq_ring, u->cq_len);
+    munmap(u->sq_ring, u->sq_len);
+    close(u->fd);
+    u->fd = -1;
+}
+
+// Prepara una escritura (la envía el próximo uring_enter)
+static void uring_prep(WriterUring *u, int fd, const WriterPiece *pc, unsigned long long tag) {
+    unsigned tail = atomic_load_explicit(u->sq_tail, memory_order_relaxed);
+    unsigned idx = tail & u->sq_mask;
+    struct io_uring_sqe *sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long long)(uintptr_t)pc->data;
+    sqe->len = (unsigned)pc->len;
+    sqe->off = (unsigned long long)pc->off;
+    sqe->user_data = tag;
+    u->sq_array[idx] = idx;
+    atomic_store_explicit(u->sq_tail, tail + 1, memory_order_release);
+    u->queued++;
+}
+
+// Envía lo preparado y, con wait, espera al menos una terminación
+static int uring_enter(WriterUring *u, int wait) {
+    for (;;) {
+        unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+        int r = (int)syscall(__NR_io_uring_enter, u->fd, u->queued, wait ? 1 : 0, flags, NULL, 0);
+        if (r == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        u->queued -= ((unsigned)r < u->queued) ? (unsigned)r : u->queued;
+        if (u->queued == 0 || wait) return 0;
+    }
+}
+
+/* --------------------------------------------------------------------------
+   Pedidos
+   -------------------------------------------------------------------------- */
+static int settle(Writer *w, int all);
+
+static int req_alloc(Writer *w) {
+    for (;;) {
+        for (int i = 0; i < PROC_INFLIGHT; i++)
+            if (w->reqs[i].state == REQ_FREE) return i;
+        // Tabla llena: completar y marcar lo pendiente
+        if (settle(w, 1) == -1) return -1;
+    }
+}
+
+// Anota el pedido en el arriendo antes de escribir nada
+static void req_publish(Writer *w, int i) {
+    WriterReq *r = &w->reqs[i];
+    SeqRange *l = &w->self->inflight[i];
+    l->seq = r->seq;
+    atomic_thread_fence(memory_order_release);
+    l->len = r->len;
+    w->used++;
+}
+
+static void req_written(Writer *w, WriterReq *r) {
+    r->state = (w->durable == DURABLE_GROUP) ? REQ_WRITTEN : REQ_READY;
+    if (w->durable == DURABLE_GROUP) w->held += r->len;
+    w->dirty = 1;
+}
+
+// Primer error del escritor (errno actual); lo que falle queda sin marcar
+static void writer_fail(Writer *w, const char *what) {
+    int err = errno;
+    perror(what);
+    if (w->err == 0) w->err = err;
+}
+
+// 0, o -1 con errno si algo ya falló
+static int writer_status(const Writer *w) {
+    if (w->err == 0) return 0;
+    errno = w->err;
+    return -1;
+}
+
+// Piezas del pedido: con O_DIRECT, los bloques enteros aparte de los bordes
+static void req_split(Writer *w, WriterReq *r, const char *data) {
+    long long s = r->seq, e = s + r->len;
+    int n = 0;
+    memset(r->piece, 0, sizeof(r->piece));
+    if (w->dfd != -1) {
+        long long a = (s + WRITER_ALIGN - 1) / WRITER_ALIGN * WRITER_ALIGN;
+        long long b = e / WRITER_ALIGN * WRITER_ALIGN;
+        if (a < b) {
+            if (a > s) r->piece[n++] = (WriterPiece){ data, (int)(a - s), s, 0 };
+            r->piece[n++] = (WriterPiece){ data + (a - s), (int)(b - a), a, 1 };
+            if (e > b) r->piece[n++] = (WriterPiece){ data + (b - s), (int)(e - b), b, 0 };
+            r->parts = n;
+            return;
+        }
+    }
+    r->piece[0] = (WriterPiece){ data, r->len, s, 0 };
+    r->parts = 1;
+}
+
+// Sin O_DIRECT desde ahora (el sistema de archivos lo rechazó)
+static void direct_off(Writer *w) {
+    if (w->dfd == -1) return;
+    fprintf(stderr, "\n[WARN] O_DIRECT rechazado en la salida; se sigue sin él\n");
+    close(w->dfd);
+    w->dfd = -1;
+}
+
+// Escribe una pieza ya, con el respaldo sin O_DIRECT si hace falta. 0, o
+// -1 si falló (ya anotado en w->err)
+static int piece_write(Writer *w, const WriterPiece *pc) {
+    if (pc->direct && w->dfd != -1) {
+        if (write_all(w->dfd, pc->data, (size_t)pc->len, pc->off) == 0) return 0;
+        if (errno != EINVAL) { writer_fail(w, "\npwrite salida (O_DIRECT)"); return -1; }
+        direct_off(w);
+    }
+    if (write_all(w->fd, pc->data, (size_t)pc->len, pc->off) == -1) {
+        writer_fail(w, "\npwrite salida");
+        return -1;
+    }
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+   Terminaciones, durabilidad y marcas
+   -------------------------------------------------------------------------- */
+
+// Procesa las terminaciones de io_uring; con wait espera al menos una
+static int reap(Writer *w, int wait) {
+    WriterUring *u = &w->uring;
+    if (w->backend != WRITER_URING) return 0;
+    unsigned head = atomic_load_explicit(u->cq_head, memory_order_relaxed);
+    if (wait && head == atomic_load_explicit(u->cq_tail, memory_order_acquire) &&
+        uring_enter(u, 1) == -1)
+        return -1;
+
+    unsigned tail = atomic_load_explicit(u->cq_tail, memory_order_acquire);
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe = &u->cqes[head & u->cq_mask];
+        WriterReq *r = &w->reqs[cqe->user_data >> 2];
+        WriterPiece *pc = &r->piece[cqe->user_data & 3];
+        int res = cqe->res;
+        if (res == -EINVAL && pc->direct) {
+            direct_off(w);
+            if (piece_write(w, &(WriterPiece){ pc->data, pc->len, pc->off, 0 }) == -1) r->failed = 1;
+        } else if (res < 0) {
+            errno = -res;
+            writer_fail(w, "\nescritura de salida (io_uring)");
+            r->failed = 1;
+        } else if (res < pc->len) {
+            // Escritura corta: el resto, síncrono
+            if (piece_write(w, &(WriterPiece){ pc->data + res, pc->len - res, pc->off + res, 0 }) == -1)
+                r->failed = 1;
+        }
+        if (--r->parts == 0) {
+            w->stage_refs[r->stage]--;
+            r->stage = -1;
+            w->flight--;
+            if (r->failed) r->state = REQ_FAILED; else req_written(w, r);
+        }
+    }
+    atomic_store_explicit(u->cq_head, head, memory_order_release);
+    return 0;
+}
+
+// fdatasync de la salida. En group lo que esperaba pasa a READY, o a
+// FAILED si falló: tras un fdatasync fallido no se sabe qué llegó al disco
+static int data_sync(Writer *w) {
+    int rc = fdatasync(w->fd);
+    if (rc == -1) writer_fail(w, "\nfdatasync salida");
+    w->dirty = 0;
+    w->synced_ns = lat_now();
+    if (w->durable != DURABLE_GROUP) return rc;
+    for (int i = 0; i < PROC_INFLIGHT; i++)
+        if (w->reqs[i].state == REQ_WRITTEN) w->reqs[i].state = (rc == 0) ? REQ_READY : REQ_FAILED;
+    w->held = 0;
+    return rc;
+}
+
+// Marca en la ventana los pedidos listos, de seq más bajo en adelante
+static int mark_ready(Writer *w) {
+    while (w->used > 0) {
+        int low = -1;
+        for (int i = 0; i < PROC_INFLIGHT; i++)
+            if (w->reqs[i].state != REQ_FREE && (low == -1 || w->reqs[i].seq < w->reqs[low].seq)) low = i;
+        WriterReq *r = &w->reqs[low];
+        if (r->state != REQ_READY) return 0;
+
+        lat_record(&w->mem->lat[LAT_DISK], lat_now() - r->enq_ns, r->len);
+        int rc = reorder_complete(w->mem, r->len, r->seq);
+        atomic_thread_fence(memory_order_release);
+        w->self->inflight[low].len = 0;
+        r->state = REQ_FREE;
+        w->used--;
+        if (rc == -1) return -1;
+    }
+    return 0;
+}
+
+// Avanza lo pendiente sin esperar; con all, hasta que no quede nada (los
+// pedidos fallidos quedan sin marcar). -1 también si algo falló antes.
+static int settle(Writer *w, int all) {
+    for (;;) {
+        if (reap(w, 0) == -1) return -1;
+        if (w->durable == DURABLE_PERIODIC && w->dirty &&
+            lat_now() - w->synced_ns >= w->durable_arg * 1000000LL)
+            data_sync(w);
+        if (w->durable == DURABLE_GROUP && w->held > 0 &&
+            (w->held >= w->group || (all && w->flight == 0)))
+            data_sync(w);
+        if (mark_ready(w) == -1) return -1;
+        if (!all || w->used == 0) return writer_status(w);
+        if (w->flight == 0 && w->held == 0) return writer_status(w); // nada más que esperar
+        if (w->flight > 0 && reap(w, 1) == -1) return -1;
+    }
+}
+
+/* --------------------------------------------------------------------------
+   Envío de un lote
+   -------------------------------------------------------------------------- */
+
+// Un pwritev por pedido, desde los buffers del llamador
+static int submit_vectored(Writer *w) {
+    struct iovec iov[WRITER_RUNS];
+    for (int i = 0; i < w->nruns;) {
+        WriterRun *first = &w->runs[i];
+        long long end = first->seq + first->len, enq = first->enq_ns;
+        int k = 0;
+        iov[k++] = (struct iovec){ (void *)first->data, (size_t)first->len };
+        for (i++; i < w->nruns && w->runs[i].seq == end; i++) {
+            iov[k++] = (struct iovec){ (void *)w->runs[i].data, (size_t)w->runs[i].len };
+            end += w->runs[i].len;
+            if (w->runs[i].enq_ns < enq) enq = w->runs[i].enq_ns;
+        }
+
+        int q = req_alloc(w);
+        if (q == -1) return -1;
+        WriterReq *r = &w->reqs[q];
+        r->seq = first->seq;
+        r->len = (int)(end - first->seq);
+        r->enq_ns = enq;
+        r->stage = -1;
+        req_publish(w, q);
+        if (writev_all(w->fd, iov, k, r->seq) == -1) {
+            writer_fail(w, "\npwritev salida");
+            r->state = REQ_FAILED;
+        } else {
+            req_written(w, r);
+        }
+    }
+    return 0;
+}
+
+// Buffer de lote libre (espera terminaciones si están todos en vuelo)
+static int stage_get(Writer *w) {
+    int count = (w->backend == WRITER_URING) ? WRITER_DEPTH : 1;
+    for (;;) {
+        for (int i = 0; i < count; i++)
+            if (w->stage_refs[i] == 0) return i;
+        if (reap(w, 1) == -1 || mark_ready(w) == -1) return -1;
+    }
+}
+
+// Copia cada pedido a un buffer de lote (alineado como su seq con O_DIRECT)
+// y lo envía (uring) o lo escribe ya
+static int submit_staged(Writer *w) {
+    int s = stage_get(w);
+    if (s == -1) return -1;
+    char *buf = w->stage[s];
+    size_t at = 0;
+    w->stage_refs[s]++; // que ningún pedido lo libere a mitad del lote
+
+    for (int i = 0; i < w->nruns;) {
+        WriterRun *first = &w->runs[i];
+        if (w->dfd != -1)
+            at = (at + WRITER_ALIGN - 1) / WRITER_ALIGN * WRITER_ALIGN + (size_t)(first->seq % WRITER_ALIGN);
+        char *data = buf + at;
+        long long end = first->seq, enq = first->enq_ns;
+        do {
+            memcpy(buf + at, w->runs[i].data, (size_t)w->runs[i].len);
+            at += (size_t)w->runs[i].len;
+            end += w->runs[i].len;
+            if (w->runs[i].enq_ns < enq) enq = w->runs[i].enq_ns;
+            i++;
+        } while (i < w->nruns && w->runs[i].seq == end);
+
+        int q = req_alloc(w);
+        if (q == -1) { w->stage_refs[s]--; return -1; }
+        WriterReq *r = &w->reqs[q];
+        r->seq = first->seq;
+        r->len = (int)(end - first->seq);
+        r->enq_ns = enq;
+        r->failed = 0;
+        req_split(w, r, data);
+        req_publish(w, q);
+
+        if (w->backend == WRITER_URING) {
+            r->state = REQ_FLIGHT;
+            r->stage = s;
+            w->stage_refs[s]++;
+            w->flight++;
+            for (int p = 0; p < r->parts; p++)
+                uring_prep(&w->uring, r->piece[p].direct ? w->dfd : w->fd, &r->piece[p],
+                           ((unsigned long long)q << 2) | (unsigned)p);
+        } else {
+            for (int p = 0; p < r->parts; p++)
+                if (piece_write(w, &r->piece[p]) == -1) r->failed = 1;
+            r->stage = -1;
+            if (r->failed) r->state = REQ_FAILED; else req_written(w, r);
+        }
+    }
+    w->stage_refs[s]--;
+    if (w->backend == WRITER_URING && w->uring.queued > 0 && uring_enter(&w->uring, 0) == -1) return -1;
+    return 0;
+}
+
+/* --------------------------------------------------------------------------
+   Interfaz
+   -------------------------------------------------------------------------- */
+int writer_open(Writer *w, SharedMemory *mem, ProcEntry *self, int fd, const char *path,
+                int backend, int direct, int durable, long long durable_arg, size_t max_put) {
+    memset(w, 0, sizeof(*w));
+    w->mem = mem;
+    w->self = self;
+    w->fd = fd;
+    w->dfd = -1;
+    w->uring.fd = -1;
+    w->durable = durable;
+    w->durable_arg = durable_arg;
+    w->max_put = max_put;
+    w->synced_ns = lat_now();
+    for (int i = 0; i < PROC_INFLIGHT; i++) self->inflight[i].len = 0;
+
+    // Confirmación en grupo: a lo sumo media ventana sin marcar
+    w->group = durable_arg;
+    if (w->group > mem->reorder_size / 2) w->group = mem->reorder_size / 2;
+    if (w->group < 1) w->group = 1;
+
+    if (direct) {
+        w->dfd = open(path, O_WRONLY | O_DIRECT);
+        if (w->dfd == -1)
+            fprintf(stderr, "[WARN] O_DIRECT no disponible en %s (%s); se escribe sin él\n", path, strerror(errno));
+    }
+
+    // auto: io_uring solo con O_DIRECT; a la caché de páginas un pwritev
+    // termina enseguida y io_uring lo delegaría a sus hilos de trabajo
+    if (backend == WRITER_AUTO && w->dfd == -1) backend = WRITER_PWRITEV;
+    if (backend == WRITER_AUTO || backend == WRITER_URING) {
+        if (uring_setup(&w->uring) == 0) {
+            backend = WRITER_URING;
+        } else if (backend == WRITER_URING) {
+            perror("io_uring_setup");
+            if (w->dfd != -1) close(w->dfd);
+            return -1;
+        } else {
+            backend = WRITER_PWRITEV;
+        }
+    }
+    w->backend = backend;
+
+    // Buffers de lote: io_uring (en vuelo) u O_DIRECT (alineados)
+    int stages = (backend == WRITER_URING) ? WRITER_DEPTH : (w->dfd != -1) ? 1 : 0;
+    w->stage_cap = max_put + ((w->dfd != -1) ? (size_t)WRITER_RUNS * WRITER_ALIGN : 0);
+    w->stage_cap = (w->stage_cap + WRITER_ALIGN - 1) / WRITER_ALIGN * WRITER_ALIGN;
+    for (int i = 0; i < stages; i++) {
+        void *p;
+        if (posix_memalign(&p, WRITER_ALIGN, w->stage_cap) != 0) {
+            fprintf(stderr, "Sin memoria para los buffers de salida\n");
+            writer_close(w);
+            return -1;
+        }
+        w->stage[i] = p;
+    }
+    return 0;
+}
+
+int writer_deferred(const Writer *w) {
+    return w->backend != WRITER_PWRITE;
+}
+
+int writer_put(Writer *w, const char *data, int n, long long seq, long long enq_ns) {
+    // Un tramo más grande que un buffer de lote va por partes
+    while ((size_t)n > w->max_put) {
+        if (writer_put(w, data, (int)w->max_put, seq, enq_ns) == -1 || writer_submit(w) == -1) return -1;
+        data += w->max_put;
+        seq += (long long)w->max_put;
+        n -= (int)w->max_put;
+    }
+    if (n <= 0) return 0;
+    if ((w->nruns == WRITER_RUNS || w->run_bytes + n > (long long)w->max_put) && writer_submit(w) == -1)
+        return -1;
+
+    // Orden por seq al anotar (los lotes son cortos)
+    int i = w->nruns++;
+    for (; i > 0 && w->runs[i - 1].seq > seq; i--) w->runs[i] = w->runs[i - 1];
+    w->runs[i] = (WriterRun){ data, seq, n, enq_ns };
+    w->run_bytes += n;
+    return (w->backend == WRITER_PWRITE) ? writer_submit(w) : 0;
+}
+
+int writer_now(Writer *w, const char *data, int n, long long seq, long long enq_ns) {
+    if (write_all(w->fd, data, (size_t)n, seq) == -1) { perror("\n[WARN] pwrite salida (entrega directa)"); return -1; }
+    if (w->durable != DURABLE_NONE && fdatasync(w->fd) == -1) { perror("\n[WARN] fdatasync salida (entrega directa)"); return -1; }
+    lat_record(&w->mem->lat[LAT_DISK], lat_now() - enq_ns, n);
+    return reorder_complete(w->mem, n, seq);
+}
+
+int writer_submit(Writer *w) {
+    w->busy = 1;
+    int rc = 0;
+    if (w->nruns > 0)
+        rc = (w->stage[0] != NULL) ? submit_staged(w) : submit_vectored(w);
+    w->nruns = 0;
+    w->run_bytes = 0;
+    if (rc == 0) rc = settle(w, 0);
+    w->busy = 0;
+    return rc;
+}
+
+int writer_idle(Writer *w) {
+    if (w->busy || (w->used == 0 && w->nruns == 0)) return 0;
+    if (w->nruns > 0) return writer_submit(w) == -1 ? -1 : writer_idle(w);
+    w->busy = 1;
+    int rc = settle(w, 1);
+    w->busy = 0;
+    return rc;
+}
+
+void writer_close(Writer *w) {
+    w->nruns = 0; // sin writer_submit siguen en el arriendo del llamador
+    writer_idle(w);
+    uring_free(&w->uring);
+    for (int i = 0; i < WRITER_DEPTH; i++) {
+        free(w->stage[i]);
+        w->stage[i] = NULL;
+    }
+    if (w->dfd != -1) close(w->dfd);
+    w->dfd = -1;
+}
@@ -0,0 +1,184 @@
+#ifndef WRITER_H
+#define WRITER_H
+/*
+ =============================================================================
+  Archivo: writer.h
+  Propósito:
+    Escritor de la salida posicional (OUTPUT_PWRITE) del Receptor. Antes
+    cada tramo era un pwrite síncrono dentro del lote: el disco frenaba
+    directamente el consumo del anillo.
+
+  Resumen funcional:
+    - writer_put() anota un tramo ya decodificado; writer_submit() cierra
+      el lote: ordena sus tramos por seq, une los contiguos en pedidos y
+      los escribe según el motor (-w en el Receptor):
+        . pwrite : un pwrite por tramo en el mismo writer_put (lo de
+                   siempre).
+        . pwritev: síncrono, un pwritev por pedido con un iovec por
+                   tramo, sin copiar desde el lote.
+        . uring  : asíncrono con io_uring (llamadas al sistema directas,
+                   sin liburing). El pedido se copia a uno de
+                   WRITER_DEPTH buffers de lote y el Receptor sigue
+                   extrayendo mientras el kernel escribe.
+        . auto   : con O_DIRECT uring si el kernel lo permite; si no
+                   pwritev (a la caché de páginas una escritura
+                   síncrona termina enseguida, y io_uring la delegaría
+                   a sus hilos de trabajo).
+    - Un pedido se marca en la ventana (reorder_complete) recién cuando su
+      escritura terminó, y en orden de seq dentro del proceso: así
+      next_to_flush (y los puntos de control) nunca cubren bytes que no
+      están en el archivo, y marcar nunca espera a un seq propio.
+    - Lo escrito pero sin marcar sigue en arriendo (ProcEntry.inflight[]):
+      si el Receptor muere, recover.c lo vuelve a entregar desde la fuente.
+    - Un pedido cuya escritura o fdatasync falla (ENOSPC, EIO) no se marca
+      nunca: writer_submit/writer_idle devuelven -1 desde ahí, el Receptor
+      sale y recover.c entrega lo que quedó en arriendo.
+    - -D: O_DIRECT con buffers alineados a WRITER_ALIGN. De cada pedido,
+      los bloques enteros van por un descriptor O_DIRECT y los bordes
+      parciales (que otro Receptor puede estar escribiendo) por el normal.
+      Si el sistema de archivos no lo admite se sigue sin él, con aviso.
+    - Durabilidad (-d):
+        . none         : lo deja en la caché de páginas.
+        . periodic:MS  : fdatasync cada MS milisegundos; no retrasa marcas.
+        . group:BYTES  : confirmación en grupo. Lo escrito espera un
+                         fdatasync común cada BYTES (sufijos K/M/G; a lo
+                         sumo media ventana) o al quedar ocioso, y recién
+                         entonces se marca: next_to_flush solo cubre
+                         bytes durables.
+
+  Uso desde el Receptor:
+    writer_idle() antes de una extracción que va a bloquear y desde el
+    gancho de espera prolongada: completa y marca lo pendiente, para que
+    nadie espere en la ventana a un Receptor dormido.
+ =============================================================================
+*/
+#include "shared.h"
+
+#define WRITER_AUTO      0
+#define WRITER_PWRITE    1   // síncrono, un pwrite por tramo
+#define WRITER_PWRITEV   2   // síncrono, un pwritev por pedido
+#define WRITER_URING     3   // asíncrono (io_uring)
+
+#define DURABLE_NONE     0
+#define DURABLE_PERIODIC 1   // fdatasync cada durable_arg ms
+#define DURABLE_GROUP    2   // fdatasync cada durable_arg bytes antes de marcar
+
+#define WRITER_DEPTH     8      // buffers de lote en vuelo (uring / O_DIRECT)
+#define WRITER_RUNS      (PROC_LEASES + 1) // tramos por lote
+#define WRITER_ALIGN     4096   // alineación de O_DIRECT (memoria y archivo)
+
+// Tramo anotado del lote en curso (data es del llamador hasta submit)
+typedef struct {
+    const char *data;
+    long long seq;
+    int len;
+    long long enq_ns;
+} WriterRun;
+
+// Escritura del kernel de un pedido (cabeza, bloques alineados o cola)
+typedef struct {
+    const char *data;
+    int len;
+    long long off;
+    int direct;
+} WriterPiece;
+
+// Pedido: tramos contiguos en el archivo, escritos y marcados juntos
+typedef struct {
+    long long seq;
+    int len;
+    long long enq_ns;      // encolado del tramo más viejo (latencia enq→disco)
+    int state;             // REQ_* (writer.c)
+    int parts;             // escrituras en vuelo (uring)
+    int stage;             // buffer de lote que ocupa (-1 = ninguno)
+    int failed;            // alguna pieza no se pudo escribir
+    WriterPiece piece[3];
+} WriterReq;
+
+// Anillo de io_uring mapeado
+typedef struct {
+    int fd;
+    void *sq_ring, *cq_ring;
+    size_t sq_len, cq_len;
+    struct io_uring_sqe *sqes;
+    size_t sqes_len;
+    _Atomic unsigned *sq_head, *sq_tail, *cq_head, *cq_tail;
+    unsigned *sq_array;
+    unsigned sq_mask, cq_mask;
+    struct io_uring_cqe *cqes;
+    unsigned queued;       // SQE preparadas sin enviar
+} WriterUring;
+
+typedef struct {
+    int backend;           // WRITER_* (ya resuelto, nunca AUTO)
+    int durable;           // DURABLE_*
+    long long durable_arg; // ms (periodic) o bytes (group)
+    SharedMemory *mem;
+    ProcEntry *self;
+    int fd;                // salida
+    int dfd;               // salida con O_DIRECT (-1 = sin)
+
+    WriterRun runs[WRITER_RUNS];
+    int nruns;
+    long long run_bytes;
+    size_t max_put;        // bytes anotados por lote (y de un buffer de lote)
+
+    WriterReq reqs[PROC_INFLIGHT]; // índice = entrada de self->inflight[]
+    int used;              // pedidos sin marcar
+    int flight;            // pedidos con escrituras en vuelo (uring)
+
+    char *stage[WRITER_DEPTH];
+    int stage_refs[WRITER_DEPTH];
+    size_t stage_cap;
+    WriterUring uring;
+
+    long long group;       // umbral efectivo de confirmación en grupo
+    long long held;        // bytes escritos esperando fdatasync (group)
+    int dirty;             // escrito desde el último fdatasync
+    long long synced_ns;   // último fdatasync (periodic)
+    int busy;              // dentro de una operación (no reentrar)
+    int err;               // primer error de escritura o fdatasync (0 = ninguno)
+} Writer;
+
+// "auto", "pwrite", "pwritev" o "uring" a WRITER_*; -1 si no existe
+int writer_backend(const char *name);
+
+// "none", "periodic:MS" o "group:BYTES"; -1 con un mensaje en stderr
+int writer_durability(const char *spec, int *mode, long long *arg);
+
+// Nombre del motor (para mensajes)
+const char *writer_name(int backend);
+
+// Prepara el escritor sobre fd (abierto para escribir en path). max_put es
+// el tramo más grande que se anotará de una vez (un lote). direct abre
+// path también con O_DIRECT. 0, o -1 con un mensaje en stderr.
+int writer_open(Writer *w, SharedMemory *mem, ProcEntry *self, int fd, const char *path,
+                int backend, int direct, int durable, long long durable_arg, size_t max_put);
+
+// 1 si writer_put deja tramos sin escribir hasta writer_submit (el
+// llamador no debe soltar sus arriendos antes)
+int writer_deferred(const Writer *w);
+
+// Anota n bytes de seq..seq+n-1 (en pwrite los escribe ya). 0, o -1 con
+// errno (EIDRM = cierre).
+int writer_put(Writer *w, const char *data, int n, long long seq, long long enq_ns);
+
+// Escribe y marca ya, por fuera de los pedidos (con fdatasync si hay
+// política de durabilidad). Para las entregas de recover.c, que pueden
+// llegar a mitad de cualquier operación. 0, o -1 con errno (si falló la
+// escritura o el fdatasync no marca nada).
+int writer_now(Writer *w, const char *data, int n, long long seq, long long enq_ns);
+
+// Escribe o envía lo anotado y marca lo que ya terminó. Tras volver, los
+// data de writer_put ya no se usan. 0, o -1 con errno (también si algún
+// pedido anterior falló).
+int writer_submit(Writer *w);
+
+// Completa todo lo pendiente (con fdatasync en group) y lo marca
+int writer_idle(Writer *w);
+
+// Descarta lo anotado sin writer_submit, writer_idle y libera todo (no
+// cierra fd)
+void writer_close(Writer *w);
+
+#endif
@@ -0,0 +1,69 @@
+#!/bin/sh
+# ============================================================================
+#  Archivo: tests/emisor_error.sh
+#  Propósito:
+#    Un Emisor que sale por un error de lectura no debe trabar a los demás.
+#      1) Registros por línea con la fuente reemplazada por un directorio:
+#         el Emisor sale con su tramo en arriendo, proc_unregister deja la
+#         entrada para recover.c y, con la fuente restituida, un Receptor
+#         la completa; la salida es idéntica a la fuente.
+#      2) Cola de flujos (-J): la fuente del primer trabajo se vuelve
+#         ilegible (directorio) y la del segundo se borra. Cada Emisor que
+#         choca con una sale con estado de error sin publicar nada de ese
+#         trabajo: no se persiste mientras la fuente falte. Con las fuentes
+#         restituidas, recover.c entrega los tramos en arriendo y otro
+#         Emisor el resto de la cola; cada destino es idéntico a su fuente.
+#  Uso: make test   (o tests/emisor_error.sh [dir_binarios])
+# ============================================================================
+BIN=$(cd "${1:-bin}" && pwd) || exit 1
+WORK=$(mktemp -d) || exit 1
+# Si algo queda a medias, el Finalizador retira los IPC (clave de ftok en WORK)
+trap 'cd "$WORK" && timeout 5 "$BIN/finalizador" -t 1 1 </dev/null >/dev/null 2>&1; cd /; rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+fails=0
+
+fail() { echo "FALLA: $*"; fails=$((fails + 1)); }
+
+# Drena, retira los IPC y espera a los Receptores
+finish() {
+    timeout 30 "$BIN/finalizador" -t 10 1 </dev/null >fin.log 2>&1 || fail "$1: finalizador"
+    wait
+}
+
+# --- 1) Salida con arriendo: recuperación de la entrada ---------------------
+seq -f 'línea %g de la fuente' 3000 > fuente.txt
+"$BIN/inicializador" -m lf -l lines -c 4K 1 64K 42 fuente.txt >/dev/null || exit 1
+mv fuente.txt fuente.bak && mkdir fuente.txt
+timeout 10 "$BIN/emisor" 1 2 42 2>/dev/null && fail "lines: el emisor con la fuente ilegible salió con 0"
+rmdir fuente.txt && mv fuente.bak fuente.txt
+"$BIN/receptor" 1 2 42 salida.txt >/dev/null 2>&1 &
+timeout 30 "$BIN/emisor" 1 2 42 2>/dev/null || fail "lines: segundo emisor"
+finish lines
+cmp -s fuente.txt salida.txt || fail "lines: la salida no coincide con la fuente"
+
+# --- 2) Cola de flujos con fuentes ilegibles ---------------------------------
+head -c 4096 /dev/urandom > a.bin
+head -c 20000 /dev/urandom > b.bin
+head -c 30000 /dev/urandom > c.bin
+printf 'a.bin a.out\nb.bin b.out\n' > lista
+"$BIN/inicializador" -J 16 -c 4K 1 64 42 lista >/dev/null || exit 1
+mv a.bin a.bak && mkdir a.bin   # se abre, pero pread falla (EISDIR)
+mv b.bin b.bak                    # no se puede abrir
+"$BIN/encolador" 1 c.bin c.out >/dev/null || exit 1
+"$BIN/receptor" 1 2 42 /dev/null >/dev/null 2>&1 &
+timeout 10 "$BIN/emisor" 1 2 42 2>/dev/null && fail "jobs: el emisor con a.bin ilegible salió con 0"
+timeout 10 "$BIN/emisor" 1 2 42 2>/dev/null && fail "jobs: el emisor sin b.bin salió con 0"
+sleep 0.3
+timeout 10 "$BIN/monitor" -i 100 -n 1 1 2>/dev/null | grep -aq "trabajos: 0/3 persistidos" ||
+    fail "jobs: se persistió un trabajo con la fuente ilegible"
+rmdir a.bin && mv a.bak a.bin && mv b.bak b.bin
+timeout 30 "$BIN/emisor" 1 2 42 >/dev/null 2>&1 &
+# El drenaje corta los reclamos: se espera a que el último destino esté
+t=0
+while ! cmp -s c.bin c.out && [ $t -lt 200 ]; do sleep 0.1; t=$((t + 1)); done
+finish jobs
+grep -aq "Trabajos persistidos / encolados: .*3 / 3" fin.log || fail "jobs: quedaron trabajos sin persistir"
+for f in a b c; do cmp -s $f.bin $f.out || fail "jobs: $f.out no coincide con $f.bin"; done
+
+[ $fails -eq 0 ] && echo "emisor_error: OK"
+exit $fails
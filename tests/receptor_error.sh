@@ -0,0 +1,51 @@
+#!/bin/sh
+# ============================================================================
+#  Archivo: tests/receptor_error.sh
+#  Propósito:
+#    Un Receptor cuyo escritor de salida (writer.h) no puede escribir no
+#    debe marcar esos bytes como persistidos. Con un límite de tamaño de
+#    archivo (ulimit -f) las escrituras pasado el límite fallan con EFBIG:
+#    el Receptor sale con estado de error y los pedidos fallidos en
+#    arriendo, y otro Receptor los vuelve a entregar. La salida queda
+#    idéntica a la fuente con cada motor (pwrite, pwritev, uring) y
+#    confirmación en grupo, y también en modo append: un volcado fallido
+#    no avanza next_to_flush.
+#  Uso: make test   (o tests/receptor_error.sh [dir_binarios])
+# ============================================================================
+BIN=$(cd "${1:-bin}" && pwd) || exit 1
+WORK=$(mktemp -d) || exit 1
+# Si algo queda a medias, el Finalizador retira los IPC (clave de ftok en WORK)
+trap 'cd "$WORK" && timeout 5 "$BIN/finalizador" -t 1 1 </dev/null >/dev/null 2>&1; cd /; rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+fails=0
+
+fail() { echo "FALLA: $*"; fails=$((fails + 1)); }
+
+head -c 1000000 /dev/urandom > fuente.bin
+for motor in append pwrite pwritev uring; do
+    rm -f salida.bin
+    if [ $motor = append ]; then
+        "$BIN/inicializador" -c 4K 1 64K 42 fuente.bin >/dev/null || exit 1
+        opts=""
+    else
+        "$BIN/inicializador" -o pwrite -c 4K 1 64K 42 fuente.bin >/dev/null || exit 1
+        truncate -s 1000000 salida.bin # ya de su tamaño: ftruncate no choca con el límite
+        opts="-w $motor -d group:64K"
+    fi
+    ( trap '' XFSZ; ulimit -f 256; exec "$BIN/receptor" $opts 1 2 42 salida.bin ) >r1.log 2>&1 &
+    r1=$!
+    sleep 0.3
+    timeout 30 "$BIN/emisor" -p rate:2000000 1 2 42 >/dev/null 2>&1 &
+    emisor=$!
+    sleep 0.3
+    "$BIN/receptor" $opts 1 2 42 salida.bin >/dev/null 2>&1 &
+    wait $emisor || fail "$motor: emisor"
+    timeout 30 "$BIN/finalizador" -t 10 1 </dev/null >fin.log 2>&1 || fail "$motor: finalizador"
+    wait $r1 && fail "$motor: el receptor limitado salió con 0"
+    wait
+    grep -aq "queda para recuperación" r1.log || fail "$motor: el receptor limitado no dejó su arriendo"
+    cmp -s fuente.bin salida.bin || fail "$motor: la salida no coincide con la fuente"
+done
+
+[ $fails -eq 0 ] && echo "receptor_error: OK"
+exit $fails